@@ -113,6 +113,14 @@ public:
 		thunk_ = nullptr;
 	}
 
+	/// Drop a bound single-shot closure without invoking it (its op was cancelled), so the completion can be
+	/// bound again.
+	void unbind () noexcept
+	{
+		pal_require(thunk_ != nullptr, "completion unbind while not bound");
+		thunk_ = nullptr;
+	}
+
 	/// Invoke the bound closure via \c Op::dispatch(carrier, f, ec, n). For a single-shot completion, the closure
 	/// is copied out and the thunk cleared before \c Op::dispatch runs, so a double-complete without rebind
 	/// null-derefs at no extra cost in release.
@@ -96,6 +96,28 @@ TEST_CASE("async/__async")
 		}
 	}
 
+	SECTION("single-shot: unbind drops the closure unrun, bind may follow")
+	{
+		int first_calls = 0, second_calls = 0;
+		c.completion.bind<op_test>([&first_calls](int, std::error_code) noexcept { ++first_calls; });
+		c.completion.unbind();
+		CHECK_FALSE(c.completion.armed());
+
+		c.completion.bind<op_test>([&second_calls](int, std::error_code) noexcept { ++second_calls; });
+		c.completion.complete(c, {}, 0);
+		CHECK(first_calls == 0);
+		CHECK(second_calls == 1);
+	}
+
+	SECTION("single-shot: unbind while not bound is a REQUIRE violation")
+	{
+		if constexpr (pal::build == pal::build_type::debug)
+		{
+			auto msg = pal_test::require_terminate([&] { c.completion.unbind(); });
+			CHECK(msg.contains("not bound"));
+		}
+	}
+
 	SECTION("multishot: arm invokes the closure in place across multiple completions")
 	{
 		int calls = 0;
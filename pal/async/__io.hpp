@@ -0,0 +1,312 @@
+#pragma once
+
+/**
+ * \file pal/async/__io.hpp
+ * Backend I/O seam: per-resource state shared by handles and loop backends (internal)
+ */
+
+#include <pal/async/__async.hpp>
+#include <pal/async/event_loop.hpp>
+#include <pal/file.hpp>
+#include <pal/net/__socket.hpp>
+#include <pal/net/socket_base.hpp>
+#include <pal/result.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <system_error>
+#include <utility>
+
+namespace pal::async::__io
+{
+
+/// Async socket state common to every socket kind. Heap-stable: the backend holds its
+/// \ref __event_loop::io_event base (and, on io_uring, kind-specific members) by address while an
+/// operation is in the kernel, so it outlives its handle until the backend releases it (see the kind's
+/// \c ops close function).
+struct socket_state: __event_loop::io_event
+{
+	__event_loop::impl_type *loop = nullptr;
+	net::__socket::handle_type handle = net::__socket::handle_type::invalid;
+
+	// The handle is gone: state awaits release by the backend
+	bool closed = false;
+
+	// Backend free-list link
+	socket_state *next = nullptr;
+
+	// Delete the full (derived) state
+	void (*release)(socket_state *state) noexcept = nullptr;
+};
+
+/// \ref socket_state::release for kind \a State
+template <typename State>
+void release (socket_state *state) noexcept
+{
+	delete static_cast<State *>(state);
+}
+
+/// Async datagram socket state.
+struct datagram_state: socket_state
+{
+	// Endpoint storage size of the handle's protocol: the most source-address bytes a receive keeps
+	size_t name_capacity = 0;
+
+	// Backend bookkeeping: a multishot receive is live in the kernel / registered for readiness; a cancel
+	// of it is pending.
+	bool receive_active = false;
+	bool receive_cancelling = false;
+
+	// Multishot receive template (io_uring) or per-call header (reactor backends)
+	net::__socket::message message{};
+	::sockaddr_storage name_storage{};
+
+	// The datagram being dispatched: valid only for the duration of \ref receive's handler call
+	const void *name = nullptr;
+	size_t name_size = 0;
+	std::span<const std::byte> data{};
+	bool truncated = false;
+
+	__async::completion<datagram_state> receive;
+};
+
+/// Async socket acceptor state.
+struct acceptor_state: socket_state
+{
+	// Address family of the listening socket, inherited by accepted ones
+	int family = 0;
+
+	// Backend bookkeeping: a multishot accept is live in the kernel / registered for readiness; a cancel
+	// of it is pending.
+	bool accept_active = false;
+	bool accept_cancelling = false;
+
+	// The connection being dispatched: ownership passes to \ref accept's handler
+	net::__socket::handle_type accepted = net::__socket::handle_type::invalid;
+
+	// Connections the kernel accepted while no accept was armed (io_uring: multishot completions racing
+	// its cancel), FIFO in [backlog_head, backlog_size): handed out ahead of new ones by the next accept,
+	// closed with the state. Reactor backends leave connections in the listen queue instead.
+	std::unique_ptr<net::__socket::handle_type[]> backlog{};
+	size_t backlog_head = 0, backlog_size = 0, backlog_capacity = 0;
+
+	// Backend list of states with backlog to hand out
+	acceptor_state *backlog_next = nullptr;
+	bool backlog_listed = false;
+
+	__async::completion<acceptor_state> accept;
+};
+
+/// \ref socket_state::release for \ref acceptor_state: connections still in its backlog are closed.
+inline void release_acceptor (socket_state *state) noexcept
+{
+	auto *s = static_cast<acceptor_state *>(state);
+	for (auto i = s->backlog_head; i != s->backlog_size; ++i)
+	{
+		net::native_socket::close(s->backlog[i]);
+	}
+	delete s;
+}
+
+struct stream_state;
+
+/// Most payload windows of a chain (see \ref task::chain) one stream operation transfers: a bounded
+/// I/O vector array per direction, well past what the variadic sync API maps
+constexpr size_t stream_vector_count = 32;
+
+/// One single-shot operation slot of a \ref stream_state: the io_uring completion target of the op in the
+/// kernel, and the task it completes.
+struct stream_op: __event_loop::io_event
+{
+	stream_state *state = nullptr;
+
+	// Task of the operation in flight; null if idle
+	task *pending = nullptr;
+
+	// Backend bookkeeping: the op is in the kernel (io_uring), possibly past its handle's close
+	bool active = false;
+
+	// I/O vectors of a chained payload (see \ref gather)
+	std::array<net::__socket::io_vector, stream_vector_count> vectors{};
+};
+
+/// Map the payload chain of \a t (its window, then each segment's, see \ref task::chain) onto \a op's I/O
+/// vectors, one entry per window: the first \ref stream_vector_count windows of a longer chain. Vectors
+/// stay valid until the next gather on \a op.
+inline std::span<net::__socket::io_vector> gather (stream_op &op, task &t) noexcept
+{
+	size_t count = 0;
+	for (auto *s = &t; s != nullptr && count != op.vectors.size(); s = s->next_segment())
+	{
+		const auto window = s->span();
+		op.vectors[count++] = net::__socket::make_io_vector(window.data(), window.size());
+	}
+	return std::span{op.vectors}.first(count);
+}
+
+/// Async stream socket state. At most one operation per direction: \ref write carries a connect or a
+/// send, \ref read a receive.
+struct stream_state: socket_state
+{
+	stream_op write;
+	stream_op read;
+
+	// \ref write carries a connect (its endpoint is in the pending task's scratch); on epoll, \ref error
+	// holds a failure of the \ref write op's start itself, reported with the next readiness event
+	bool connecting = false;
+	int error = 0;
+
+	// Reactor backends: registered readiness interest; set while operations dispatch, deferring interest
+	// updates to the end of the event
+	uint32_t interest = 0;
+	bool dispatching = false;
+
+	// \ref write carries a zero-copy send, completed twice (see \ref complete_sent and
+	// \ref complete_released); once sent, the kernel still reads the task's payload until it releases it
+	bool zerocopy = false;
+	bool zerocopy_sent = false;
+
+	// epoll: SO_ZEROCOPY is on; the kernel holds the payload of MSG_ZEROCOPY send \ref zerocopy_id;
+	// sequence number of the next one
+	bool zerocopy_enabled = false;
+	bool zerocopy_held = false;
+	uint32_t zerocopy_id = 0;
+	uint32_t zerocopy_next = 0;
+};
+
+/// First completion of the zero-copy send on \a s: its outcome. The task stays pending for the release.
+inline void complete_sent (stream_state &s, std::error_code ec, size_t n) noexcept
+{
+	s.zerocopy_sent = true;
+	s.write.pending->complete(ec, n);
+}
+
+/// Final completion of the zero-copy send on \a s: the kernel no longer references the payload, the task
+/// goes back to its owner.
+inline void complete_released (stream_state &s) noexcept
+{
+	auto *t = std::exchange(s.write.pending, nullptr);
+	s.zerocopy = s.zerocopy_sent = false;
+	t->complete({}, 0);
+}
+
+/// \ref socket_state::release for \ref stream_state: operations still pending when the backend lets go
+/// of the state complete with std::errc::operation_canceled first.
+inline void release_stream (socket_state *state) noexcept
+{
+	auto *s = static_cast<stream_state *>(state);
+	const auto cancelled = std::make_error_code(std::errc::operation_canceled);
+	if (s->write.pending != nullptr && s->zerocopy)
+	{
+		if (!s->zerocopy_sent)
+		{
+			complete_sent(*s, cancelled, 0);
+		}
+		complete_released(*s);
+	}
+	for (auto *op: {&s->read, &s->write})
+	{
+		if (auto *t = std::exchange(op->pending, nullptr))
+		{
+			t->complete(cancelled, 0);
+		}
+	}
+	delete s;
+}
+
+/// Async file state. Owns the file: operations in flight (in the kernel on io_uring, on a worker thread
+/// otherwise) keep using it past its handle's destruction, so the last of them to complete releases the
+/// state, closing the file.
+struct file_state
+{
+	__event_loop::impl_type *loop = nullptr;
+	pal::file resource{};
+
+	// Operations started and not yet completed
+	size_t in_flight = 0;
+
+	// The handle is gone: state awaits release by the last operation in flight
+	bool closed = false;
+};
+
+/// One native file operation, carried in its task's op scratch: the io_uring completion target of the op in
+/// the kernel, and the task it completes. Any number of them may be in flight per file.
+struct file_op: __event_loop::io_event
+{
+	file_state *state = nullptr;
+	task *pending = nullptr;
+};
+
+/// Backend socket and file operations, one static table per backend (\ref __event_loop::impl_type::io_).
+struct ops
+{
+	/// Register datagram \a state (its handle already non-blocking) with \a loop.
+	result<void> (*datagram_open)(__event_loop::impl_type &loop, datagram_state &state) noexcept;
+
+	/// Take ownership of \a state whose handle is being destroyed: stop any receive and release it once the
+	/// kernel holds no reference to it. The socket itself is closed by the caller right after, so nothing
+	/// queued for it may be left unsubmitted: the descriptor may name another socket by then.
+	void (*datagram_close)(datagram_state *state) noexcept;
+
+	/// Start delivering datagrams to the armed \ref datagram_state::receive until it is stopped.
+	void (*start_receive_from)(datagram_state &state) noexcept;
+
+	/// Stop delivering datagrams; \ref datagram_state::receive is already disarmed.
+	void (*stop_receive)(datagram_state &state) noexcept;
+
+	/// Register listening acceptor \a state (its handle already non-blocking) with \a loop.
+	result<void> (*acceptor_open)(__event_loop::impl_type &loop, acceptor_state &state) noexcept;
+
+	/// \copydoc datagram_close
+	void (*acceptor_close)(acceptor_state *state) noexcept;
+
+	/// Start delivering connections to the armed \ref acceptor_state::accept until it is stopped.
+	void (*start_accept)(acceptor_state &state) noexcept;
+
+	/// Stop delivering connections; \ref acceptor_state::accept is already disarmed.
+	void (*stop_accept)(acceptor_state &state) noexcept;
+
+	/// Register stream \a state (its handle already non-blocking) with \a loop.
+	result<void> (*stream_open)(__event_loop::impl_type &loop, stream_state &state) noexcept;
+
+	/// \copydoc datagram_close
+	/// Pending operations complete, cancelled unless they already finished (see \ref release_stream).
+	void (*stream_close)(stream_state *state) noexcept;
+
+	/// Connect to \a endpoint (\a endpoint_size bytes, in \a task's scratch), completing \a task with the
+	/// outcome. \ref stream_state::write must be idle.
+	void (*start_connect)(stream_state &state, task &task, const void *endpoint, size_t endpoint_size) noexcept;
+
+	/// Send from \a task's payload window, completing it with the number of bytes sent.
+	/// \ref stream_state::write must be idle.
+	void (*start_send)(stream_state &state, task &task) noexcept;
+
+	/// Send from \a task's payload window without copying it, completing \a task twice: with the number of
+	/// bytes sent (\ref complete_sent), then once the kernel no longer references them
+	/// (\ref complete_released). \ref stream_state::write must be idle; it stays busy until the release.
+	void (*start_send_zerocopy)(stream_state &state, task &task) noexcept;
+
+	/// Receive into \a task's payload window, completing it with the number of bytes received (0 on
+	/// orderly shutdown). \ref stream_state::read must be idle.
+	void (*start_receive)(stream_state &state, task &task) noexcept;
+
+	/// Read into the pending task's payload window from \a offset of \a op's file, completing the task with
+	/// the number of bytes read (0 at end of file). Null, as are the other file operations, on backends
+	/// without native file I/O: file handles offload to a thread_pool there.
+	void (*start_read_at)(file_op &op, uint64_t offset) noexcept;
+
+	/// Write the pending task's payload window at \a offset of \a op's file, completing the task with the
+	/// number of bytes written.
+	void (*start_write_at)(file_op &op, uint64_t offset) noexcept;
+
+	/// Flush \a op's file to storage, completing the pending task with the outcome.
+	void (*start_fsync)(file_op &op) noexcept;
+
+	/// Take ownership of closed \a state with operations still in flight: release it on the last one's
+	/// completion.
+	void (*file_close)(file_state *state) noexcept;
+};
+
+} // namespace pal::async::__io
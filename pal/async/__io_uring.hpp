@@ -0,0 +1,156 @@
+#pragma once
+
+/**
+ * \file pal/async/__io_uring.hpp
+ * Raw io_uring ring plumbing for the Linux io_uring backend (internal)
+ */
+
+#include <pal/version.hpp>
+
+#if __pal_os_linux
+
+#include <pal/result.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <linux/io_uring.h>
+
+namespace pal::async::__io_uring
+{
+
+/// One io_uring instance: the kernel-shared submission and completion rings, mapped at \ref setup. Spelled
+/// out against the raw ABI (no liburing): the loop needs only SQE acquisition, one io_uring_enter and CQE
+/// reaping. Single-threaded, like the loop that owns it.
+///
+/// The SQ index array is filled with the identity mapping once at setup, so submission only ever
+/// publishes the tail.
+struct ring
+{
+	int fd = -1;
+	unsigned features = 0;
+
+	unsigned *sq_head = nullptr;
+	unsigned *sq_tail = nullptr;
+	unsigned *sq_flags = nullptr;
+	unsigned sq_mask = 0;
+	unsigned sq_entries = 0;
+	::io_uring_sqe *sqes = nullptr;
+
+	// SQEs handed out by get_sqe(); published to *sq_tail on submit
+	unsigned sqe_tail = 0;
+
+	unsigned *cq_head = nullptr;
+	unsigned *cq_tail = nullptr;
+	unsigned cq_mask = 0;
+	::io_uring_cqe *cqes = nullptr;
+
+	void *ring_map = nullptr;
+	size_t ring_map_size = 0;
+	void *sqe_map = nullptr;
+	size_t sqe_map_size = 0;
+
+	ring () noexcept = default;
+
+	~ring () noexcept
+	{
+		close();
+	}
+
+	ring (const ring &) = delete;
+	ring &operator= (const ring &) = delete;
+	ring (ring &&) = delete;
+	ring &operator= (ring &&) = delete;
+
+	/// Create the instance with \a sq_depth submission slots (clamped by the kernel) and \a cq_depth
+	/// completion slots (0: kernel default, twice the submission depth). Requires single-mmap rings,
+	/// no-drop CQ overflow and extended enter arguments (Linux 5.11+); fails with
+	/// \c std::errc::function_not_supported otherwise.
+	result<void> setup (unsigned sq_depth, unsigned cq_depth) noexcept;
+
+	/// Unmap and close; idempotent.
+	void close () noexcept;
+
+	/// Next free SQE, zeroed, or nullptr when every slot is queued and not yet submitted.
+	[[nodiscard]] ::io_uring_sqe *get_sqe () noexcept
+	{
+		const auto head = std::atomic_ref{*sq_head}.load(std::memory_order_acquire);
+		if (sqe_tail - head == sq_entries)
+		{
+			return nullptr;
+		}
+		auto *sqe = &sqes[sqe_tail & sq_mask];
+		++sqe_tail;
+		std::memset(sqe, 0, sizeof(*sqe));
+		return sqe;
+	}
+
+	/// Next free SQE, zeroed; submits the queued ones first when the ring is full.
+	[[nodiscard]] ::io_uring_sqe *next_sqe () noexcept
+	{
+		auto *sqe = get_sqe();
+		while (sqe == nullptr)
+		{
+			std::ignore = enter(0, 0, nullptr);
+			sqe = get_sqe();
+		}
+		return sqe;
+	}
+
+	/// Number of SQEs handed out but not yet consumed by the kernel.
+	[[nodiscard]] unsigned pending () const noexcept
+	{
+		return sqe_tail - std::atomic_ref{*sq_head}.load(std::memory_order_acquire);
+	}
+
+	/// True if completions are waiting to be reaped.
+	[[nodiscard]] bool cq_ready () const noexcept
+	{
+		return std::atomic_ref{*cq_tail}.load(std::memory_order_acquire) != *cq_head;
+	}
+
+	/// True if the kernel needs an io_uring_enter to make progress even without new submissions:
+	/// overflowed completions to flush or deferred task work to run.
+	[[nodiscard]] bool needs_enter () const noexcept
+	{
+		const auto flags = std::atomic_ref{*sq_flags}.load(std::memory_order_relaxed);
+		return (flags & (IORING_SQ_CQ_OVERFLOW | IORING_SQ_TASKRUN)) != 0;
+	}
+
+	/// Publish the queued SQEs and enter the kernel, waiting for at least \a min_complete completions for at
+	/// most \a timeout (nullptr: unbounded). Returns the number of SQEs submitted, or -errno (EINTR
+	/// retried; ETIME, EBUSY and EAGAIN are left to the caller).
+	int enter (unsigned flags, unsigned min_complete, const ::__kernel_timespec *timeout) noexcept;
+
+	/// Invoke \a f(cqe) for each completion available now, releasing each slot before \a f runs so \a f
+	/// is free to queue new SQEs. Returns the number of completions reaped.
+	template <typename F>
+	size_t reap (F &&f) noexcept
+	{
+		auto head = *cq_head;
+		const auto tail = std::atomic_ref{*cq_tail}.load(std::memory_order_acquire);
+		const auto n = tail - head;
+		while (head != tail)
+		{
+			const ::io_uring_cqe cqe = cqes[head & cq_mask];
+			std::atomic_ref{*cq_head}.store(++head, std::memory_order_release);
+			f(cqe);
+		}
+		return n;
+	}
+};
+
+constexpr ::__kernel_timespec to_kernel_timespec (std::chrono::steady_clock::duration d) noexcept
+{
+	const auto wait = (d < d.zero()) ? d.zero() : d;
+	const auto secs = std::chrono::duration_cast<std::chrono::seconds>(wait);
+	const auto nsecs = std::chrono::duration_cast<std::chrono::nanoseconds>(wait - secs);
+	return {
+		.tv_sec = static_cast<decltype(::__kernel_timespec::tv_sec)>(secs.count()),
+		.tv_nsec = static_cast<decltype(::__kernel_timespec::tv_nsec)>(nsecs.count()),
+	};
+}
+
+} // namespace pal::async::__io_uring
+
+#endif // __pal_os_linux
@@ -0,0 +1,471 @@
+#pragma once
+
+/**
+ * \file pal/async/coroutine.hpp
+ * Coroutine adapter over task-carried operations
+ */
+
+#include <pal/async/event_loop.hpp>
+#include <pal/async/handle.hpp>
+#include <pal/async/thread_pool.hpp>
+#include <pal/require.hpp>
+#include <pal/result.hpp>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace pal::async
+{
+
+namespace __coroutine
+{
+
+/// Frame allocation on the loop's \ref __event_loop::frame_arena. The owning loop is stored ahead of each
+/// frame, in a header that keeps the frame at the default new alignment, so deallocation (which gets only
+/// the pointer and size) finds its way back.
+struct frame
+{
+	static constexpr size_t header_size = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+	static void *allocate (event_loop &loop, size_t size) noexcept
+	{
+		auto &impl = *loop.impl_;
+		auto *p = static_cast<std::byte *>(impl.frames_.allocate(header_size + size));
+		if (p == nullptr)
+		{
+			return nullptr;
+		}
+		*reinterpret_cast<__event_loop::impl_type **>(p) = &impl;
+		++impl.stats_.coroutine_frames;
+		return p + header_size;
+	}
+
+	static void deallocate (void *f, size_t size) noexcept
+	{
+		auto *p = static_cast<std::byte *>(f) - header_size;
+		auto &impl = **reinterpret_cast<__event_loop::impl_type **>(p);
+		--impl.stats_.coroutine_frames;
+		impl.frames_.deallocate(p, header_size + size);
+	}
+};
+
+/// Resumes the awaiting coroutine of a finished one (symmetric transfer), or destroys a spawned one's frame:
+/// nothing awaits its result.
+struct final_awaiter
+{
+	[[nodiscard]] bool await_ready () const noexcept
+	{
+		return false;
+	}
+
+	template <typename Promise>
+	std::coroutine_handle<> await_suspend (std::coroutine_handle<Promise> self) noexcept
+	{
+		if (auto continuation = self.promise().continuation)
+		{
+			return continuation;
+		}
+		self.destroy();
+		return std::noop_coroutine();
+	}
+
+	void await_resume () const noexcept
+	{
+	}
+};
+
+/// Promise members common to every \ref coroutine result type.
+struct promise_base
+{
+	// Coroutine awaiting this one; null if spawned
+	std::coroutine_handle<> continuation{};
+
+	/// Frame of a coroutine taking an \ref event_loop as its first parameter
+	template <typename... Args>
+	static void *operator new (size_t size, event_loop &loop, Args &...) noexcept
+	{
+		return frame::allocate(loop, size);
+	}
+
+	/// Frame of a member coroutine taking an \ref event_loop as its first parameter
+	template <typename Self, typename... Args>
+	static void *operator new (size_t size, Self &, event_loop &loop, Args &...) noexcept
+	{
+		return frame::allocate(loop, size);
+	}
+
+	static void operator delete (void *f, size_t size) noexcept
+	{
+		frame::deallocate(f, size);
+	}
+
+	[[nodiscard]] std::suspend_always initial_suspend () const noexcept
+	{
+		return {};
+	}
+
+	[[nodiscard]] final_awaiter final_suspend () const noexcept
+	{
+		return {};
+	}
+
+	void unhandled_exception () const noexcept
+	{
+		std::terminate();
+	}
+};
+
+template <typename T>
+struct promise_result
+{
+	std::optional<T> value{};
+
+	void return_value (T v) noexcept
+	{
+		value.emplace(std::move(v));
+	}
+
+	T take () noexcept
+	{
+		return std::move(*value);
+	}
+};
+
+template <>
+struct promise_result<void>
+{
+	void return_void () const noexcept
+	{
+	}
+
+	void take () const noexcept
+	{
+	}
+};
+
+/// What co_await on an operation yields: its handler's arguments, the task alone or paired with the result
+template <typename... Args>
+struct value;
+
+template <typename T>
+struct value<T>
+{
+	using type = T;
+};
+
+template <typename T, typename U>
+struct value<T, U>
+{
+	using type = std::pair<T, U>;
+};
+
+/// Where the operation's handler leaves its arguments for the resumed coroutine
+template <typename Value>
+struct slot
+{
+	std::optional<Value> value{};
+	std::coroutine_handle<> continuation{};
+};
+
+/// The handler bound to the operation's task: the completion thunk invokes it with the operation's
+/// arguments, and it resumes the awaiting coroutine right there, on the loop's thread.
+template <typename Value>
+struct resume
+{
+	slot<Value> *target;
+
+	template <typename... Args>
+	void operator() (Args &&...args) const noexcept
+	{
+		target->value.emplace(std::forward<Args>(args)...);
+		target->continuation.resume();
+	}
+};
+
+} // namespace __coroutine
+
+/// Coroutine returning \a T, with its frame allocated from the frame arena of the \ref event_loop it takes
+/// as its first parameter (after the object, for member coroutines; a coroutine without one does not
+/// compile). Steady-state frame churn then never reaches the global heap, and frames have the loop's
+/// lifetime: per the teardown contract every coroutine made on a loop must have finished before the loop
+/// is destroyed (see \ref event_loop_stats::coroutine_frames). Loop-thread only.
+///
+/// Lazy: the body starts when the coroutine is awaited (from another coroutine, which it resumes with its
+/// result on return) or spawned (\ref spawn, which detaches it). An empty coroutine (see operator bool) is
+/// the result of a failed frame allocation; awaiting it is a contract violation.
+///
+/// Suspension points are task-carried operations awaited via the adapters below (\ref post,
+/// \ref post_after, \ref read_at, ...) or \ref make_awaitable: instead of a handler, each binds the
+/// operation's task to a resumption handler, so the single-shot completion thunk resumes the coroutine
+/// directly. Exceptions are not supported: one escaping the body terminates.
+template <typename T = void>
+class [[nodiscard]] coroutine
+{
+public:
+
+	struct promise_type: __coroutine::promise_base, __coroutine::promise_result<T>
+	{
+		coroutine get_return_object () noexcept
+		{
+			return coroutine{std::coroutine_handle<promise_type>::from_promise(*this)};
+		}
+
+		static coroutine get_return_object_on_allocation_failure () noexcept
+		{
+			return coroutine{};
+		}
+	};
+
+	coroutine () noexcept = default;
+
+	coroutine (coroutine &&that) noexcept
+		: handle_{std::exchange(that.handle_, {})}
+	{
+	}
+
+	coroutine &operator= (coroutine &&that) noexcept
+	{
+		if (auto h = std::exchange(handle_, std::exchange(that.handle_, {})))
+		{
+			h.destroy();
+		}
+		return *this;
+	}
+
+	/// Destroy the frame of a coroutine not started (or finished, if awaited)
+	~coroutine () noexcept
+	{
+		if (handle_)
+		{
+			handle_.destroy();
+		}
+	}
+
+	/// Returns true unless empty (frame allocation failed, moved from or spawned)
+	explicit operator bool () const noexcept
+	{
+		return static_cast<bool>(handle_);
+	}
+
+	/// \cond internal
+	[[nodiscard]] bool await_ready () const noexcept
+	{
+		return false;
+	}
+
+	std::coroutine_handle<> await_suspend (std::coroutine_handle<> caller) noexcept
+	{
+		pal_require(static_cast<bool>(handle_), "co_await on empty coroutine");
+		handle_.promise().continuation = caller;
+		return handle_;
+	}
+
+	T await_resume () noexcept
+	{
+		return handle_.promise().take();
+	}
+	/// \endcond
+
+private:
+
+	std::coroutine_handle<promise_type> handle_{};
+
+	explicit coroutine (std::coroutine_handle<promise_type> handle) noexcept
+		: handle_{handle}
+	{
+	}
+
+	friend result<void> spawn (coroutine<void> &&c) noexcept;
+};
+
+/// Start \a c detached: it runs until its first suspension now, and its frame goes back to the arena when
+/// it returns. Errors: \c std::errc::not_enough_memory if \a c is empty (its frame allocation failed).
+[[nodiscard]] inline result<void> spawn (coroutine<void> &&c) noexcept
+{
+	if (!c)
+	{
+		return make_unexpected(std::errc::not_enough_memory);
+	}
+	std::exchange(c.handle_, {}).resume();
+	return {};
+}
+
+/// Awaitable task-carried operation, made by \ref make_awaitable. co_await yields what the operation
+/// passes its handler: the task alone (\a Args is \c task_ptr), or paired with the operation's result
+/// (\a Args is \c task_ptr, <tt>result<...></tt>). The operation must not complete before its start returns;
+/// pal operations never do (they complete from a later run()).
+template <typename Start, typename... Args>
+class [[nodiscard]] awaitable
+{
+public:
+
+	using value_type = typename __coroutine::value<Args...>::type;
+
+	explicit awaitable (Start start) noexcept
+		: start_{std::move(start)}
+	{
+	}
+
+	awaitable (const awaitable &) = delete;
+	awaitable &operator= (const awaitable &) = delete;
+
+	/// \cond internal
+	[[nodiscard]] bool await_ready () const noexcept
+	{
+		return false;
+	}
+
+	void await_suspend (std::coroutine_handle<> caller) noexcept
+	{
+		slot_.continuation = caller;
+		std::move(start_)(__coroutine::resume<value_type>{&slot_});
+	}
+
+	value_type await_resume () noexcept
+	{
+		return std::move(*slot_.value);
+	}
+	/// \endcond
+
+private:
+
+	Start start_;
+	__coroutine::slot<value_type> slot_{};
+};
+
+/// Adapt any task-carried operation to co_await: \a start(handler) starts it with the given handler, which
+/// takes \a Args. E.g. for a single-shot op of a custom handle:
+/// \code
+/// auto [t, r] = co_await make_awaitable<task_ptr, result<size_t>>([&] (auto h) noexcept
+/// {
+/// 	custom.start_op(std::move(task), h);
+/// });
+/// \endcode
+template <typename... Args, typename Start>
+[[nodiscard]] auto make_awaitable (Start start) noexcept
+{
+	return awaitable<Start, Args...>{std::move(start)};
+}
+
+/// co_await: post \a t to \a loop, yielding it back from a later run() (\ref event_loop::post). Lets a long
+/// coroutine give other work on the loop a turn.
+[[nodiscard]] inline auto post (event_loop &loop, task_ptr &&t) noexcept
+{
+	return make_awaitable<task_ptr>([&loop, t = std::move(t)] (auto resume) mutable noexcept
+	{
+		loop.post(std::move(t), resume);
+	});
+}
+
+/// co_await: yield \a t back after \a delay (\ref event_loop::post_after).
+[[nodiscard]] inline auto post_after (event_loop &loop, task_ptr &&t, event_loop::clock::duration delay) noexcept
+{
+	return make_awaitable<task_ptr>([&loop, t = std::move(t), delay] (auto resume) mutable noexcept
+	{
+		loop.post_after(std::move(t), delay, resume);
+	});
+}
+
+/// co_await: run \a work on a \a pool worker, yielding \a t back on \a loop's thread once it has run
+/// (\ref thread_pool::post).
+template <typename Work>
+[[nodiscard]] auto post (thread_pool &pool, event_loop &loop, task_ptr &&t, Work work) noexcept
+	requires __async::handler<Work, void(task &) noexcept>
+{
+	return make_awaitable<task_ptr>([&pool, &loop, t = std::move(t), work] (auto resume) mutable noexcept
+	{
+		pool.post(loop, std::move(t), work, resume);
+	});
+}
+
+/// co_await: resolve \a name and \a service on \a h (\ref handle::start_resolve), yielding the task with
+/// the endpoints found.
+template <typename Resolver>
+[[nodiscard]] auto resolve (Resolver &h,
+	task_ptr &&t,
+	std::string_view name,
+	std::string_view service,
+	typename Resolver::flags f = {}) noexcept
+{
+	using endpoints = result<std::span<const typename Resolver::endpoint_type>>;
+	return make_awaitable<task_ptr, endpoints>([&h, t = std::move(t), name, service, f] (auto resume) mutable noexcept
+	{
+		h.start_resolve(std::move(t), name, service, f, resume);
+	});
+}
+
+/// co_await: connect stream socket \a h to \a endpoint, yielding the task with the outcome.
+template <typename Stream>
+[[nodiscard]] auto connect (Stream &h, task_ptr &&t, const typename Stream::endpoint_type &endpoint) noexcept
+{
+	return make_awaitable<task_ptr, result<void>>([&h, t = std::move(t), endpoint] (auto resume) mutable noexcept
+	{
+		h.start_connect(std::move(t), endpoint, resume);
+	});
+}
+
+/// co_await: send the task's payload window on stream socket \a h, yielding the task with the number of
+/// bytes sent.
+template <typename Stream>
+[[nodiscard]] auto send (Stream &h, task_ptr &&t) noexcept
+	requires requires { h.start_send(std::move(t), __coroutine::resume<std::pair<task_ptr, result<size_t>>>{}); }
+{
+	return make_awaitable<task_ptr, result<size_t>>([&h, t = std::move(t)] (auto resume) mutable noexcept
+	{
+		h.start_send(std::move(t), resume);
+	});
+}
+
+/// co_await: receive into the task's payload window on stream socket \a h, yielding the task with the
+/// number of bytes received (0 once the peer has shut down its sending side).
+template <typename Stream>
+[[nodiscard]] auto receive (Stream &h, task_ptr &&t) noexcept
+	requires requires { h.start_receive(std::move(t), __coroutine::resume<std::pair<task_ptr, result<size_t>>>{}); }
+{
+	return make_awaitable<task_ptr, result<size_t>>([&h, t = std::move(t)] (auto resume) mutable noexcept
+	{
+		h.start_receive(std::move(t), resume);
+	});
+}
+
+/// co_await: read into the task's payload window from \a offset of file \a h, yielding the task with the
+/// number of bytes read (0 at end of file).
+template <typename File>
+[[nodiscard]] auto read_at (File &h, task_ptr &&t, uint64_t offset) noexcept
+	requires requires { h.start_read_at(std::move(t), offset, __coroutine::resume<std::pair<task_ptr, result<size_t>>>{}); }
+{
+	return make_awaitable<task_ptr, result<size_t>>([&h, t = std::move(t), offset] (auto resume) mutable noexcept
+	{
+		h.start_read_at(std::move(t), offset, resume);
+	});
+}
+
+/// co_await: write the task's payload window at \a offset of file \a h, yielding the task with the number
+/// of bytes written.
+template <typename File>
+[[nodiscard]] auto write_at (File &h, task_ptr &&t, uint64_t offset) noexcept
+	requires requires { h.start_write_at(std::move(t), offset, __coroutine::resume<std::pair<task_ptr, result<size_t>>>{}); }
+{
+	return make_awaitable<task_ptr, result<size_t>>([&h, t = std::move(t), offset] (auto resume) mutable noexcept
+	{
+		h.start_write_at(std::move(t), offset, resume);
+	});
+}
+
+/// co_await: flush file \a h to storage, yielding the task with the outcome.
+template <typename File>
+[[nodiscard]] auto fsync (File &h, task_ptr &&t) noexcept
+	requires requires { h.start_fsync(std::move(t), __coroutine::resume<std::pair<task_ptr, result<void>>>{}); }
+{
+	return make_awaitable<task_ptr, result<void>>([&h, t = std::move(t)] (auto resume) mutable noexcept
+	{
+		h.start_fsync(std::move(t), resume);
+	});
+}
+
+} // namespace pal::async
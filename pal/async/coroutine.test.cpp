@@ -0,0 +1,272 @@
+#include <pal/async/coroutine.hpp>
+#include <pal/async/file.hpp>
+#include <pal/async/resolver.hpp>
+#include <pal/async/test.hpp>
+#include <pal/net/ip/udp.hpp>
+#include <pal/test.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using namespace pal::async;
+using namespace std::chrono_literals;
+
+using pal_test::run_until;
+
+using udp = pal::net::ip::udp;
+
+std::span<std::byte> as_writable_bytes (std::string_view s) noexcept
+{
+	return {reinterpret_cast<std::byte *>(const_cast<char *>(s.data())), s.size()};
+}
+
+coroutine<> sleep (event_loop &loop, task &t, event_loop::clock::duration delay, std::vector<int> &trace, int id)
+{
+	trace.push_back(id);
+	auto p = co_await post_after(loop, t.borrow(), delay);
+	CHECK(p.get() == &t);
+	trace.push_back(-id);
+}
+
+coroutine<> yield_twice (event_loop &loop, task &t, std::vector<int> &trace, int id)
+{
+	for (auto i = 0; i < 2; ++i)
+	{
+		trace.push_back(id);
+		co_await post(loop, t.borrow());
+	}
+	trace.push_back(-id);
+}
+
+coroutine<int> add_later (event_loop &loop, task &t, int a, int b)
+{
+	co_await post(loop, t.borrow());
+	co_return a + b;
+}
+
+coroutine<> sum (event_loop &loop, task &t, int &result)
+{
+	const auto x = co_await add_later(loop, t, 1, 2);
+	const auto y = co_await add_later(loop, t, x, 3);
+	result = y;
+}
+
+coroutine<> offload (event_loop &loop, thread_pool &pool, task &t, std::thread::id &worker, bool &resumed_on_loop)
+{
+	const auto loop_thread = std::this_thread::get_id();
+	auto p = co_await post(pool, loop, t.borrow(), [] (task &w) noexcept
+	{
+		w.scratch_as<std::thread::id>() = std::this_thread::get_id();
+	});
+	worker = p->scratch_as<std::thread::id>();
+	resumed_on_loop = std::this_thread::get_id() == loop_thread;
+}
+
+coroutine<> copy_file (event_loop &, handle<pal::file> &from, handle<pal::file> &to, task &t, size_t &copied)
+{
+	for (uint64_t offset = 0;;)
+	{
+		auto [p, n] = co_await read_at(from, t.borrow(), offset);
+		if (!n || *n == 0)
+		{
+			break;
+		}
+		const auto window = p->span();
+		p->span(window.first(*n));
+		auto [q, w] = co_await write_at(to, std::move(p), offset);
+		q->span(window);
+		if (!w)
+		{
+			break;
+		}
+		offset += *w;
+	}
+
+	auto [p, r] = co_await fsync(to, t.borrow());
+	if (r)
+	{
+		copied = to.size().value_or(0);
+	}
+}
+
+coroutine<> resolve_one (event_loop &, handle<udp::resolver> &h, task &t, udp::endpoint &result)
+{
+	auto [p, r] = co_await resolve(h, t.borrow(), "127.0.0.1", "7", udp::resolver::numeric_host);
+	if (r && !r->empty())
+	{
+		result = r->front();
+	}
+}
+
+struct session
+{
+	int hits = 0;
+
+	coroutine<> run (event_loop &loop, task &t)
+	{
+		co_await post(loop, t.borrow());
+		++hits;
+	}
+};
+
+TEST_CASE("async/coroutine")
+{
+	// tasks outlive the loop: the frames reference them until they finish
+	std::array<std::byte, 16> buffer{};
+	task t1{buffer}, t2;
+
+	auto loop = make_loop();
+	REQUIRE(loop);
+	std::vector<int> trace;
+
+	SECTION("lazy until spawned")
+	{
+		auto c = sleep(*loop, t1, 1ms, trace, 1);
+		REQUIRE(c);
+		CHECK(trace.empty());
+		CHECK(loop->stats().coroutine_frames == 1);
+
+		REQUIRE(spawn(std::move(c)));
+		CHECK_FALSE(c);
+		CHECK(trace == std::vector{1});
+
+		run_until(*loop, [&] { return trace.size() == 2; });
+		CHECK(trace == std::vector{1, -1});
+		CHECK(loop->stats().coroutine_frames == 0);
+	}
+
+	SECTION("destroyed unstarted")
+	{
+		{
+			auto c = sleep(*loop, t1, 1ms, trace, 1);
+			CHECK(loop->stats().coroutine_frames == 1);
+		}
+		CHECK(loop->stats().coroutine_frames == 0);
+		CHECK(trace.empty());
+	}
+
+	SECTION("spawn empty")
+	{
+		auto r = spawn(coroutine<>{});
+		REQUIRE_FALSE(r);
+		CHECK(r.error() == std::errc::not_enough_memory);
+	}
+
+	SECTION("post_after")
+	{
+		REQUIRE(spawn(sleep(*loop, t1, 20ms, trace, 1)));
+		REQUIRE(spawn(sleep(*loop, t2, 1ms, trace, 2)));
+		run_until(*loop, [&] { return trace.size() == 4; });
+		CHECK(trace == std::vector{1, 2, -2, -1});
+	}
+
+	SECTION("post interleaves")
+	{
+		REQUIRE(spawn(yield_twice(*loop, t1, trace, 1)));
+		REQUIRE(spawn(yield_twice(*loop, t2, trace, 2)));
+		run_until(*loop, [&] { return trace.size() == 6; });
+		CHECK(trace == std::vector{1, 2, 1, 2, -1, -2});
+	}
+
+	SECTION("await coroutine")
+	{
+		int result = 0;
+		REQUIRE(spawn(sum(*loop, t1, result)));
+		run_until(*loop, [&] { return result != 0; });
+		CHECK(result == 6);
+		CHECK(loop->stats().coroutine_frames == 0);
+	}
+
+	SECTION("member coroutine")
+	{
+		session s;
+		REQUIRE(spawn(s.run(*loop, t1)));
+		run_until(*loop, [&] { return s.hits == 1; });
+		CHECK(s.hits == 1);
+	}
+
+	SECTION("frames are recycled")
+	{
+		for (auto i = 0; i < 100; ++i)
+		{
+			REQUIRE(spawn(yield_twice(*loop, t1, trace, 1)));
+			run_until(*loop, [&] { return loop->stats().coroutine_frames == 0; });
+		}
+		CHECK(trace.size() == 300);
+	}
+
+	SECTION("thread_pool")
+	{
+		auto pool = make_thread_pool(1);
+		REQUIRE(pool);
+
+		std::thread::id worker{};
+		bool resumed_on_loop = false;
+		REQUIRE(spawn(offload(*loop, *pool, t1, worker, resumed_on_loop)));
+		run_until(*loop, [&] { return resumed_on_loop; });
+		CHECK(resumed_on_loop);
+		CHECK(worker != std::thread::id{});
+		CHECK(worker != std::this_thread::get_id());
+	}
+
+	SECTION("resolver")
+	{
+		auto pool = make_thread_pool(1);
+		REQUIRE(pool);
+		auto h = loop->make_handle(udp::resolver{}, *pool);
+		REQUIRE(h);
+
+		alignas(udp::endpoint) std::array<std::byte, 4 * sizeof(udp::endpoint)> endpoints{};
+		t1.span(endpoints);
+
+		udp::endpoint result{};
+		REQUIRE(spawn(resolve_one(*loop, *h, t1, result)));
+		run_until(*loop, [&] { return result.port() != pal::net::ip::port_type{}; });
+		CHECK(result.address().is_loopback());
+		CHECK(result.port() == pal::net::ip::port_type{7});
+		t1.span(buffer);
+	}
+
+	SECTION("file")
+	{
+		auto pool = make_thread_pool(1);
+		REQUIRE(pool);
+
+		const pal_test::temp_file from_path, to_path;
+		constexpr std::string_view content = "coroutine file copy, in chunks of the task's window";
+		{
+			auto f = pal::open_file(from_path.string().c_str(), pal::file::write | pal::file::create);
+			REQUIRE(f);
+			REQUIRE(f->write_at(as_writable_bytes(content), 0).value() == content.size());
+		}
+
+		auto from = loop->make_handle(pal::open_file(from_path.string().c_str(), pal::file::read).value(), *pool);
+		REQUIRE(from);
+		auto to = loop->make_handle(
+			pal::open_file(to_path.string().c_str(), pal::file::read | pal::file::write | pal::file::create).value(),
+			*pool
+		);
+		REQUIRE(to);
+
+		size_t copied = 0;
+		REQUIRE(spawn(copy_file(*loop, *from, *to, t1, copied)));
+		run_until(*loop, [&] { return copied != 0; });
+		CHECK(copied == content.size());
+
+		std::string data(content.size(), '\0');
+		auto f = pal::open_file(to_path.string().c_str(), pal::file::read);
+		REQUIRE(f);
+		CHECK(f->read_at(as_writable_bytes(data), 0).value() == content.size());
+		CHECK(data == content);
+	}
+}
+
+} // namespace
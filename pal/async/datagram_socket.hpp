@@ -0,0 +1,183 @@
+#pragma once
+
+/**
+ * \file pal/async/datagram_socket.hpp
+ * Asynchronous datagram socket
+ */
+
+#include <pal/async/__io.hpp>
+#include <pal/async/handle.hpp>
+#include <pal/net/basic_datagram_socket.hpp>
+#include <pal/net/socket_option.hpp>
+#include <pal/require.hpp>
+#include <pal/result.hpp>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace pal::async
+{
+
+/// Asynchronous datagram socket for \a Protocol, made by \ref event_loop::make_handle(T). Receive is
+/// multishot: one \ref start_receive_from keeps delivering datagrams to its handler, on the loop's
+/// thread, until \ref stop_receive or a terminal error -- no per-datagram syscall on io_uring, no
+/// per-datagram allocation on any backend.
+///
+/// Payload comes from loop-owned receive buffers (\ref event_loop_config::buffer_count of
+/// \ref event_loop_config::buffer_size bytes each, registered with the kernel on io_uring) and is lent
+/// to the handler for the duration of the call only: the buffer is recycled when the handler returns, so
+/// copy out anything that must outlive it. Every backend delivers up to
+/// \ref event_loop_config::buffer_size payload bytes per datagram; a longer one is truncated, as with a
+/// short buffer passed to recvmsg, and flagged \ref datagram::truncated.
+///
+/// An armed receive is not "work" for \ref event_loop::run, which returns once posts and timers are
+/// drained; drive a receiving loop with \ref event_loop::run_for.
+///
+/// Made non-blocking on adoption. Destruction stops any receive and closes the socket; per the teardown
+/// contract it must happen before the loop is destroyed.
+template <typename Protocol>
+class handle<net::basic_datagram_socket<Protocol>>
+{
+public:
+
+	using protocol_type = Protocol;
+	using endpoint_type = Protocol::endpoint;
+
+	/// One received datagram. \a data is lent for the duration of the handler call only.
+	struct datagram
+	{
+		endpoint_type sender;
+		std::span<const std::byte> data;
+
+		/// The datagram was longer than the receive buffer: \a data holds its head only
+		bool truncated = false;
+	};
+
+	handle (handle &&) noexcept = default;
+	~handle () noexcept = default;
+
+	handle &operator= (handle &&that) noexcept
+	{
+		// release the state while its socket is still open, as the destructor does
+		state_ = std::move(that.state_);
+		socket_ = std::move(that.socket_);
+		return *this;
+	}
+
+	/// Return local endpoint to which this socket is bound
+	[[nodiscard]] result<endpoint_type> local_endpoint () const noexcept
+	{
+		return socket_.local_endpoint();
+	}
+
+	/// Start receiving: run \a handler on the loop's thread for every datagram that arrives, until
+	/// \ref stop_receive. An error is terminal: the receive is stopped before \a handler sees it, so
+	/// \a handler may restart it from inside the call. Loop-thread-only; at most one receive at a time
+	/// (starting a second without stopping the first is a contract violation).
+	template <typename H>
+	void start_receive_from (H handler) noexcept
+		requires __async::handler<H, void(result<datagram> &&) noexcept>
+	{
+		state_->receive.template arm<op_receive_from>(std::move(handler));
+		state_->loop->io_->start_receive_from(*state_);
+	}
+
+	/// Stop receiving; no-op if no receive is active. The handler is not run again, even for datagrams
+	/// the kernel has already queued. Loop-thread-only, callable from inside the handler.
+	void stop_receive () noexcept
+	{
+		if (state_->receive.armed())
+		{
+			state_->receive.stop();
+			state_->loop->io_->stop_receive(*state_);
+		}
+	}
+
+private:
+
+	struct op_receive_from
+	{
+		using signature = void(result<datagram> &&) noexcept;
+
+		template <typename F>
+		static void dispatch (__io::datagram_state &s, F &f, std::error_code ec, size_t) noexcept
+		{
+			if (ec)
+			{
+				// terminal: disarm before the call (so the handler may restart) from a copy of itself
+				auto h = f;
+				s.receive.stop();
+				h(unexpected{ec});
+				return;
+			}
+
+			datagram d{.sender = {}, .data = s.data, .truncated = s.truncated};
+			const auto name_size = (s.name_size < d.sender.capacity()) ? s.name_size : d.sender.capacity();
+			std::memcpy(d.sender.data(), s.name, name_size);
+			if (auto r = d.sender.resize(name_size); !r)
+			{
+				// truncated/foreign source address: drop the datagram, keep receiving
+				return;
+			}
+			f(std::move(d));
+		}
+	};
+
+	struct state_deleter
+	{
+		void operator() (__io::datagram_state *s) const noexcept
+		{
+			s->closed = true;
+			s->loop->io_->datagram_close(s);
+		}
+	};
+
+	using state_ptr = std::unique_ptr<__io::datagram_state, state_deleter>;
+
+	// declaration order matters: the state is released before the socket closes
+	net::basic_datagram_socket<Protocol> socket_;
+	state_ptr state_;
+
+	handle (net::basic_datagram_socket<Protocol> &&socket, state_ptr &&state) noexcept
+		: socket_{std::move(socket)}
+		, state_{std::move(state)}
+	{
+	}
+
+	static result<handle> make (net::basic_datagram_socket<Protocol> &&socket, __event_loop::impl_type &loop) noexcept
+	{
+		if (loop.io_ == nullptr)
+		{
+			return make_unexpected(std::errc::operation_not_supported);
+		}
+
+		if (auto r = socket.set_option(net::non_blocking_io{true}); !r)
+		{
+			return unexpected{r.error()};
+		}
+
+		auto *state = new (std::nothrow) __io::datagram_state{};
+		if (state == nullptr)
+		{
+			return make_unexpected(std::errc::not_enough_memory);
+		}
+		state->loop = &loop;
+		state->handle = socket.native_socket().handle();
+		state->release = &__io::release<__io::datagram_state>;
+		state->name_capacity = endpoint_type{}.capacity();
+
+		if (auto r = loop.io_->datagram_open(loop, *state); !r)
+		{
+			delete state;
+			return unexpected{r.error()};
+		}
+
+		return handle{std::move(socket), state_ptr{state}};
+	}
+
+	friend class event_loop;
+};
+
+} // namespace pal::async
@@ -0,0 +1,192 @@
+#include <pal/async/datagram_socket.hpp>
+#include <pal/async/test.hpp>
+#include <pal/net/test.hpp>
+#include <pal/test.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using namespace pal::async;
+using namespace std::chrono_literals;
+
+using pal_test::default_backend;
+using pal_test::io_uring_backend;
+using pal_test::make_test_loop;
+using pal_test::run_until;
+
+using udp = pal::net::ip::udp;
+using socket_handle = handle<pal::net::basic_datagram_socket<udp>>;
+using datagram = socket_handle::datagram;
+
+socket_handle make_receiver (event_loop &loop)
+{
+	auto socket = pal::net::make_datagram_socket(udp::v4, pal_test::udp_v4::loopback_endpoint());
+	REQUIRE(socket);
+	auto h = loop.make_handle(std::move(*socket));
+	if (!h && h.error() == std::errc::operation_not_supported)
+	{
+		SKIP("backend has no socket support");
+	}
+	REQUIRE(h);
+	return std::move(*h);
+}
+
+TEMPLATE_TEST_CASE("async/datagram_socket", "", default_backend, io_uring_backend)
+{
+	auto loop = make_test_loop<TestType>();
+	auto receiver = make_receiver(loop);
+	const auto to = receiver.local_endpoint().value();
+
+	auto sender = pal::net::make_datagram_socket(udp::v4, pal_test::udp_v4::loopback_endpoint());
+	REQUIRE(sender);
+	const auto from = sender->local_endpoint().value();
+
+	constexpr std::string_view payload = "datagram";
+	const auto send = [&]
+	{
+		REQUIRE(sender->send_to(to, payload).value() == payload.size());
+	};
+
+	SECTION("start_receive_from")
+	{
+		int received = 0;
+		bool valid = true;
+
+		// clang-format off
+		receiver.start_receive_from([&] (pal::result<datagram> &&d) noexcept
+		{
+			valid = valid
+				&& d.has_value()
+				&& d->sender == from
+				&& d->data.size() == payload.size()
+				&& std::memcmp(d->data.data(), payload.data(), payload.size()) == 0;
+			++received;
+		});
+		// clang-format on
+
+		// one armed receive delivers every datagram
+		for (auto i = 0; i < 3; ++i)
+		{
+			send();
+		}
+		run_until(loop, [&] { return received == 3; });
+		CHECK(received == 3);
+		CHECK(valid);
+		CHECK(loop.stats().completions >= 3);
+	}
+
+	SECTION("stop_receive inside handler")
+	{
+		int received = 0;
+
+		// clang-format off
+		receiver.start_receive_from([&] (pal::result<datagram> &&) noexcept
+		{
+			++received;
+			receiver.stop_receive();
+		});
+		// clang-format on
+
+		send();
+		send();
+		run_until(loop, [&] { return received > 0; });
+		std::ignore = loop.run_for(20ms);
+		CHECK(received == 1);
+
+		// restart; datagrams the kernel already took for the stopped receive are not redelivered
+		receiver.start_receive_from([&] (pal::result<datagram> &&) noexcept { ++received; });
+		send();
+		run_until(loop, [&] { return received >= 2; });
+		CHECK(received >= 2);
+	}
+
+	SECTION("stop_receive: not receiving")
+	{
+		receiver.stop_receive();
+		CHECK(loop.run_once().value() == 0);
+	}
+
+	SECTION("destroy while receiving")
+	{
+		int received = 0;
+		{
+			auto other = make_receiver(loop);
+			other.start_receive_from([&] (pal::result<datagram> &&) noexcept { ++received; });
+			std::ignore = loop.run_once();
+		}
+		std::ignore = loop.run_for(10ms);
+		CHECK(received == 0);
+	}
+
+	SECTION("move assignment releases the previous receive")
+	{
+		int received = 0;
+		receiver.start_receive_from([&] (pal::result<datagram> &&) noexcept { ++received; });
+		receiver = make_receiver(loop);
+		send();
+		std::ignore = loop.run_for(20ms);
+		CHECK(received == 0);
+	}
+}
+
+TEMPLATE_TEST_CASE("async/datagram_socket buffers", "", default_backend, io_uring_backend)
+{
+	SECTION("recycled")
+	{
+		// far more datagrams than provided buffers: each returns to the pool when its handler returns
+		auto loop = make_test_loop<TestType>({.buffer_count = 4});
+		auto receiver = make_receiver(loop);
+		const auto to = receiver.local_endpoint().value();
+		auto sender = pal::net::make_datagram_socket(udp::v4, pal_test::udp_v4::loopback_endpoint());
+		REQUIRE(sender);
+
+		int received = 0;
+		receiver.start_receive_from([&] (pal::result<datagram> &&d) noexcept { received += d.has_value(); });
+
+		constexpr std::string_view payload = "x";
+		for (auto round = 0; round < 16; ++round)
+		{
+			REQUIRE(sender->send_to(to, payload));
+			REQUIRE(sender->send_to(to, payload));
+			run_until(loop, [&] { return received == 2 * (round + 1); });
+		}
+		CHECK(received == 32);
+	}
+
+	SECTION("truncated")
+	{
+		auto loop = make_test_loop<TestType>({.buffer_size = 128});
+		auto receiver = make_receiver(loop);
+		const auto to = receiver.local_endpoint().value();
+		auto sender = pal::net::make_datagram_socket(udp::v4, pal_test::udp_v4::loopback_endpoint());
+		REQUIRE(sender);
+
+		// same payload capacity on every backend: buffer_size exactly
+		std::vector<std::pair<size_t, bool>> received;
+		receiver.start_receive_from([&] (pal::result<datagram> &&d) noexcept
+		{
+			received.emplace_back(d->data.size(), d->truncated);
+		});
+
+		const std::array<std::byte, 500> payload{};
+		REQUIRE(sender->send_to(to, std::span{payload}.first(128)));
+		REQUIRE(sender->send_to(to, std::span{payload}.first(129)));
+		REQUIRE(sender->send_to(to, payload));
+		run_until(loop, [&] { return received.size() == 3; });
+		REQUIRE(received.size() == 3);
+		CHECK(received[0] == std::pair{size_t{128}, false});
+		CHECK(received[1] == std::pair{size_t{128}, true});
+		CHECK(received[2] == std::pair{size_t{128}, true});
+	}
+}
+
+} // namespace
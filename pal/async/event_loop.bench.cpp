@@ -0,0 +1,138 @@
+#include <pal/async/event_loop.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace
+{
+
+using namespace pal::async;
+using namespace std::chrono_literals;
+
+using clock = event_loop::clock;
+using timer_queue_type = event_loop_config::timer_queue_type;
+
+// One idle timeout per connection: \a timer_count timers stay armed, each re-arming on expiry with a fresh
+// timeout in [0, 10s). The loop is driven directly on virtual time, so a sample measures timer expiry and
+// re-arm only, with no polling or sleeping in between.
+struct timers
+{
+	__event_loop::impl_type loop{};
+	std::unique_ptr<task[]> tasks;
+	std::minstd_rand random{};
+
+	struct rearm
+	{
+		timers *self;
+
+		void operator() (task_ptr &&t) const noexcept
+		{
+			self->arm(std::move(t));
+		}
+	};
+
+	timers (timer_queue_type queue, size_t timer_count)
+		: tasks{new task[timer_count]}
+	{
+		loop.config_.timer_queue = queue;
+		loop.now_ = clock::time_point{1h};
+		for (size_t i = 0; i < timer_count; ++i)
+		{
+			arm(tasks[i].borrow());
+		}
+	}
+
+	void arm (task_ptr &&t) noexcept
+	{
+		t->bind<__event_loop::op_post>(rearm{this});
+		__event_loop::start_timer(loop, std::move(t), loop.now_ + 1ms * (random() % 10'000));
+	}
+
+	void run (Catch::Benchmark::Chronometer &meter)
+	{
+		// clang-format off
+		meter.measure([this]
+		{
+			size_t expired = 0;
+			for (auto step = 0; step < 100; ++step)
+			{
+				loop.now_ += 1ms;
+				expired += loop.expire_timers();
+			}
+			return expired;
+		});
+		// clang-format on
+	}
+};
+
+std::string to_string (event_loop_config::clock_source_type source)
+{
+	switch (source)
+	{
+		case event_loop_config::clock_source_type::precise:
+			return "precise";
+		case event_loop_config::clock_source_type::coarse:
+			return "coarse";
+		case event_loop_config::clock_source_type::tsc:
+			return "tsc";
+	}
+	return "?";
+}
+
+// Clock source cost: a bare read, and its share of a spinning run_once() iteration (two reads plus a
+// non-blocking poll)
+TEST_CASE("async/event_loop/clock_source", "[!benchmark]")
+{
+	event_loop_config config;
+	config.clock_source = GENERATE(
+		event_loop_config::clock_source_type::precise,
+		event_loop_config::clock_source_type::coarse,
+		event_loop_config::clock_source_type::tsc
+	);
+	const auto name = to_string(config.clock_source);
+
+	__event_loop::impl_type clock{};
+	clock.config_ = config;
+	clock.now_fn = [] (__event_loop::impl_type &) noexcept { return event_loop::clock::now(); };
+	__event_loop::init_clock(clock);
+
+	BENCHMARK("now/" + name)
+	{
+		return clock.now_fn(clock);
+	};
+
+	auto loop = make_loop(config);
+	REQUIRE(loop);
+
+	BENCHMARK("run_once/" + name)
+	{
+		return loop->run_once();
+	};
+}
+
+TEST_CASE("async/event_loop/timers", "[!benchmark]")
+{
+	const size_t timer_count = GENERATE(1'000, 100'000, 1'000'000);
+
+	{
+		timers heap{timer_queue_type::heap, timer_count};
+		BENCHMARK_ADVANCED("heap/" + std::to_string(timer_count))(auto meter)
+		{
+			heap.run(meter);
+		};
+	}
+
+	{
+		timers wheel{timer_queue_type::wheel, timer_count};
+		BENCHMARK_ADVANCED("wheel/" + std::to_string(timer_count))(auto meter)
+		{
+			wheel.run(meter);
+		};
+	}
+}
+
+} // namespace
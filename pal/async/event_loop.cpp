@@ -1,7 +1,24 @@
 #include <pal/async/event_loop.hpp>
 #include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <new>
 #include <utility>
 
+#if __pal_os_linux || __pal_os_macos
+	#include <time.h>
+#endif
+
+#if __pal_arch_x86_64
+	#if __pal_compiler_msvc
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+		#include <x86intrin.h>
+	#endif
+#endif
+
 namespace pal::async
 {
 
@@ -11,13 +28,17 @@ namespace __event_loop
 namespace
 {
 
-/// Armed timer's op state: https://en.wikipedia.org/wiki/Pairing_heap node. No decrease-key/removal: there
-/// is no cancellation, deadline moves use the lazy re-arm idiom.
+/// Armed timer's op state: https://en.wikipedia.org/wiki/Pairing_heap node, or a timer wheel list entry.
+/// \c prev is the back-link for removal (\ref cancel_timer): heap parent (if first child) or left sibling,
+/// wheel list predecessor (null at the head, \c slot names the list).
 struct timer_state
 {
 	impl_type::clock::time_point deadline;
 	task *child;
 	task *sibling;
+	task *prev;
+	uint64_t expiry;
+	uint16_t slot;
 };
 
 timer_state &timer (task &t) noexcept
@@ -25,19 +46,28 @@ timer_state &timer (task &t) noexcept
 	return t.scratch_as<timer_state>();
 }
 
+// Pairing heap {{{1
+
 task *meld (task *a, task *b) noexcept
 {
 	if (timer(*b).deadline < timer(*a).deadline)
 	{
 		std::swap(a, b);
 	}
-	timer(*b).sibling = timer(*a).child;
-	timer(*a).child = b;
+	auto &parent = timer(*a);
+	auto &child = timer(*b);
+	child.sibling = parent.child;
+	child.prev = a;
+	if (parent.child != nullptr)
+	{
+		timer(*parent.child).prev = b;
+	}
+	parent.child = b;
 	return a;
 }
 
-/// Standard pairing-heap two-pass merge of a popped root's child list; iterative, so heap size never costs
-/// stack depth.
+/// Standard pairing-heap two-pass merge of a removed node's child list into a new root, with no siblings
+/// nor parent; iterative, so heap size never costs stack depth.
 task *merge_pairs (task *first) noexcept
 {
 	task *paired = nullptr;
@@ -64,22 +94,410 @@ task *merge_pairs (task *first) noexcept
 		root = (root != nullptr) ? meld(root, paired) : paired;
 		paired = next;
 	}
+
+	if (root != nullptr)
+	{
+		timer(*root).sibling = timer(*root).prev = nullptr;
+	}
 	return root;
 }
 
+// Unlink \a t and merge its children back in: amortized O(log n), as popping the root
+void heap_remove (impl_type &l, task *t) noexcept
+{
+	auto &s = timer(*t);
+	if (t == l.timer_root_)
+	{
+		l.timer_root_ = merge_pairs(s.child);
+		return;
+	}
+
+	if (auto &prev = timer(*s.prev); prev.child == t)
+	{
+		prev.child = s.sibling;
+	}
+	else
+	{
+		prev.sibling = s.sibling;
+	}
+	if (s.sibling != nullptr)
+	{
+		timer(*s.sibling).prev = s.prev;
+	}
+
+	if (auto *children = merge_pairs(s.child); children != nullptr)
+	{
+		l.timer_root_ = meld(l.timer_root_, children);
+	}
+}
+
+// Timer wheel {{{1
+
+// Wheel list codes past the slots: timer_state::slot for timers on the due and expiring lists
+constexpr uint16_t due_list = timer_wheel::levels * timer_wheel::slots;
+constexpr uint16_t expiring_list = due_list + 1;
+
+task *&list_head (timer_wheel &w, uint16_t slot) noexcept
+{
+	if (slot == due_list)
+	{
+		return w.due;
+	}
+	else if (slot == expiring_list)
+	{
+		return w.expiring;
+	}
+	return w.slot[slot / timer_wheel::slots][slot % timer_wheel::slots];
+}
+
+void list_push (timer_wheel &w, uint16_t slot, task *t) noexcept
+{
+	auto &head = list_head(w, slot);
+	auto &s = timer(*t);
+	s.slot = slot;
+	s.prev = nullptr;
+	s.sibling = head;
+	if (head != nullptr)
+	{
+		timer(*head).prev = t;
+	}
+	head = t;
+}
+
+// Unlink \a t from its list: O(1), including a slot's occupancy bit
+void list_remove (timer_wheel &w, task *t) noexcept
+{
+	auto &s = timer(*t);
+	if (s.prev != nullptr)
+	{
+		timer(*s.prev).sibling = s.sibling;
+	}
+	else if ((list_head(w, s.slot) = s.sibling) == nullptr && s.slot < due_list)
+	{
+		w.occupied[s.slot / timer_wheel::slots] &= ~(uint64_t{1} << (s.slot % timer_wheel::slots));
+	}
+	if (s.sibling != nullptr)
+	{
+		timer(*s.sibling).prev = s.prev;
+	}
+}
+
+impl_type::clock::duration wheel_tick (const impl_type &l) noexcept
+{
+	return l.config_.timer_tick > impl_type::clock::duration::zero()
+		? l.config_.timer_tick
+		: event_loop_config::default_timer_tick;
+}
+
+// Ticks elapsed at \a time: a tick expires once it has fully passed
+uint64_t tick_floor (impl_type::clock::time_point time, impl_type::clock::duration tick) noexcept
+{
+	return static_cast<uint64_t>(std::max(time.time_since_epoch().count(), decltype(tick.count()){0})) / tick.count();
+}
+
+// First tick at whose expiry \a time has passed: rounding up, timers never fire early
+uint64_t tick_ceil (impl_type::clock::time_point time, impl_type::clock::duration tick) noexcept
+{
+	return tick_floor(time + tick - impl_type::clock::duration{1}, tick);
+}
+
+// Link \a t into the slot of its expiry tick, relative to next_tick
+void wheel_insert (timer_wheel &w, task *t) noexcept
+{
+	const auto expiry = std::max(timer(*t).expiry, w.next_tick);
+	auto distance = expiry - w.next_tick;
+	if (distance >= timer_wheel::span)
+	{
+		// parked at the span's end, re-armed from there on expiry
+		distance = timer_wheel::span - 1;
+	}
+
+	const auto level = distance > 0 ? (std::bit_width(distance) - 1) / timer_wheel::slot_bits : 0;
+	const auto index = ((w.next_tick + distance) >> (level * timer_wheel::slot_bits)) & (timer_wheel::slots - 1);
+	list_push(w, static_cast<uint16_t>(level * timer_wheel::slots + index), t);
+	w.occupied[level] |= uint64_t{1} << index;
+}
+
+task *wheel_take (timer_wheel &w, size_t level, size_t index) noexcept
+{
+	w.occupied[level] &= ~(uint64_t{1} << index);
+	return std::exchange(w.slot[level][index], nullptr);
+}
+
+// First tick at or after next_tick with work: a non-empty level 0 slot to expire, or a non-empty higher
+// level slot to cascade
+uint64_t wheel_next_event (const timer_wheel &w) noexcept
+{
+	auto next = std::numeric_limits<uint64_t>::max();
+	for (size_t level = 0; level != timer_wheel::levels; ++level)
+	{
+		if (w.occupied[level] == 0)
+		{
+			continue;
+		}
+
+		// level's slot position, rounded up to the next one that cascades at or after next_tick
+		const auto shift = level * timer_wheel::slot_bits;
+		auto position = w.next_tick >> shift;
+		if (level > 0 && (w.next_tick & ((uint64_t{1} << shift) - 1)) != 0)
+		{
+			++position;
+		}
+
+		const auto rotated = std::rotr(w.occupied[level], static_cast<int>(position & (timer_wheel::slots - 1)));
+		next = std::min(next, (position + std::countr_zero(rotated)) << shift);
+	}
+	return next;
+}
+
+// Redistribute the slot of each level whose lower levels wrapped around at next_tick
+void wheel_cascade (timer_wheel &w) noexcept
+{
+	for (size_t level = 1; level != timer_wheel::levels; ++level)
+	{
+		const auto shift = level * timer_wheel::slot_bits;
+		if ((w.next_tick & ((uint64_t{1} << shift) - 1)) != 0)
+		{
+			break;
+		}
+
+		const auto index = (w.next_tick >> shift) & (timer_wheel::slots - 1);
+		for (auto *t = wheel_take(w, level, index); t != nullptr; /**/)
+		{
+			auto *next = timer(*t).sibling;
+			wheel_insert(w, t);
+			t = next;
+		}
+	}
+}
+
+void wheel_start (impl_type &l, task *t) noexcept
+{
+	auto &w = l.timer_wheel_;
+	const auto tick = wheel_tick(l);
+	if (w.size++ == 0)
+	{
+		// empty: restart from the current tick rather than catch up on idle ones
+		w.next_tick = tick_floor(l.now_, tick) + 1;
+	}
+
+	if (timer(*t).deadline <= l.now_)
+	{
+		list_push(w, due_list, t);
+		return;
+	}
+
+	timer(*t).expiry = tick_ceil(timer(*t).deadline, tick);
+	wheel_insert(w, t);
+}
+
+// Complete the expiring list, front first, adding to \a n. It stays linked while its handlers run, so
+// they may cancel timers of the same batch. Returns false if the timer budget ran out first: the rest
+// waits on the due list for the next iteration.
+bool wheel_complete_expiring (impl_type &l, task *list, size_t &n) noexcept
+{
+	auto &w = l.timer_wheel_;
+	w.expiring = list;
+	for (auto *t = list; t != nullptr; t = timer(*t).sibling)
+	{
+		timer(*t).slot = expiring_list;
+	}
+
+	while (auto *t = w.expiring)
+	{
+		// unlink before complete(): the handler may re-arm this same task
+		list_remove(w, t);
+		if (timer(*t).deadline > l.now_)
+		{
+			// parked beyond the span
+			wheel_insert(w, t);
+			continue;
+		}
+		if (l.timer_quota_ == 0)
+		{
+			list_push(w, due_list, t);
+			while ((t = w.expiring) != nullptr)
+			{
+				list_remove(w, t);
+				list_push(w, due_list, t);
+			}
+			return false;
+		}
+		--l.timer_quota_;
+		--w.size;
+		t->complete({}, 0);
+		++n;
+	}
+	return true;
+}
+
+size_t wheel_expire (impl_type &l) noexcept
+{
+	auto &w = l.timer_wheel_;
+
+	// detached first: re-arming with a reached deadline waits for the next iteration
+	size_t n = 0;
+	bool complete = wheel_complete_expiring(l, std::exchange(w.due, nullptr), n);
+
+	const auto now_tick = tick_floor(l.now_, wheel_tick(l));
+	while (complete && w.next_tick <= now_tick)
+	{
+		// skip straight to the next tick with work
+		const auto tick = wheel_next_event(w);
+		if (tick > now_tick)
+		{
+			w.next_tick = now_tick + 1;
+			break;
+		}
+		else if (l.timer_quota_ == 0)
+		{
+			complete = false;
+			break;
+		}
+
+		w.next_tick = tick;
+		wheel_cascade(w);
+		auto *list = wheel_take(w, 0, tick & (timer_wheel::slots - 1));
+		w.next_tick = tick + 1;
+		complete = wheel_complete_expiring(l, list, n);
+	}
+
+	if (!complete)
+	{
+		++l.stats_.timer_budget_exhausted;
+	}
+	return n;
+}
+
+// }}}1
+
+// Clock sources {{{1
+
+#if __pal_os_linux || __pal_os_macos
+
+impl_type::clock::time_point coarse_now (impl_type &) noexcept
+{
+	#if __pal_os_linux
+	constexpr auto id = CLOCK_MONOTONIC_COARSE;
+	#else
+	constexpr auto id = CLOCK_UPTIME_RAW_APPROX;
+	#endif
+
+	::timespec ts{};
+	::clock_gettime(id, &ts);
+	return impl_type::clock::time_point{
+		std::chrono::duration_cast<impl_type::clock::duration>(std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec})
+	};
+}
+
+#endif
+
+#if __pal_arch_x86_64
+
+// Calibrate over this long before extrapolating; recalibrate as often
+constexpr auto tsc_calibration = std::chrono::milliseconds{10};
+constexpr auto tsc_resync = std::chrono::seconds{1};
+
+bool invariant_tsc () noexcept
+{
+	#if __pal_compiler_msvc
+	int regs[4];
+	::__cpuid(regs, 0x8000'0000);
+	if (static_cast<unsigned>(regs[0]) < 0x8000'0007)
+	{
+		return false;
+	}
+	::__cpuid(regs, 0x8000'0007);
+	return (regs[3] & (1 << 8)) != 0;
+	#else
+	unsigned eax, ebx, ecx, edx;
+	return ::__get_cpuid(0x8000'0007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8)) != 0;
+	#endif
+}
+
+impl_type::clock::time_point tsc_now (impl_type &l) noexcept
+{
+	using clock = impl_type::clock;
+
+	auto &c = l.tsc_;
+	const auto cycles = __rdtsc() - c.base_cycles;
+	clock::time_point now;
+	if (cycles < c.resync_cycles)
+	{
+		now = c.base_time + std::chrono::duration_cast<clock::duration>(
+			std::chrono::duration<double, std::nano>{static_cast<double>(cycles) * c.ns_per_cycle}
+		);
+	}
+	else
+	{
+		now = clock::now();
+		if (const auto elapsed = now - c.base_time; elapsed >= tsc_calibration)
+		{
+			c.ns_per_cycle = static_cast<double>(std::chrono::nanoseconds{elapsed}.count()) / static_cast<double>(cycles);
+			c.base_cycles += cycles;
+			c.base_time = now;
+			c.resync_cycles = static_cast<uint64_t>(static_cast<double>(std::chrono::nanoseconds{tsc_resync}.count()) / c.ns_per_cycle);
+		}
+	}
+
+	// a resync may land behind what extrapolation already returned
+	c.last = std::max(c.last, now);
+	return c.last;
+}
+
+#endif
+
+// }}}1
+
 } // namespace
 
+frame_arena::~frame_arena () noexcept
+{
+	while (auto *s = slabs)
+	{
+		slabs = s->next;
+		::operator delete(s);
+	}
+}
+
+bool frame_arena::refill (size_t index) noexcept
+{
+	auto *s = static_cast<slab *>(::operator new(slab_size, std::nothrow));
+	if (s == nullptr)
+	{
+		return false;
+	}
+	s->next = std::exchange(slabs, s);
+
+	// blocks start a granule past the slab header, keeping them granule-aligned relative to the slab
+	const auto size = (index + 1) * granularity;
+	auto *p = reinterpret_cast<std::byte *>(s) + granularity;
+	const auto *end = reinterpret_cast<std::byte *>(s) + slab_size;
+	for (; p + size <= end; p += size)
+	{
+		deallocate(p, size);
+	}
+	return true;
+}
+
 impl_type::~impl_type () noexcept
 {
 	pal_require(inbox_.empty(), "event_loop destroyed with a pending inbox");
 	pal_require(stats_.offload_in_flight == 0, "event_loop destroyed with offloaded ops in flight");
+	pal_require(stats_.coroutine_frames == 0, "event_loop destroyed with live coroutine frames");
 }
 
 size_t impl_type::drain_inbox () noexcept
 {
 	size_t n = 0;
-	while (task *t = inbox_.try_pop())
+	while (inbox_quota_ > 0)
 	{
+		task *t = inbox_.try_pop();
+		if (t == nullptr)
+		{
+			break;
+		}
+		--inbox_quota_;
 		t->complete({}, 0);
 		++n;
 	}
@@ -88,9 +506,21 @@ size_t impl_type::drain_inbox () noexcept
 
 size_t impl_type::expire_timers () noexcept
 {
+	if (config_.timer_queue == event_loop_config::timer_queue_type::wheel)
+	{
+		return timer_wheel_.size > 0 ? wheel_expire(*this) : 0;
+	}
+
 	size_t n = 0;
 	while (timer_root_ != nullptr && timer(*timer_root_).deadline <= now_)
 	{
+		if (timer_quota_ == 0)
+		{
+			++stats_.timer_budget_exhausted;
+			break;
+		}
+		--timer_quota_;
+
 		// pop before complete(): the handler may re-arm this same task
 		auto *t = timer_root_;
 		timer_root_ = merge_pairs(timer(*t).child);
@@ -100,8 +530,25 @@ size_t impl_type::expire_timers () noexcept
 	return n;
 }
 
+impl_type::clock::time_point impl_type::next_timer () const noexcept
+{
+	if (config_.timer_queue == event_loop_config::timer_queue_type::heap)
+	{
+		return timer(*timer_root_).deadline;
+	}
+	else if (timer_wheel_.due != nullptr)
+	{
+		return now_;
+	}
+	return clock::time_point{wheel_tick(*this) * static_cast<clock::rep>(wheel_next_event(timer_wheel_))};
+}
+
 size_t impl_type::iterate (clock::duration timeout) noexcept
 {
+	constexpr auto unbounded = std::numeric_limits<size_t>::max();
+	inbox_quota_ = config_.inbox_budget > 0 ? config_.inbox_budget : unbounded;
+	timer_quota_ = config_.timer_budget > 0 ? config_.timer_budget : unbounded;
+
 	now_ = now_fn(*this);
 
 	auto n = drain_inbox();
@@ -109,12 +556,32 @@ size_t impl_type::iterate (clock::duration timeout) noexcept
 	{
 		timeout = clock::duration::zero();
 	}
-	else if (timer_root_ != nullptr)
+	else if (timers_armed())
 	{
-		const auto &deadline = timer(*timer_root_).deadline;
+		auto deadline = next_timer();
+		if (deadline > now_ && config_.timer_slack > clock::duration::zero())
+		{
+			// round up to the window's end: deadlines sharing a window share a wake
+			const auto slack = config_.timer_slack;
+			deadline += (slack - deadline.time_since_epoch() % slack) % slack;
+		}
 		timeout = std::min(timeout, deadline > now_ ? deadline - now_ : clock::duration::zero());
 	}
 
+	if (timeout > clock::duration::zero() && config_.busy_poll > clock::duration::zero())
+	{
+		const auto start = now_;
+		if (const auto k = busy_poll(timeout); k > 0)
+		{
+			n += k;
+			timeout = clock::duration::zero();
+		}
+		else
+		{
+			timeout -= std::min(timeout, now_ - start);
+		}
+	}
+
 	n += poll_fn(*this, timeout);
 
 	now_ = now_fn(*this);
@@ -122,10 +589,62 @@ size_t impl_type::iterate (clock::duration timeout) noexcept
 	n += drain_inbox();
 	n += expire_timers();
 
+	if (inbox_quota_ == 0 && !inbox_.empty())
+	{
+		++stats_.inbox_budget_exhausted;
+	}
+
 	stats_.completions += n;
 	return n;
 }
 
+void init_clock (impl_type &l) noexcept
+{
+	using clock_source_type = event_loop_config::clock_source_type;
+
+	if (l.config_.clock_source == clock_source_type::coarse)
+	{
+#if __pal_os_linux || __pal_os_macos
+		l.now_fn = &coarse_now;
+#endif
+	}
+	else if (l.config_.clock_source == clock_source_type::tsc)
+	{
+#if __pal_arch_x86_64
+		if (invariant_tsc())
+		{
+			l.tsc_ = {.base_cycles = __rdtsc(), .base_time = impl_type::clock::now()};
+			l.now_fn = &tsc_now;
+		}
+#endif
+	}
+
+	l.now_ = l.now_fn(l);
+}
+
+size_t impl_type::busy_poll (clock::duration timeout) noexcept
+{
+	// posts landing meanwhile find the wake already "signaled" and skip the syscall
+	signaled_.store(true, std::memory_order_relaxed);
+
+	const auto until = now_ + std::min(timeout, config_.busy_poll);
+	size_t n = 0;
+	do
+	{
+		n = poll_fn(*this, clock::duration::zero()) + drain_inbox();
+		now_ = now_fn(*this);
+	} while (n == 0 && now_ < until);
+
+	// about to block: posts must wake again. Pairs with wake()'s exchange: either a post's exchange saw
+	// this one (and wakes) or this one sees the post (and no blocking follows).
+	signaled_.exchange(false, std::memory_order_acq_rel);
+	if (n == 0)
+	{
+		n = drain_inbox();
+	}
+	return n;
+}
+
 void post (impl_type &l, task_ptr &&t) noexcept
 {
 	task *raw = t.release();
@@ -133,19 +652,42 @@ void post (impl_type &l, task_ptr &&t) noexcept
 	l.wake_fn(l);
 }
 
+void post_chain (impl_type &l, task &first, task &last) noexcept
+{
+	l.inbox_.push_chain(first, last);
+	l.wake_fn(l);
+}
+
 void start_timer (impl_type &l, task_ptr &&t, impl_type::clock::time_point deadline) noexcept
 {
 	task *raw = t.release();
-	timer(*raw) = {.deadline = deadline, .child = nullptr, .sibling = nullptr};
+	timer(*raw) = {.deadline = deadline, .child = nullptr, .sibling = nullptr, .prev = nullptr, .expiry = 0, .slot = 0};
+	if (l.config_.timer_queue == event_loop_config::timer_queue_type::wheel)
+	{
+		wheel_start(l, raw);
+		return;
+	}
 	l.timer_root_ = (l.timer_root_ != nullptr) ? meld(l.timer_root_, raw) : raw;
 }
 
+void cancel_timer (impl_type &l, task &t) noexcept
+{
+	__task::attorney::unbind(t);
+	if (l.config_.timer_queue == event_loop_config::timer_queue_type::wheel)
+	{
+		list_remove(l.timer_wheel_, &t);
+		--l.timer_wheel_.size;
+		return;
+	}
+	heap_remove(l, &t);
+}
+
 } // namespace __event_loop
 
 result<size_t> event_loop::run () noexcept
 {
 	size_t total = 0;
-	while (!impl_->inbox_.empty() || impl_->timer_root_ != nullptr)
+	while (!impl_->inbox_.empty() || impl_->timers_armed())
 	{
 		total += impl_->iterate(clock::duration::max());
 	}
@@ -2,16 +2,23 @@
 
 #if __pal_os_linux
 
+#include <pal/async/__io.hpp>
 #include <pal/async/event_loop.hpp>
 #include <pal/error.hpp>
+#include <pal/require.hpp>
 
-#include <atomic>
+#include <array>
 #include <cerrno>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <linux/errqueue.h>
+#include <memory>
+#include <netinet/in.h>
 #include <new>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 namespace pal::async
@@ -23,11 +30,27 @@ namespace __event_loop
 namespace
 {
 
+using __io::acceptor_state;
+using __io::datagram_state;
+using __io::socket_state;
+using __io::stream_state;
+
 struct epoll_loop: impl_type
 {
 	int epoll = -1;
 	int wake = -1;
-	std::atomic<bool> signaled = false;
+
+	// Receive buffer shared by every datagram socket on this loop, allocated with the first one: handlers
+	// run synchronously inside the recvmsg loop, so one config_.buffer_size buffer serves them all
+	std::unique_ptr<std::byte[]> receive_buffer{};
+
+	// Closed socket states, released at the end of the current poll (an event of this batch may still
+	// name them)
+	socket_state *graveyard = nullptr;
+
+	// Closed stream states whose zero-copy payload the kernel still references: registered on a duplicate
+	// of their socket until the release shows on its error queue
+	socket_state *lingering = nullptr;
 
 	~epoll_loop () noexcept
 	{
@@ -36,6 +59,17 @@ struct epoll_loop: impl_type
 	}
 };
 
+// Events fetched per epoll_pwait2
+constexpr int max_events = 64;
+
+// Datagrams received per readiness event before yielding to other sockets; level-triggered, so the rest
+// is reported again by the next poll
+constexpr size_t receive_budget = 64;
+
+// Connections accepted per readiness event before yielding to other sockets; edge-triggered, so the rest
+// is re-reported by re-arming the interest
+constexpr size_t accept_budget = 64;
+
 constexpr ::timespec to_timespec (impl_type::clock::duration d) noexcept
 {
 	const auto wait = (d < impl_type::clock::duration::zero()) ? impl_type::clock::duration::zero() : d;
@@ -51,7 +85,7 @@ void drain_wake_channel (epoll_loop &self) noexcept
 {
 	uint64_t counter{};
 	std::ignore = ::read(self.wake, &counter, sizeof(counter));
-	self.signaled.store(false, std::memory_order_release);
+	self.signaled_.store(false, std::memory_order_release);
 	self.stats_.wakeups++;
 }
 
@@ -67,19 +101,33 @@ size_t epoll_poll (impl_type &base, impl_type::clock::duration timeout) noexcept
 		tsp = &ts;
 	}
 
-	::epoll_event event{};
+	std::array<::epoll_event, max_events> events{};
 	int r = 0;
 	do
 	{
-		r = ::epoll_pwait2(self.epoll, &event, 1, tsp, nullptr);
+		r = ::epoll_pwait2(self.epoll, events.data(), max_events, tsp, nullptr);
 	} while (r < 0 && errno == EINTR);
 
-	if (r > 0)
+	size_t n = 0;
+	for (int i = 0; i < r; ++i)
+	{
+		if (auto *ev = static_cast<io_event *>(events[i].data.ptr))
+		{
+			n += ev->fn(*ev, static_cast<int32_t>(events[i].events), 0);
+		}
+		else
+		{
+			drain_wake_channel(self);
+		}
+	}
+
+	while (auto *s = self.graveyard)
 	{
-		drain_wake_channel(self);
+		self.graveyard = s->next;
+		s->release(s);
 	}
 
-	return 0;
+	return n;
 }
 
 impl_type::clock::time_point epoll_now (impl_type &) noexcept
@@ -90,7 +138,7 @@ impl_type::clock::time_point epoll_now (impl_type &) noexcept
 void epoll_wake (impl_type &base) noexcept
 {
 	auto &self = static_cast<epoll_loop &>(base);
-	if (!self.signaled.exchange(true, std::memory_order_acq_rel))
+	if (!self.signaled_.exchange(true, std::memory_order_acq_rel))
 	{
 		const uint64_t one = 1;
 		std::ignore = ::write(self.wake, &one, sizeof(one));
@@ -99,9 +147,588 @@ void epoll_wake (impl_type &base) noexcept
 
 void epoll_destroy (impl_type *base) noexcept
 {
-	delete static_cast<epoll_loop *>(base);
+	auto *self = static_cast<epoll_loop *>(base);
+	while (auto *s = self->lingering)
+	{
+		// out of time to wait for the kernel: release regardless
+		self->lingering = s->next;
+		auto &stream = static_cast<stream_state &>(*s);
+		stream.zerocopy_held = false;
+		__io::complete_released(stream);
+		::close(net::__socket::to_sys(s->handle));
+		s->release(s);
+	}
+	while (auto *s = self->graveyard)
+	{
+		self->graveyard = s->next;
+		s->release(s);
+	}
+	delete self;
+}
+
+// Datagram sockets {{{1
+//
+// Registered at open with no interest (edge-triggered, so an unarmed socket's pending error is reported
+// once, not spun on); a receive switches interest to level-triggered EPOLLIN.
+
+int interest (socket_state &s, uint32_t events) noexcept
+{
+	::epoll_event event{.events = events, .data = {.ptr = static_cast<io_event *>(&s)}};
+	return ::epoll_ctl(static_cast<epoll_loop &>(*s.loop).epoll, EPOLL_CTL_MOD, net::__socket::to_sys(s.handle), &event);
+}
+
+void stop_receive (datagram_state &s) noexcept
+{
+	if (s.receive_active)
+	{
+		// MOD of a registered descriptor fails only on kernel memory exhaustion; a stale EPOLLIN is
+		// then filtered by the disarmed completion
+		std::ignore = interest(s, EPOLLET);
+		s.receive_active = false;
+	}
+}
+
+size_t on_receive (io_event &ev, int32_t, uint32_t) noexcept
+{
+	auto &s = static_cast<datagram_state &>(ev);
+	auto &self = static_cast<epoll_loop &>(*s.loop);
+	const std::span<std::byte> buffer{self.receive_buffer.get(), self.config_.buffer_size};
+
+	size_t n = 0;
+	while (n < receive_budget && s.receive.armed() && !s.closed)
+	{
+		s.message.set(buffer);
+		s.message.name(&s.name_storage, s.name_capacity);
+		const auto r = ::recvmsg(net::__socket::to_sys(s.handle), &s.message, 0);
+		if (r == -1)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				const auto error = errno;
+				stop_receive(s);
+				s.receive.complete(s, std::error_code{error, std::generic_category()}, 0);
+				++n;
+			}
+			break;
+		}
+
+		s.name = &s.name_storage;
+		s.name_size = s.message.msg_namelen;
+		s.data = buffer.first(static_cast<size_t>(r));
+		s.truncated = (s.message.msg_flags & MSG_TRUNC) != 0;
+		s.receive.complete(s, {}, s.data.size());
+		++n;
+	}
+	return n;
+}
+
+result<void> register_socket (epoll_loop &self, socket_state &s) noexcept
+{
+	::epoll_event event{.events = EPOLLET, .data = {.ptr = static_cast<io_event *>(&s)}};
+	if (::epoll_ctl(self.epoll, EPOLL_CTL_ADD, net::__socket::to_sys(s.handle), &event) == -1)
+	{
+		return unexpected{pal::this_thread::last_system_error()};
+	}
+	return {};
+}
+
+void close (socket_state *s) noexcept
+{
+	auto &self = static_cast<epoll_loop &>(*s->loop);
+	std::ignore = ::epoll_ctl(self.epoll, EPOLL_CTL_DEL, net::__socket::to_sys(s->handle), nullptr);
+	s->next = self.graveyard;
+	self.graveyard = s;
+}
+
+result<void> datagram_open (impl_type &base, datagram_state &s) noexcept
+{
+	auto &self = static_cast<epoll_loop &>(base);
+	if (self.receive_buffer == nullptr)
+	{
+		if (self.config_.buffer_size == 0)
+		{
+			return make_unexpected(std::errc::invalid_argument);
+		}
+		self.receive_buffer.reset(new (std::nothrow) std::byte[self.config_.buffer_size]);
+		if (self.receive_buffer == nullptr)
+		{
+			return make_unexpected(std::errc::not_enough_memory);
+		}
+	}
+
+	s.fn = &on_receive;
+	return register_socket(self, s);
+}
+
+void datagram_close (datagram_state *s) noexcept
+{
+	close(s);
+}
+
+void start_receive_from (datagram_state &s) noexcept
+{
+	if (!s.receive_active)
+	{
+		// see stop_receive: an unregistered interest leaves the receive armed but idle
+		std::ignore = interest(s, EPOLLIN);
+		s.receive_active = true;
+	}
+}
+
+// Acceptors {{{1
+//
+// Edge-triggered throughout: an armed accept drains the backlog with accept4 per readiness event. When
+// the budget runs out first, re-arming the interest makes epoll report the still-ready listener again.
+
+void stop_accept (acceptor_state &s) noexcept
+{
+	if (s.accept_active)
+	{
+		std::ignore = interest(s, EPOLLET);
+		s.accept_active = false;
+	}
+}
+
+// Failures of one pending connection, not of the listener: skip it and keep accepting
+constexpr bool is_transient_accept_error (int error) noexcept
+{
+	switch (error)
+	{
+		case EINTR:
+		case ECONNABORTED:
+		case EPROTO:
+		case EPERM:
+		case ENETDOWN:
+		case ENOPROTOOPT:
+		case EHOSTDOWN:
+		case ENONET:
+		case EHOSTUNREACH:
+		case EOPNOTSUPP:
+		case ENETUNREACH:
+			return true;
+		default:
+			return false;
+	}
+}
+
+size_t on_accept (io_event &ev, int32_t, uint32_t) noexcept
+{
+	auto &s = static_cast<acceptor_state &>(ev);
+
+	size_t n = 0;
+	while (s.accept.armed() && !s.closed)
+	{
+		if (n == accept_budget)
+		{
+			std::ignore = interest(s, EPOLLIN | EPOLLET);
+			break;
+		}
+
+		const auto r = ::accept4(net::__socket::to_sys(s.handle), nullptr, nullptr, 0);
+		if (r == -1)
+		{
+			if (is_transient_accept_error(errno))
+			{
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				const auto error = errno;
+				stop_accept(s);
+				s.accept.complete(s, std::error_code{error, std::generic_category()}, 0);
+				++n;
+			}
+			break;
+		}
+
+		s.accepted = net::__socket::from_sys(r);
+		s.accept.complete(s, {}, 0);
+		++n;
+	}
+	return n;
+}
+
+result<void> acceptor_open (impl_type &base, acceptor_state &s) noexcept
+{
+	s.fn = &on_accept;
+	return register_socket(static_cast<epoll_loop &>(base), s);
+}
+
+void acceptor_close (acceptor_state *s) noexcept
+{
+	close(s);
+}
+
+void start_accept (acceptor_state &s) noexcept
+{
+	if (!s.accept_active)
+	{
+		// MOD reports an already pending backlog as a fresh edge
+		std::ignore = interest(s, EPOLLIN | EPOLLET);
+		s.accept_active = true;
+	}
+}
+
+// Stream sockets {{{1
+//
+// Single-shot ops run when the socket is ready: interest is level-triggered EPOLLIN/EPOLLOUT for the
+// directions with an operation pending, edge-triggered none otherwise. Each op's syscall happens on its
+// readiness event, never inside start_*, so handlers always run from a later poll.
+
+std::error_code stream_error (int error) noexcept
+{
+	// unify with the synchronous send: broken pipe is a lost connection
+	return {(error == EPIPE) ? ENOTCONN : error, std::generic_category()};
+}
+
+void update_interest (stream_state &s) noexcept
+{
+	uint32_t events = 0;
+	if (s.read.pending != nullptr)
+	{
+		events |= EPOLLIN;
+	}
+	if (s.write.pending != nullptr && !s.zerocopy_held)
+	{
+		events |= EPOLLOUT;
+	}
+	if (events != s.interest)
+	{
+		// see stop_receive: a failed MOD leaves an op idle until the next update
+		std::ignore = interest(s, events != 0 ? events : EPOLLET);
+		s.interest = events;
+	}
+}
+
+// Run \a op's syscall \a io; returns the completion count (0 if the socket is not ready after all)
+template <typename IO>
+size_t run_op (__io::stream_op &op, IO io) noexcept
+{
+	ssize_t r;
+	do
+	{
+		r = io(*op.pending);
+	} while (r == -1 && errno == EINTR);
+
+	if (r == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+	{
+		return 0;
+	}
+
+	// clear before complete(): the handler may start the next op in this direction
+	auto *t = std::exchange(op.pending, nullptr);
+	if (r == -1)
+	{
+		t->complete(stream_error(errno), 0);
+	}
+	else
+	{
+		t->complete({}, static_cast<size_t>(r));
+	}
+	return 1;
+}
+
+// Drain MSG_ZEROCOPY notifications off \a s error queue; true if one covers the send awaiting release
+bool zerocopy_released (stream_state &s) noexcept
+{
+	bool released = false;
+	for (;;)
+	{
+		alignas(::cmsghdr) std::array<std::byte, CMSG_SPACE(sizeof(::sock_extended_err) + sizeof(::sockaddr_in6))> control;
+		::msghdr message{};
+		message.msg_control = control.data();
+		message.msg_controllen = control.size();
+		if (::recvmsg(net::__socket::to_sys(s.handle), &message, MSG_ERRQUEUE) == -1)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return released;
+		}
+
+		for (auto *c = CMSG_FIRSTHDR(&message); c != nullptr; c = CMSG_NXTHDR(&message, c))
+		{
+			if ((c->cmsg_level == SOL_IP && c->cmsg_type == IP_RECVERR)
+				|| (c->cmsg_level == SOL_IPV6 && c->cmsg_type == IPV6_RECVERR))
+			{
+				::sock_extended_err error;
+				std::memcpy(&error, CMSG_DATA(c), sizeof(error));
+
+				// [ee_info, ee_data] range of completed send sequence numbers, wrapping
+				released = released
+					|| (error.ee_origin == SO_EE_ORIGIN_ZEROCOPY
+						&& s.zerocopy_id - error.ee_info <= error.ee_data - error.ee_info);
+			}
+		}
+	}
+}
+
+size_t release_zerocopy (stream_state &s) noexcept
+{
+	if (!zerocopy_released(s))
+	{
+		return 0;
+	}
+	s.zerocopy_held = false;
+	__io::complete_released(s);
+	return 1;
+}
+
+size_t send_zerocopy (stream_state &s) noexcept
+{
+	const auto payload = s.write.pending->span();
+	auto error = std::exchange(s.error, 0);
+	if (error == 0)
+	{
+		ssize_t r;
+		do
+		{
+			r = ::send(net::__socket::to_sys(s.handle), payload.data(), payload.size(), MSG_NOSIGNAL | MSG_ZEROCOPY);
+		} while (r == -1 && errno == EINTR);
+
+		if (r != -1)
+		{
+			s.zerocopy_id = s.zerocopy_next++;
+			s.zerocopy_held = true;
+			__io::complete_sent(s, {}, static_cast<size_t>(r));
+			return 1;
+		}
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			return 0;
+		}
+		error = errno;
+	}
+
+	// the kernel took nothing: both phases now
+	__io::complete_sent(s, stream_error(error), 0);
+	__io::complete_released(s);
+	return 2;
+}
+
+void unlink_lingering (epoll_loop &self, socket_state &s) noexcept
+{
+	auto **p = &self.lingering;
+	while (*p != &s)
+	{
+		p = &(*p)->next;
+	}
+	*p = s.next;
+}
+
+size_t on_stream (io_event &ev, int32_t, uint32_t) noexcept
+{
+	auto &s = static_cast<stream_state &>(ev);
+	if (s.closed)
+	{
+		// lingering (see stream_close) awaits its release only; otherwise closed within this batch
+		if (!s.zerocopy_held || release_zerocopy(s) == 0)
+		{
+			return 0;
+		}
+		auto &self = static_cast<epoll_loop &>(*s.loop);
+		unlink_lingering(self, s);
+		std::ignore = ::epoll_ctl(self.epoll, EPOLL_CTL_DEL, net::__socket::to_sys(s.handle), nullptr);
+		::close(net::__socket::to_sys(s.handle));
+		s.next = self.graveyard;
+		self.graveyard = &s;
+		return 1;
+	}
+
+	const auto fd = net::__socket::to_sys(s.handle);
+	size_t n = 0;
+	s.dispatching = true;
+
+	if (s.zerocopy_held)
+	{
+		n += release_zerocopy(s);
+	}
+
+	if (s.read.pending != nullptr && !s.closed)
+	{
+		n += run_op(s.read, [fd, &s] (task &t) noexcept
+		{
+			if (t.next_segment() != nullptr)
+			{
+				if (const auto vectors = __io::gather(s.read, t); vectors.size() > 1)
+				{
+					net::__socket::message message{};
+					message.set(vectors);
+					return ::recvmsg(fd, &message, 0);
+				}
+			}
+			return ::recv(fd, t.span().data(), t.span().size(), 0);
+		});
+	}
+
+	if (s.write.pending != nullptr && !s.zerocopy_held && !s.closed)
+	{
+		if (s.connecting)
+		{
+			n += run_op(s.write, [fd, &s] (task &) noexcept -> ssize_t
+			{
+				int error = std::exchange(s.error, 0);
+				if (error == 0)
+				{
+					socklen_t size = sizeof(error);
+					if (::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size) == -1)
+					{
+						error = errno;
+					}
+				}
+				s.connecting = false;
+				errno = error;
+				return error == 0 ? 0 : -1;
+			});
+		}
+		else if (s.zerocopy)
+		{
+			n += send_zerocopy(s);
+		}
+		else
+		{
+			n += run_op(s.write, [fd, &s] (task &t) noexcept
+			{
+				if (t.next_segment() != nullptr)
+				{
+					if (const auto vectors = __io::gather(s.write, t); vectors.size() > 1)
+					{
+						net::__socket::message message{};
+						message.set(vectors);
+						return ::sendmsg(fd, &message, MSG_NOSIGNAL);
+					}
+				}
+				return ::send(fd, t.span().data(), t.span().size(), MSG_NOSIGNAL);
+			});
+		}
+	}
+
+	s.dispatching = false;
+	if (!s.closed)
+	{
+		update_interest(s);
+	}
+	return n;
+}
+
+result<void> stream_open (impl_type &base, stream_state &s) noexcept
+{
+	s.fn = &on_stream;
+	return register_socket(static_cast<epoll_loop &>(base), s);
+}
+
+void stream_close (stream_state *s) noexcept
+{
+	auto &self = static_cast<epoll_loop &>(*s->loop);
+	if (s->zerocopy_held)
+	{
+		// the kernel still reads the payload: watch the error queue through a duplicate of the socket
+		// (the caller closes the original right after), re-registered as the registration is keyed by it
+		const auto fd = ::dup(net::__socket::to_sys(s->handle));
+		if (fd != -1)
+		{
+			std::ignore = ::epoll_ctl(self.epoll, EPOLL_CTL_DEL, net::__socket::to_sys(s->handle), nullptr);
+			s->handle = net::__socket::from_sys(fd);
+			::epoll_event event{.events = EPOLLET, .data = {.ptr = static_cast<io_event *>(s)}};
+			if (::epoll_ctl(self.epoll, EPOLL_CTL_ADD, fd, &event) == 0)
+			{
+				s->next = self.lingering;
+				self.lingering = s;
+				return;
+			}
+			::close(fd);
+		}
+		// no way to learn of the release: hand the payload back now
+		s->zerocopy_held = false;
+	}
+
+	// pending ops are cancelled by the graveyard release (see __io::release_stream)
+	close(s);
+}
+
+void start (stream_state &s, __io::stream_op &op, task &t) noexcept
+{
+	pal_require(op.pending == nullptr, "stream operation already pending in this direction");
+	op.pending = &t;
+	if (!s.dispatching)
+	{
+		update_interest(s);
+	}
+}
+
+void start_connect (stream_state &s, task &t, const void *endpoint, size_t endpoint_size) noexcept
+{
+	// completes on writability; a refused or failed call leaves the socket closed, which epoll reports
+	// as a hangup
+	const auto r = ::connect(
+		net::__socket::to_sys(s.handle),
+		static_cast<const ::sockaddr *>(endpoint),
+		static_cast<socklen_t>(endpoint_size)
+	);
+	s.error = (r == -1 && errno != EINPROGRESS) ? errno : 0;
+	s.connecting = true;
+	start(s, s.write, t);
+}
+
+void start_send (stream_state &s, task &t) noexcept
+{
+	start(s, s.write, t);
 }
 
+void start_send_zerocopy (stream_state &s, task &t) noexcept
+{
+	if (!s.zerocopy_enabled)
+	{
+		// without SO_ZEROCOPY the kernel silently ignores MSG_ZEROCOPY and never notifies
+		const int on = 1;
+		if (::setsockopt(net::__socket::to_sys(s.handle), SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) == 0)
+		{
+			s.zerocopy_enabled = true;
+		}
+		else
+		{
+			s.error = errno;
+		}
+	}
+	s.zerocopy = true;
+	start(s, s.write, t);
+}
+
+void start_receive (stream_state &s, task &t) noexcept
+{
+	start(s, s.read, t);
+}
+
+constexpr __io::ops io_ops = {
+	.datagram_open = &datagram_open,
+	.datagram_close = &datagram_close,
+	.start_receive_from = &start_receive_from,
+	.stop_receive = &stop_receive,
+	.acceptor_open = &acceptor_open,
+	.acceptor_close = &acceptor_close,
+	.start_accept = &start_accept,
+	.stop_accept = &stop_accept,
+	.stream_open = &stream_open,
+	.stream_close = &stream_close,
+	.start_connect = &start_connect,
+	.start_send = &start_send,
+	.start_send_zerocopy = &start_send_zerocopy,
+	.start_receive = &start_receive,
+
+	// regular files are always "ready": file handles offload to a thread_pool
+	.start_read_at = nullptr,
+	.start_write_at = nullptr,
+	.start_fsync = nullptr,
+	.file_close = nullptr,
+};
+
+// }}}1
+
 } // namespace
 
 } // namespace __event_loop
@@ -147,8 +774,9 @@ result<event_loop> make_loop (const event_loop_config &config) noexcept
 	self->wake_fn = &epoll_wake;
 	self->now_fn = &epoll_now;
 	self->destroy_fn = &epoll_destroy;
+	self->io_ = &io_ops;
 	self->config_ = config;
-	self->now_ = epoll_now(*self);
+	init_clock(*self);
 
 	return event_loop{impl_ptr{self}};
 }
@@ -9,8 +9,12 @@
 #include <pal/require.hpp>
 #include <pal/result.hpp>
 #include <pal/version.hpp>
+#include <atomic>
 #include <chrono>
+#include <limits>
 #include <memory>
+#include <new>
+#include <utility>
 
 namespace pal::async
 {
@@ -20,18 +24,85 @@ class thread_pool;
 template <typename T>
 class handle;
 
-/// Backend sizing knobs: buffer-pool capacity and submission/completion ring depths.
-/// Capacities only -- no steering or scheduling policy.
+namespace __coroutine
+{
+
+struct frame;
+
+} // namespace __coroutine
+
+/// Event loop knobs: receive buffer pool and submission/completion ring capacities, timer queue and
+/// coalescing, clock source, and per-iteration scheduling (busy-poll, inbox and timer budgets).
 struct event_loop_config
 {
 	static constexpr size_t default_buffer_count = 8192;
 	size_t buffer_count = default_buffer_count;
 
+	/// Payload bytes of each receive buffer: the longest datagram delivered whole, on every backend.
 	static constexpr uint16_t default_buffer_size = 2000;
 	uint16_t buffer_size = default_buffer_size;
 
+	/// Submission ring entries (io_uring SQ); 0 selects the backend default. Ignored by backends
+	/// without a submission ring. Depths past the kernel's 32-bit range fail with
+	/// \c std::errc::invalid_argument.
 	size_t submission_depth = 0;
+
+	/// Completion ring entries (io_uring CQ); 0 selects the backend default (twice the submission
+	/// depth). Ignored by backends without a completion ring. Same range as \ref submission_depth.
 	size_t completion_depth = 0;
+
+	/// Timer queue behind \ref event_loop::post_after.
+	enum class timer_queue_type
+	{
+		/// Pairing heap: exact deadlines, O(log n) amortized expiry. Suits up to a few thousand timers.
+		heap,
+
+		/// Hashed hierarchical timer wheel: O(1) arm and expiry, deadlines rounded up to a whole
+		/// \ref timer_tick. Suits many coarse timers, e.g. an idle timeout per connection.
+		wheel,
+	};
+	timer_queue_type timer_queue = timer_queue_type::heap;
+
+	/// Timer wheel granularity; 0 selects \ref default_timer_tick. Ignored by the heap.
+	static constexpr std::chrono::steady_clock::duration default_timer_tick = std::chrono::milliseconds{1};
+	std::chrono::steady_clock::duration timer_tick{};
+
+	/// Timer coalescing window, as Linux timerslack: the loop may run a timer up to this much past its
+	/// deadline, so it wakes once for every deadline within a window rather than once per deadline. Wakes
+	/// align to multiples of the window on the loop's clock. 0 wakes at each deadline (or wheel tick).
+	std::chrono::steady_clock::duration timer_slack{};
+
+	/// Time source behind \ref event_loop::now, read twice per iteration. All share steady_clock's epoch.
+	enum class clock_source_type
+	{
+		/// steady_clock: exact, a vDSO clock_gettime per read.
+		precise,
+
+		/// CLOCK_MONOTONIC_COARSE (Linux) or CLOCK_UPTIME_RAW_APPROX (macOS): cheaper per read, but lags by
+		/// up to a kernel tick (1-10ms), delaying timers as much. Elsewhere: \c precise.
+		coarse,
+
+		/// Invariant TSC (x86-64): rdtsc scaled by a calibration against steady_clock, resynced every
+		/// second; steady_clock until the first 10ms calibration window passes. Elsewhere, or without an
+		/// invariant TSC: \c precise.
+		tsc,
+	};
+	clock_source_type clock_source = clock_source_type::precise;
+
+	/// Busy-poll budget: before blocking, an iteration with nothing to dispatch keeps polling the inbox and
+	/// the backend without blocking for up to this long, and cross-thread \ref event_loop::post skips the
+	/// wake syscall meanwhile. Trades a core for wakeup latency (the wake syscall and the scheduler's
+	/// wakeup, tens of microseconds). 0 never spins.
+	std::chrono::steady_clock::duration busy_poll{};
+
+	/// Most posts an iteration dispatches; the rest wait for the next one, which polls the backend without
+	/// blocking first. Bounds how long a flood of cross-thread posts holds off I/O completions and timers
+	/// (see \ref event_loop_stats::inbox_budget_exhausted). 0 drains the inbox whole.
+	size_t inbox_budget = 0;
+
+	/// Most timers an iteration expires; as \ref inbox_budget, for a burst of due timers (see
+	/// \ref event_loop_stats::timer_budget_exhausted). 0 expires every due timer.
+	size_t timer_budget = 0;
 };
 
 /// Per-loop observability counters. Only the loop thread mutates them.
@@ -47,11 +118,130 @@ struct event_loop_stats
 	/// completed back on it. Before teardown, quiesce by running the loop until this reaches zero.
 	/// Plain \ref thread_pool::post offloads are not counted.
 	uint64_t offload_in_flight = 0;
+
+	/// Iterations that left posts in the inbox on reaching \ref event_loop_config::inbox_budget
+	uint64_t inbox_budget_exhausted = 0;
+
+	/// Iterations that left due timers unexpired on reaching \ref event_loop_config::timer_budget
+	uint64_t timer_budget_exhausted = 0;
+
+	/// Live coroutine frames allocated from this loop's frame arena (see pal/async/coroutine.hpp). Before
+	/// teardown, quiesce by running the loop until this reaches zero.
+	uint64_t coroutine_frames = 0;
 };
 
+namespace __io
+{
+
+struct ops;
+
+} // namespace __io
+
 namespace __event_loop
 {
 
+/// Backend completion target for kernel-side I/O: an io_uring CQE's user_data or an epoll event's data.ptr
+/// points at one (null is the loop's own wake channel). \c fn receives the backend's raw result (CQE res, or
+/// the epoll event mask) and flags (CQE flags; 0 on epoll) and returns the number of completions it
+/// dispatched. Embedded in heap-stable per-resource state, never in a task.
+struct io_event
+{
+	size_t (*fn)(io_event &self, int32_t res, uint32_t flags) noexcept = nullptr;
+};
+
+/// Hashed hierarchical timer wheel (Varghese & Lauck): \c levels wheels of \c slots each, level \c l
+/// slot \c s listing timers due in <tt>[slots^l, slots^(l+1))</tt> ticks hashed by their expiry tick's
+/// bits. Level 0 slots expire whole; a higher-level slot cascades into lower levels once the lower ones
+/// wrap around to it. Deadlines beyond the span are parked at its end and re-armed on expiry.
+struct timer_wheel
+{
+	static constexpr size_t slot_bits = 6, slots = size_t{1} << slot_bits, levels = 6;
+	static constexpr uint64_t span = uint64_t{1} << (slot_bits * levels);
+
+	// first tick not yet expired; arming is relative to it
+	uint64_t next_tick = 0;
+	size_t size = 0;
+
+	// armed with a deadline already reached: expired by the next iteration, not a tick later
+	task *due = nullptr;
+
+	// the batch being completed, still cancellable from its handlers
+	task *expiring = nullptr;
+
+	// per level: bit s set iff slot s is non-empty
+	uint64_t occupied[levels]{};
+	task *slot[levels][slots]{};
+};
+
+/// TSC clock source state: \c now extrapolates from \c base by \c ns_per_cycle, until \c resync_cycles
+/// have passed (0: calibrating). \c last keeps resyncs from stepping time back.
+struct tsc_clock
+{
+	uint64_t base_cycles = 0;
+	std::chrono::steady_clock::time_point base_time{};
+	double ns_per_cycle = 0;
+	uint64_t resync_cycles = 0;
+	std::chrono::steady_clock::time_point last{};
+};
+
+/// Coroutine frame allocator of one loop (see pal/async/coroutine.hpp): frames of up to \c max_size bytes
+/// come from per-size-class free lists refilled from slabs, so steady-state frame churn never reaches the
+/// global heap; larger frames do. Slabs are kept until the loop is destroyed. Loop-thread only.
+struct frame_arena
+{
+	static constexpr size_t granularity = 64, classes = 16, max_size = granularity * classes;
+	static constexpr size_t slab_size = 64 * 1024;
+
+	struct block
+	{
+		block *next;
+	};
+
+	struct slab
+	{
+		slab *next;
+	};
+
+	block *free[classes]{};
+	slab *slabs = nullptr;
+
+	frame_arena () noexcept = default;
+	~frame_arena () noexcept;
+
+	frame_arena (const frame_arena &) = delete;
+	frame_arena &operator= (const frame_arena &) = delete;
+
+	/// Block of at least \a size (non-zero) bytes, aligned for any frame; nullptr if out of memory.
+	[[nodiscard]] void *allocate (size_t size) noexcept
+	{
+		if (size > max_size)
+		{
+			return ::operator new(size, std::nothrow);
+		}
+		auto &head = free[(size - 1) / granularity];
+		if (head == nullptr && !refill((size - 1) / granularity))
+		{
+			return nullptr;
+		}
+		return std::exchange(head, head->next);
+	}
+
+	/// Return block \a p, allocated with the same \a size.
+	void deallocate (void *p, size_t size) noexcept
+	{
+		if (size > max_size)
+		{
+			::operator delete(p);
+			return;
+		}
+		auto &head = free[(size - 1) / granularity];
+		head = ::new (p) block{head};
+	}
+
+	/// Carve a new slab into blocks of size class \a index.
+	bool refill (size_t index) noexcept;
+};
+
 struct impl_type
 {
 	using clock = std::chrono::steady_clock;
@@ -62,18 +252,43 @@ struct impl_type
 	clock::time_point (*now_fn)(impl_type &) noexcept = nullptr;
 	void (*destroy_fn)(impl_type *) noexcept = nullptr;
 
+	// socket/file operations; null if the backend has none (handles for such resources fail to make)
+	const __io::ops *io_ = nullptr;
+
 	// portable state
 	clock::time_point now_{};
 	task *timer_root_ = nullptr;
+	timer_wheel timer_wheel_{};
 	__task::attorney::task_mpsc_queue inbox_{};
+
+	// Wake coalescing: set by the first wake() until the loop drains its wake channel, so further wakes
+	// skip the syscall. A busy-polling loop holds it set: it sees posts without being woken.
+	std::atomic<bool> signaled_ = false;
+
+	// what is left of the current iteration's inbox and timer budgets; iterate() refills them
+	size_t inbox_quota_ = (std::numeric_limits<size_t>::max)();
+	size_t timer_quota_ = (std::numeric_limits<size_t>::max)();
+
 	event_loop_stats stats_{};
 	event_loop_config config_{};
+	tsc_clock tsc_{};
+	frame_arena frames_{};
 
 	~impl_type () noexcept;
 
 	size_t iterate (clock::duration timeout) noexcept;
+	size_t busy_poll (clock::duration timeout) noexcept;
 	size_t drain_inbox () noexcept;
 	size_t expire_timers () noexcept;
+
+	/// Whether any timer is armed
+	[[nodiscard]] bool timers_armed () const noexcept
+	{
+		return timer_root_ != nullptr || timer_wheel_.size > 0;
+	}
+
+	/// Earliest time expire_timers() may have work; only valid if timers_armed().
+	[[nodiscard]] clock::time_point next_timer () const noexcept;
 };
 
 struct deleter
@@ -101,17 +316,84 @@ struct op_post
 	}
 };
 
+/// Apply config_.clock_source over the backend's now_fn (kept for \c precise, or where the source is
+/// unavailable) and read the first now_. Backends call it once config_ and now_fn are set.
+void init_clock (impl_type &l) noexcept;
+
 /// Enqueue an already-bound task onto the loop's inbox and wake it. Thread-safe.
 void post (impl_type &l, task_ptr &&t) noexcept;
 
-/// Push an already-bound task onto the loop's timer heap, keyed by \a deadline. Loop-thread only.
+/// Splice a chain of already-bound tasks, linked via task_mpsc_queue::link, onto the loop's inbox with a
+/// single exchange and wake it once. Thread-safe.
+void post_chain (impl_type &l, task &first, task &last) noexcept;
+
+/// Push an already-bound task onto the loop's timer queue, keyed by \a deadline. Loop-thread only.
 void start_timer (impl_type &l, task_ptr &&t, impl_type::clock::time_point deadline) noexcept;
 
+/// Unlink an armed timer task from the loop's timer queue and unbind it. Loop-thread only.
+void cancel_timer (impl_type &l, task &t) noexcept;
+
 } // namespace __event_loop
 
+/// Posts gathered by one producer thread for a single \ref event_loop::post_batch. \ref add binds each
+/// task's handler and links it behind the previous one, privately: nothing is shared with the loop until
+/// the batch is posted. Must be empty (posted, or never added to) when destroyed.
+class task_batch
+{
+public:
+
+	task_batch () noexcept = default;
+
+	~task_batch () noexcept
+	{
+		pal_require(first_ == nullptr, "task_batch destroyed with unposted tasks");
+	}
+
+	task_batch (const task_batch &) = delete;
+	task_batch &operator= (const task_batch &) = delete;
+
+	/// Bind \a handler to \a t, as \ref event_loop::post does, and append it to the batch
+	template <typename H>
+	void add (task_ptr &&t, H handler) noexcept
+		requires __async::handler<H, void(task_ptr &&) noexcept>
+	{
+		t->bind<__event_loop::op_post>(std::move(handler));
+		auto *raw = t.release();
+		if (last_ != nullptr)
+		{
+			__task::attorney::task_mpsc_queue::link(*last_, *raw);
+		}
+		else
+		{
+			first_ = raw;
+		}
+		last_ = raw;
+		size_++;
+	}
+
+	/// Number of tasks added since the batch was last posted
+	[[nodiscard]] size_t size () const noexcept
+	{
+		return size_;
+	}
+
+	/// Return true if the batch holds no tasks
+	[[nodiscard]] bool empty () const noexcept
+	{
+		return size_ == 0;
+	}
+
+private:
+
+	task *first_ = nullptr, *last_ = nullptr;
+	size_t size_ = 0;
+
+	friend class event_loop;
+};
+
 /// Per-thread completion loop. Not thread-safe and unchecked: drive it (\ref run / \ref run_once /
 /// \ref run_for, \ref now, \ref stats) from a single thread at a time -- pin it to one thread or serialize
-/// externally. \ref post is the sole thread-safe member.
+/// externally. \ref post and \ref post_batch are the sole thread-safe members.
 class event_loop
 {
 public:
@@ -159,14 +441,29 @@ public:
 		__event_loop::post(*impl_, std::move(t));
 	}
 
+	/// Post every task of \a batch (thread-safe), leaving it empty for reuse. Each handler runs as if by
+	/// \ref post, in the order added; the batch lands in the inbox contiguously, with one atomic exchange
+	/// and at most one wake for the lot instead of one each. No-op on an empty batch.
+	void post_batch (task_batch &batch) noexcept
+	{
+		if (batch.first_ != nullptr)
+		{
+			__event_loop::post_chain(*impl_, *batch.first_, *batch.last_);
+			batch.first_ = batch.last_ = nullptr;
+			batch.size_ = 0;
+		}
+	}
+
 	/// Run the completion \a handler for \a t on this loop's thread once \a delay has elapsed, measured from
 	/// \ref now (zero or negative: on the next iteration). Unlike \ref post, not thread-safe -- arm only from
-	/// the loop thread. The delayed post occupies the task's op scratch while armed.
+	/// the loop thread. The delayed post occupies the task's op scratch while armed. On the timer wheel
+	/// (\ref event_loop_config::timer_queue) the handler may run up to one tick late, and timers due within
+	/// the same tick run in no particular order.
 	///
-	/// There is no cancellation: to move the due time, keep the authoritative deadline in app state and, when
-	/// the handler fires early, re-arm for the remainder (lazy re-arm). A task still armed when the loop is
-	/// destroyed is dropped without completing; its storage remains app property, but the task stays bound and
-	/// must not be reused.
+	/// To move the due time, keep the authoritative deadline in app state and, when the handler fires early,
+	/// re-arm for the remainder (lazy re-arm); to drop the timer altogether, \ref cancel_timer. A task still
+	/// armed when the loop is destroyed is dropped without completing; its storage remains app property, but
+	/// the task stays bound and must not be reused.
 	template <typename H>
 	void post_after (task_ptr &&t, clock::duration delay, H handler) noexcept
 		requires __async::handler<H, void(task_ptr &&) noexcept>
@@ -175,14 +472,33 @@ public:
 		__event_loop::start_timer(*impl_, std::move(t), impl_->now_ + delay);
 	}
 
+	/// Disarm \a t, armed by \ref post_after on this loop and not yet expired: its handler never runs and
+	/// the loop lets go of the task, which is the app's to reuse or destroy on return. Loop-thread only.
+	/// Unlinks in O(1) from the timer wheel, in amortized O(log n) from the heap, so a connection torn down
+	/// before its idle timeout no longer keeps its timer armed until expiry. Cancelling a task that is not
+	/// armed (e.g. one whose handler already ran) is a contract violation.
+	void cancel_timer (task &t) noexcept
+	{
+		__event_loop::cancel_timer(*impl_, t);
+	}
+
 	/// Consume the configured synchronous \a resource, returning its async \ref handle bound to this
 	/// loop, with offloaded work routed through \a pool. The handle binds heap-stable internals, so it
 	/// survives moves of both this loop and \a pool; per the teardown contract it must be destroyed
-	/// before either. Resource types with no backend setup step (e.g. resolver) cannot fail.
+	/// before either. Resource types with no backend setup step (e.g. resolver) cannot fail. Resources the
+	/// backend may serve natively (files on io_uring) use \a pool only where it does not.
 	/// Defined in pal/async/handle.hpp.
 	template <typename T>
 	[[nodiscard]] result<handle<T>> make_handle (T resource, thread_pool &pool) noexcept;
 
+	/// Consume \a resource, returning its async \ref handle bound to this loop. For resources served by
+	/// the backend itself (sockets), which offload nothing. Fails if the backend has no support for the
+	/// resource type (\c std::errc::operation_not_supported) or its per-resource setup fails. The same
+	/// teardown contract applies: destroy the handle before this loop.
+	/// Defined in pal/async/handle.hpp.
+	template <typename T>
+	[[nodiscard]] result<handle<T>> make_handle (T resource) noexcept;
+
 private:
 
 	explicit event_loop (__event_loop::impl_ptr impl) noexcept
@@ -191,7 +507,9 @@ private:
 	}
 
 	friend result<event_loop> make_loop (const event_loop_config &) noexcept;
+	friend result<event_loop> make_io_uring_loop (const event_loop_config &) noexcept;
 	friend class thread_pool;
+	friend struct __coroutine::frame;
 
 	__event_loop::impl_ptr impl_;
 };
@@ -200,4 +518,11 @@ private:
 /// backend or a resource limit is hit.
 result<event_loop> make_loop (const event_loop_config &config = {}) noexcept;
 
+/// Create an event loop on the Linux io_uring backend, with its rings sized from \a config. Each
+/// iteration costs at most one io_uring_enter, which both submits queued work and waits; cross-thread
+/// wakes complete a read armed on an eventfd, so no separate drain syscall follows. Errors:
+/// \c std::errc::function_not_supported on other platforms or kernels before 5.11, otherwise whatever
+/// io_uring_setup reports (e.g. resource limits, or io_uring disabled by policy).
+result<event_loop> make_io_uring_loop (const event_loop_config &config = {}) noexcept;
+
 } // namespace pal::async
@@ -0,0 +1,1114 @@
+#include <pal/version.hpp>
+#include <pal/async/event_loop.hpp>
+
+#if __pal_os_linux
+
+#include <pal/async/__io.hpp>
+#include <pal/async/__io_uring.hpp>
+#include <pal/error.hpp>
+#include <pal/net/socket_base.hpp>
+#include <pal/require.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace pal::async
+{
+
+namespace __io_uring
+{
+
+result<void> ring::setup (unsigned sq_depth, unsigned cq_depth) noexcept
+{
+	::io_uring_params params{};
+	params.flags = IORING_SETUP_CLAMP | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG;
+	if (cq_depth > 0)
+	{
+		params.flags |= IORING_SETUP_CQSIZE;
+		params.cq_entries = cq_depth;
+	}
+
+	auto r = ::syscall(__NR_io_uring_setup, sq_depth, &params);
+	if (r == -1 && errno == EINVAL)
+	{
+		// cooperative task running is 5.19+: plain IPI-driven completion on older kernels
+		params.flags &= ~(IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG);
+		r = ::syscall(__NR_io_uring_setup, sq_depth, &params);
+	}
+	if (r == -1)
+	{
+		return unexpected{pal::this_thread::last_system_error()};
+	}
+	fd = static_cast<int>(r);
+	features = params.features;
+
+	constexpr auto required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+	if ((features & required) != required)
+	{
+		return make_unexpected(std::errc::function_not_supported);
+	}
+
+	const size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	const size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+	ring_map_size = (sq_size > cq_size) ? sq_size : cq_size;
+	ring_map = ::mmap(
+		nullptr,
+		ring_map_size,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE,
+		fd,
+		IORING_OFF_SQ_RING
+	);
+	if (ring_map == MAP_FAILED)
+	{
+		ring_map = nullptr;
+		return unexpected{pal::this_thread::last_system_error()};
+	}
+
+	sqe_map_size = params.sq_entries * sizeof(::io_uring_sqe);
+	sqe_map = ::mmap(
+		nullptr,
+		sqe_map_size,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE,
+		fd,
+		IORING_OFF_SQES
+	);
+	if (sqe_map == MAP_FAILED)
+	{
+		sqe_map = nullptr;
+		return unexpected{pal::this_thread::last_system_error()};
+	}
+
+	auto *base = static_cast<std::byte *>(ring_map);
+	sq_head = reinterpret_cast<unsigned *>(base + params.sq_off.head);
+	sq_tail = reinterpret_cast<unsigned *>(base + params.sq_off.tail);
+	sq_flags = reinterpret_cast<unsigned *>(base + params.sq_off.flags);
+	sq_mask = *reinterpret_cast<unsigned *>(base + params.sq_off.ring_mask);
+	sq_entries = *reinterpret_cast<unsigned *>(base + params.sq_off.ring_entries);
+	sqes = static_cast<::io_uring_sqe *>(sqe_map);
+	sqe_tail = *sq_tail;
+
+	auto *array = reinterpret_cast<unsigned *>(base + params.sq_off.array);
+	for (unsigned i = 0; i < sq_entries; ++i)
+	{
+		array[i] = i;
+	}
+
+	cq_head = reinterpret_cast<unsigned *>(base + params.cq_off.head);
+	cq_tail = reinterpret_cast<unsigned *>(base + params.cq_off.tail);
+	cq_mask = *reinterpret_cast<unsigned *>(base + params.cq_off.ring_mask);
+	cqes = reinterpret_cast<::io_uring_cqe *>(base + params.cq_off.cqes);
+
+	return {};
+}
+
+void ring::close () noexcept
+{
+	if (sqe_map != nullptr)
+	{
+		::munmap(sqe_map, sqe_map_size);
+		sqe_map = nullptr;
+	}
+	if (ring_map != nullptr)
+	{
+		::munmap(ring_map, ring_map_size);
+		ring_map = nullptr;
+	}
+	if (fd != -1)
+	{
+		::close(fd);
+		fd = -1;
+	}
+}
+
+int ring::enter (unsigned flags, unsigned min_complete, const ::__kernel_timespec *timeout) noexcept
+{
+	std::atomic_ref{*sq_tail}.store(sqe_tail, std::memory_order_release);
+	const auto to_submit = pending();
+
+	::io_uring_getevents_arg arg{};
+	arg.ts = reinterpret_cast<uintptr_t>(timeout);
+	flags |= IORING_ENTER_EXT_ARG;
+	if (min_complete > 0 || needs_enter())
+	{
+		flags |= IORING_ENTER_GETEVENTS;
+	}
+
+	long r = 0;
+	do
+	{
+		r = ::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, &arg, sizeof(arg));
+	} while (r == -1 && errno == EINTR);
+
+	return (r == -1) ? -errno : static_cast<int>(r);
+}
+
+} // namespace __io_uring
+
+namespace __event_loop
+{
+
+namespace
+{
+
+using __io::acceptor_state;
+using __io::datagram_state;
+using __io::socket_state;
+using __io::stream_state;
+
+struct uring_loop: impl_type
+{
+	__io_uring::ring ring{};
+	int wake = -1;
+	uint64_t wake_counter = 0;
+
+	// Provided-buffer ring shared by every multishot receive on this loop, registered with the first
+	// datagram socket: config_.buffer_count buffers (rounded down to a power of two), each
+	// receive_header bytes plus config_.buffer_size of payload, buffer_stride apart
+	::io_uring_buf_ring *buffer_ring = nullptr;
+	size_t buffer_ring_size = 0;
+	std::byte *buffers = nullptr;
+	size_t buffers_size = 0;
+	size_t buffer_stride = 0;
+	uint16_t buffer_mask = 0;
+	uint16_t buffer_tail = 0;
+
+	// Closed socket states: still referenced by an in-kernel op (freed on its final CQE), or released at
+	// the end of the current poll (a CQE of this batch may still name them). Closed file states with ops
+	// in the kernel count as orphans too (freed on the last op's CQE).
+	size_t orphans = 0;
+	socket_state *graveyard = nullptr;
+
+	// Acceptors with backlog to hand out to their armed accept, drained after each reap
+	acceptor_state *backlogged = nullptr;
+
+	~uring_loop () noexcept
+	{
+		// ring first: its teardown cancels the wake read still armed on the eventfd and drops the
+		// buffer ring registration
+		ring.close();
+		if (wake != -1)
+		{
+			::close(wake);
+		}
+		release_buffers();
+	}
+
+	// Unmap the provided-buffer ring and its buffers: not (or no longer) registered with the ring
+	void release_buffers () noexcept
+	{
+		if (buffers != nullptr)
+		{
+			::munmap(buffers, buffers_size);
+			buffers = nullptr;
+		}
+		if (buffer_ring != nullptr)
+		{
+			::munmap(buffer_ring, buffer_ring_size);
+			buffer_ring = nullptr;
+		}
+	}
+};
+
+constexpr unsigned default_submission_depth = 256;
+
+// The kernel caps a provided-buffer ring at 32k entries (buffer ids are 16 bit)
+constexpr size_t max_buffer_count = 32768;
+constexpr uint16_t buffer_group = 0;
+
+// Multishot recvmsg places io_uring_recvmsg_out and the source address ahead of the payload. The name
+// slot is sized for any address family, so every socket sees the same payload capacity:
+// config_.buffer_size, as on the reactor backends.
+constexpr size_t receive_header = sizeof(::io_uring_recvmsg_out) + sizeof(::sockaddr_storage);
+
+// user_data of the wake channel's read; I/O completions carry non-null io_event pointers
+constexpr uint64_t wake_tag = 0;
+
+// user_data of requests whose completion carries no information (cancels)
+constexpr uint64_t ignore_tag = 1;
+
+uint64_t tag (io_event &ev) noexcept
+{
+	return reinterpret_cast<uintptr_t>(&ev);
+}
+
+void arm_wake_channel (uring_loop &self) noexcept
+{
+	auto *sqe = self.ring.next_sqe();
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = self.wake;
+	sqe->addr = reinterpret_cast<uintptr_t>(&self.wake_counter);
+	sqe->len = sizeof(self.wake_counter);
+	sqe->off = static_cast<uint64_t>(-1);
+	sqe->user_data = wake_tag;
+}
+
+void cancel (uring_loop &self, io_event &ev) noexcept
+{
+	auto *sqe = self.ring.next_sqe();
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = tag(ev);
+	sqe->user_data = ignore_tag;
+}
+
+// Submit what is queued while a closing handle's socket is still open: the handle closes it next, and a
+// request left in the SQ would then run on whichever socket reuses the descriptor
+void submit_queued (uring_loop &self) noexcept
+{
+	if (self.ring.pending() > 0)
+	{
+		std::ignore = self.ring.enter(0, 0, nullptr);
+	}
+}
+
+// SQE length is 32 bit: a larger window transfers partially, as a short send, receive, read or write
+uint32_t transfer_size (const task &t) noexcept
+{
+	return static_cast<uint32_t>(std::min<size_t>(t.span().size(), std::numeric_limits<uint32_t>::max()));
+}
+
+size_t dispatch (uring_loop &self, const ::io_uring_cqe &cqe) noexcept
+{
+	if (cqe.user_data == wake_tag)
+	{
+		self.signaled_.store(false, std::memory_order_release);
+		self.stats_.wakeups++;
+		arm_wake_channel(self);
+		return 0;
+	}
+	if (cqe.user_data == ignore_tag)
+	{
+		return 0;
+	}
+	auto *ev = reinterpret_cast<io_event *>(static_cast<uintptr_t>(cqe.user_data));
+	return ev->fn(*ev, cqe.res, cqe.flags);
+}
+
+size_t reap (uring_loop &self) noexcept
+{
+	size_t n = 0;
+	self.ring.reap([&self, &n] (const ::io_uring_cqe &cqe) noexcept
+	{
+		n += dispatch(self, cqe);
+	});
+	return n;
+}
+
+void release_graveyard (uring_loop &self) noexcept
+{
+	while (auto *s = self.graveyard)
+	{
+		self.graveyard = s->next;
+		s->release(s);
+	}
+}
+
+size_t drain_backlog (uring_loop &self) noexcept;
+
+size_t uring_poll (impl_type &base, impl_type::clock::duration timeout) noexcept
+{
+	auto &self = static_cast<uring_loop &>(base);
+
+	// One io_uring_enter per iteration at most: it submits whatever was queued since the last one
+	// (including the wake channel re-arm) and waits in the same call. Without anything to submit or
+	// wait for, ready completions are reaped straight from the shared ring.
+	if (timeout > impl_type::clock::duration::zero() && !self.ring.cq_ready() && self.backlogged == nullptr)
+	{
+		::__kernel_timespec ts{};
+		const ::__kernel_timespec *tsp = nullptr;
+		if (timeout != impl_type::clock::duration::max())
+		{
+			ts = __io_uring::to_kernel_timespec(timeout);
+			tsp = &ts;
+		}
+		std::ignore = self.ring.enter(0, 1, tsp);
+	}
+	else if (self.ring.pending() > 0 || self.ring.needs_enter())
+	{
+		std::ignore = self.ring.enter(0, 0, nullptr);
+	}
+
+	const auto n = reap(self) + drain_backlog(self);
+	release_graveyard(self);
+	return n;
+}
+
+impl_type::clock::time_point uring_now (impl_type &) noexcept
+{
+	return impl_type::clock::now();
+}
+
+void uring_wake (impl_type &base) noexcept
+{
+	auto &self = static_cast<uring_loop &>(base);
+	if (!self.signaled_.exchange(true, std::memory_order_acq_rel))
+	{
+		const uint64_t one = 1;
+		std::ignore = ::write(self.wake, &one, sizeof(one));
+	}
+}
+
+void uring_destroy (impl_type *base) noexcept
+{
+	auto *self = static_cast<uring_loop *>(base);
+
+	// Handles closed with a receive still in the kernel left their state behind with a cancel queued:
+	// see those cancels through so the states are freed. Bounded, should a kernel never answer.
+	for (int attempt = 0; self->orphans > 0 && attempt < 100; ++attempt)
+	{
+		const auto ts = __io_uring::to_kernel_timespec(std::chrono::milliseconds{10});
+		std::ignore = self->ring.enter(0, 1, &ts);
+		reap(*self);
+	}
+	release_graveyard(*self);
+
+	delete self;
+}
+
+// Provided buffers {{{1
+
+// Ring entry \a i. Not via io_uring_buf_ring::bufs: in C++ the uapi's __DECLARE_FLEX_ARRAY wraps it after
+// an empty struct, which shifts it off the tail-overlaid first entry
+::io_uring_buf &buffer_entry (uring_loop &self, unsigned i) noexcept
+{
+	return reinterpret_cast<::io_uring_buf *>(self.buffer_ring)[i];
+}
+
+result<void> setup_buffer_ring (uring_loop &self) noexcept
+{
+	const auto count = std::bit_floor(std::min(self.config_.buffer_count, max_buffer_count));
+	if (count == 0 || self.config_.buffer_size == 0)
+	{
+		return make_unexpected(std::errc::invalid_argument);
+	}
+
+	self.buffer_ring_size = count * sizeof(::io_uring_buf);
+	auto *ring = ::mmap(nullptr, self.buffer_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ring == MAP_FAILED)
+	{
+		return unexpected{pal::this_thread::last_system_error()};
+	}
+	self.buffer_ring = static_cast<::io_uring_buf_ring *>(ring);
+
+	// stride keeps each buffer's leading io_uring_recvmsg_out aligned
+	constexpr size_t align = alignof(::sockaddr_storage);
+	self.buffer_stride = (receive_header + self.config_.buffer_size + align - 1) / align * align;
+	self.buffers_size = count * self.buffer_stride;
+	auto *buffers = ::mmap(nullptr, self.buffers_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (buffers == MAP_FAILED)
+	{
+		const auto error = pal::this_thread::last_system_error();
+		self.release_buffers();
+		return unexpected{error};
+	}
+	self.buffers = static_cast<std::byte *>(buffers);
+
+	::io_uring_buf_reg reg{};
+	reg.ring_addr = reinterpret_cast<uintptr_t>(self.buffer_ring);
+	reg.ring_entries = static_cast<uint32_t>(count);
+	reg.bgid = buffer_group;
+	if (::syscall(__NR_io_uring_register, self.ring.fd, IORING_REGISTER_PBUF_RING, &reg, 1) == -1)
+	{
+		// provided-buffer rings are 5.19+. Unmapped, so the next datagram_open retries the setup.
+		const auto error = (errno == EINVAL)
+			? std::make_error_code(std::errc::function_not_supported)
+			: pal::this_thread::last_system_error();
+		self.release_buffers();
+		return unexpected{error};
+	}
+
+	self.buffer_mask = static_cast<uint16_t>(count - 1);
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto &buf = buffer_entry(self, static_cast<uint16_t>(i));
+		buf.addr = reinterpret_cast<uintptr_t>(self.buffers + i * self.buffer_stride);
+		buf.len = static_cast<uint32_t>(receive_header + self.config_.buffer_size);
+		buf.bid = static_cast<uint16_t>(i);
+	}
+	self.buffer_tail = static_cast<uint16_t>(count);
+	std::atomic_ref{self.buffer_ring->tail}.store(self.buffer_tail, std::memory_order_release);
+
+	return {};
+}
+
+std::byte *buffer (uring_loop &self, uint16_t bid) noexcept
+{
+	return self.buffers + size_t{bid} * self.buffer_stride;
+}
+
+void recycle_buffer (uring_loop &self, uint16_t bid) noexcept
+{
+	auto &buf = buffer_entry(self, self.buffer_tail & self.buffer_mask);
+	buf.addr = reinterpret_cast<uintptr_t>(buffer(self, bid));
+	buf.len = static_cast<uint32_t>(receive_header + self.config_.buffer_size);
+	buf.bid = bid;
+	std::atomic_ref{self.buffer_ring->tail}.store(++self.buffer_tail, std::memory_order_release);
+}
+
+// Datagram sockets {{{1
+
+void submit_receive (uring_loop &self, datagram_state &s) noexcept
+{
+	auto *sqe = self.ring.next_sqe();
+	sqe->opcode = IORING_OP_RECVMSG;
+	sqe->fd = net::__socket::to_sys(s.handle);
+	sqe->addr = reinterpret_cast<uintptr_t>(static_cast<::msghdr *>(&s.message));
+	sqe->len = 1;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = buffer_group;
+	sqe->user_data = tag(s);
+	s.receive_active = true;
+	s.receive_cancelling = false;
+}
+
+size_t on_receive (io_event &ev, int32_t res, uint32_t flags) noexcept
+{
+	auto &s = static_cast<datagram_state &>(ev);
+	auto &self = static_cast<uring_loop &>(*s.loop);
+	size_t n = 0;
+
+	if ((flags & IORING_CQE_F_BUFFER) != 0)
+	{
+		const auto bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+
+		// buffer layout: io_uring_recvmsg_out, name (msg_namelen bytes reserved), payload
+		if (s.receive.armed() && !s.closed && res >= 0 && static_cast<size_t>(res) >= receive_header)
+		{
+			const auto *data = buffer(self, bid);
+			const auto *out = reinterpret_cast<const ::io_uring_recvmsg_out *>(data);
+			s.name = data + sizeof(::io_uring_recvmsg_out);
+			s.name_size = std::min<size_t>(out->namelen, s.message.msg_namelen);
+			s.data = {data + receive_header, static_cast<size_t>(res) - receive_header};
+			s.truncated = (out->flags & MSG_TRUNC) != 0;
+			s.receive.complete(s, {}, s.data.size());
+			++n;
+		}
+		recycle_buffer(self, bid);
+	}
+
+	if ((flags & IORING_CQE_F_MORE) != 0)
+	{
+		return n;
+	}
+
+	// final CQE of the multishot op: the kernel holds no reference to the state any more
+	s.receive_active = false;
+	s.receive_cancelling = false;
+	if (s.closed)
+	{
+		self.orphans--;
+		s.release(&s);
+	}
+	else if (s.receive.armed())
+	{
+		// cancelled-and-restarted, or provided buffers ran dry (ENOBUFS): resume transparently
+		if (res < 0 && res != -ECANCELED && res != -ENOBUFS)
+		{
+			s.receive.complete(s, std::error_code{-res, std::generic_category()}, 0);
+			++n;
+		}
+		else
+		{
+			submit_receive(self, s);
+		}
+	}
+	return n;
+}
+
+result<void> datagram_open (impl_type &base, datagram_state &s) noexcept
+{
+	auto &self = static_cast<uring_loop &>(base);
+	if (self.buffers == nullptr)
+	{
+		if (auto r = setup_buffer_ring(self); !r)
+		{
+			return r;
+		}
+	}
+
+	s.fn = &on_receive;
+
+	// multishot template: the kernel reads only the name/control sizes, payload goes to provided buffers
+	// after a name slot of the same size for every socket (see receive_header)
+	s.message.name(&s.name_storage, sizeof(s.name_storage));
+	s.message.msg_iov = nullptr;
+	s.message.msg_iovlen = 0;
+	return {};
+}
+
+// Closed state \a s: with its multishot op still \a active, cancel it (unless already) and release \a s on the
+// op's final CQE; otherwise release at the end of this poll
+void close (socket_state *s, bool active, bool cancelling) noexcept
+{
+	auto &self = static_cast<uring_loop &>(*s->loop);
+	if (active)
+	{
+		if (!cancelling)
+		{
+			cancel(self, *s);
+		}
+		self.orphans++;
+	}
+	else
+	{
+		s->next = self.graveyard;
+		self.graveyard = s;
+	}
+}
+
+void datagram_close (datagram_state *s) noexcept
+{
+	close(s, s->receive_active, s->receive_cancelling);
+	submit_queued(static_cast<uring_loop &>(*s->loop));
+}
+
+void start_receive_from (datagram_state &s) noexcept
+{
+	// with the previous op still live (e.g. its cancel pending), its final CQE restarts it
+	if (!s.receive_active)
+	{
+		submit_receive(static_cast<uring_loop &>(*s.loop), s);
+	}
+}
+
+void stop_receive (datagram_state &s) noexcept
+{
+	if (s.receive_active && !s.receive_cancelling)
+	{
+		cancel(static_cast<uring_loop &>(*s.loop), s);
+		s.receive_cancelling = true;
+	}
+}
+
+// Acceptors {{{1
+
+void submit_accept (uring_loop &self, acceptor_state &s) noexcept
+{
+	auto *sqe = self.ring.next_sqe();
+	sqe->opcode = IORING_OP_ACCEPT;
+	sqe->fd = net::__socket::to_sys(s.handle);
+	sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	sqe->user_data = tag(s);
+	s.accept_active = true;
+	s.accept_cancelling = false;
+}
+
+// Schedule \a s's backlog for the next drain_backlog
+void list_backlog (uring_loop &self, acceptor_state &s) noexcept
+{
+	if (!s.backlog_listed)
+	{
+		s.backlog_next = std::exchange(self.backlogged, &s);
+		s.backlog_listed = true;
+	}
+}
+
+// Queue \a accepted behind \a s's backlog; closed only if the backlog cannot grow
+void push_backlog (acceptor_state &s, net::__socket::handle_type accepted) noexcept
+{
+	if (s.backlog_size == s.backlog_capacity)
+	{
+		const auto live = s.backlog_size - s.backlog_head;
+		const auto capacity = std::max(2 * live, size_t{8});
+		std::unique_ptr<net::__socket::handle_type[]> backlog{new (std::nothrow) net::__socket::handle_type[capacity]};
+		if (backlog == nullptr)
+		{
+			net::native_socket::close(accepted);
+			return;
+		}
+		std::copy(s.backlog.get() + s.backlog_head, s.backlog.get() + s.backlog_size, backlog.get());
+		s.backlog = std::move(backlog);
+		s.backlog_head = 0;
+		s.backlog_size = live;
+		s.backlog_capacity = capacity;
+	}
+	s.backlog[s.backlog_size++] = accepted;
+}
+
+// Hand queued connections of listed acceptors to their armed accepts, in arrival order
+size_t drain_backlog (uring_loop &self) noexcept
+{
+	// detached first: handlers may list (start_accept) or unlist (close) acceptors meanwhile. A state
+	// closed by a handler stays valid until the graveyard release that follows.
+	auto *list = std::exchange(self.backlogged, nullptr);
+	size_t n = 0;
+	while (list != nullptr)
+	{
+		auto &s = *list;
+		list = std::exchange(s.backlog_next, nullptr);
+		s.backlog_listed = false;
+
+		while (!s.closed && s.accept.armed() && s.backlog_head != s.backlog_size)
+		{
+			s.accepted = s.backlog[s.backlog_head++];
+			s.accept.complete(s, {}, 0);
+			++n;
+		}
+		if (s.backlog_head == s.backlog_size)
+		{
+			s.backlog_head = s.backlog_size = 0;
+		}
+	}
+	return n;
+}
+
+size_t on_accept (io_event &ev, int32_t res, uint32_t flags) noexcept
+{
+	auto &s = static_cast<acceptor_state &>(ev);
+	auto &self = static_cast<uring_loop &>(*s.loop);
+	size_t n = 0;
+
+	if (res >= 0)
+	{
+		const auto accepted = net::__socket::from_sys(res);
+		if (s.closed)
+		{
+			// accepted by the kernel after close: nobody to hand it to
+			net::native_socket::close(accepted);
+		}
+		else if (s.accept.armed() && s.backlog_head == s.backlog_size)
+		{
+			s.accepted = accepted;
+			s.accept.complete(s, {}, 0);
+			++n;
+		}
+		else
+		{
+			// accepted after stop_accept, or behind earlier ones: keep for the (next) accept, as a
+			// reactor's listen queue would
+			push_backlog(s, accepted);
+			if (s.accept.armed())
+			{
+				list_backlog(self, s);
+			}
+		}
+	}
+
+	if ((flags & IORING_CQE_F_MORE) != 0)
+	{
+		return n;
+	}
+
+	s.accept_active = false;
+	s.accept_cancelling = false;
+	if (s.closed)
+	{
+		self.orphans--;
+		s.release(&s);
+	}
+	else if (s.accept.armed())
+	{
+		if (res < 0 && res != -ECANCELED)
+		{
+			s.accept.complete(s, std::error_code{-res, std::generic_category()}, 0);
+			++n;
+		}
+		else
+		{
+			submit_accept(self, s);
+		}
+	}
+	return n;
+}
+
+result<void> acceptor_open (impl_type &, acceptor_state &s) noexcept
+{
+	s.fn = &on_accept;
+	return {};
+}
+
+void acceptor_close (acceptor_state *s) noexcept
+{
+	// unlist: the state may be released before the next drain_backlog (not if already detached by the
+	// drain in progress, which skips it as closed)
+	auto &self = static_cast<uring_loop &>(*s->loop);
+	if (s->backlog_listed)
+	{
+		for (auto **p = &self.backlogged; *p != nullptr; p = &(*p)->backlog_next)
+		{
+			if (*p == s)
+			{
+				*p = std::exchange(s->backlog_next, nullptr);
+				s->backlog_listed = false;
+				break;
+			}
+		}
+	}
+	close(s, s->accept_active, s->accept_cancelling);
+	submit_queued(self);
+}
+
+void start_accept (acceptor_state &s) noexcept
+{
+	auto &self = static_cast<uring_loop &>(*s.loop);
+	if (s.backlog_head != s.backlog_size)
+	{
+		list_backlog(self, s);
+	}
+	if (!s.accept_active)
+	{
+		submit_accept(self, s);
+	}
+}
+
+void stop_accept (acceptor_state &s) noexcept
+{
+	if (s.accept_active && !s.accept_cancelling)
+	{
+		cancel(static_cast<uring_loop &>(*s.loop), s);
+		s.accept_cancelling = true;
+	}
+}
+
+// Stream sockets {{{1
+//
+// One single-shot op per direction, each completing through its own stream_op. A closed state waits for
+// the final CQE of every op still in the kernel.
+
+size_t on_stream_op (io_event &ev, int32_t res, uint32_t) noexcept
+{
+	auto &op = static_cast<__io::stream_op &>(ev);
+	auto &s = *op.state;
+	auto &self = static_cast<uring_loop &>(*s.loop);
+
+	// settle before complete(): the handler may start the next op in this direction, or close
+	op.active = false;
+	const bool closed = s.closed;
+	size_t n = 0;
+	if (auto *t = std::exchange(op.pending, nullptr))
+	{
+		if (res < 0)
+		{
+			// unify with the synchronous send: broken pipe is a lost connection
+			t->complete(std::error_code{res == -EPIPE ? ENOTCONN : -res, std::generic_category()}, 0);
+		}
+		else
+		{
+			t->complete({}, static_cast<size_t>(res));
+		}
+		++n;
+	}
+
+	if (closed && !s.read.active && !s.write.active)
+	{
+		self.orphans--;
+		s.release(&s);
+	}
+	return n;
+}
+
+::io_uring_sqe *submit (stream_state &s, __io::stream_op &op, task &t, uint8_t opcode) noexcept
+{
+	pal_require(op.pending == nullptr, "stream operation already pending in this direction");
+	op.pending = &t;
+	op.active = true;
+	op.fn = &on_stream_op;
+
+	auto *sqe = static_cast<uring_loop &>(*s.loop).ring.next_sqe();
+	sqe->opcode = opcode;
+	sqe->fd = net::__socket::to_sys(s.handle);
+	sqe->user_data = tag(op);
+	return sqe;
+}
+
+// Zero-copy send: the result CQE (with F_MORE if a notification follows), then the notification CQE once
+// the kernel lets go of the payload
+size_t on_send_zerocopy (io_event &ev, int32_t res, uint32_t flags) noexcept
+{
+	auto &op = static_cast<__io::stream_op &>(ev);
+	auto &s = *op.state;
+	auto &self = static_cast<uring_loop &>(*s.loop);
+
+	size_t n = 0;
+	if ((flags & IORING_CQE_F_NOTIF) == 0)
+	{
+		if (res < 0)
+		{
+			__io::complete_sent(s, std::error_code{res == -EPIPE ? ENOTCONN : -res, std::generic_category()}, 0);
+		}
+		else
+		{
+			__io::complete_sent(s, {}, static_cast<size_t>(res));
+		}
+		++n;
+
+		if ((flags & IORING_CQE_F_MORE) != 0)
+		{
+			return n;
+		}
+	}
+
+	op.active = false;
+	const bool closed = s.closed;
+	__io::complete_released(s);
+	++n;
+
+	if (closed && !s.read.active)
+	{
+		self.orphans--;
+		s.release(&s);
+	}
+	return n;
+}
+
+result<void> stream_open (impl_type &, stream_state &s) noexcept
+{
+	s.read.fn = s.write.fn = &on_stream_op;
+	s.read.state = s.write.state = &s;
+	return {};
+}
+
+void stream_close (stream_state *s) noexcept
+{
+	auto &self = static_cast<uring_loop &>(*s->loop);
+	if (s->read.active || s->write.active)
+	{
+		// pending ops complete (cancelled, or with whatever they did meanwhile) on their final CQEs
+		for (auto *op: {&s->read, &s->write})
+		{
+			if (op->active)
+			{
+				cancel(self, *op);
+			}
+		}
+		self.orphans++;
+	}
+	else
+	{
+		s->next = self.graveyard;
+		self.graveyard = s;
+	}
+	submit_queued(self);
+}
+
+void start_connect (stream_state &s, task &t, const void *endpoint, size_t endpoint_size) noexcept
+{
+	auto *sqe = submit(s, s.write, t, IORING_OP_CONNECT);
+	sqe->addr = reinterpret_cast<uintptr_t>(endpoint);
+	sqe->off = endpoint_size;
+}
+
+// Header of a chained payload's SENDMSG/RECVMSG, in the task's op scratch (stable while in the kernel)
+::msghdr &chain_message (task &t, std::span<net::__socket::io_vector> vectors) noexcept
+{
+	auto &message = t.scratch_as<::msghdr>();
+	message = {};
+	message.msg_iov = vectors.data();
+	message.msg_iovlen = vectors.size();
+	return message;
+}
+
+void start_send (stream_state &s, task &t) noexcept
+{
+	if (t.next_segment() != nullptr)
+	{
+		if (const auto vectors = __io::gather(s.write, t); vectors.size() > 1)
+		{
+			auto *sqe = submit(s, s.write, t, IORING_OP_SENDMSG);
+			sqe->addr = reinterpret_cast<uintptr_t>(&chain_message(t, vectors));
+			sqe->len = 1;
+			sqe->msg_flags = MSG_NOSIGNAL;
+			return;
+		}
+	}
+
+	auto *sqe = submit(s, s.write, t, IORING_OP_SEND);
+	sqe->addr = reinterpret_cast<uintptr_t>(t.span().data());
+	sqe->len = transfer_size(t);
+	sqe->msg_flags = MSG_NOSIGNAL;
+}
+
+void start_send_zerocopy (stream_state &s, task &t) noexcept
+{
+	auto *sqe = submit(s, s.write, t, IORING_OP_SEND_ZC);
+	sqe->addr = reinterpret_cast<uintptr_t>(t.span().data());
+	sqe->len = transfer_size(t);
+	sqe->msg_flags = MSG_NOSIGNAL;
+	s.write.fn = &on_send_zerocopy;
+	s.zerocopy = true;
+}
+
+void start_receive (stream_state &s, task &t) noexcept
+{
+	if (t.next_segment() != nullptr)
+	{
+		if (const auto vectors = __io::gather(s.read, t); vectors.size() > 1)
+		{
+			auto *sqe = submit(s, s.read, t, IORING_OP_RECVMSG);
+			sqe->addr = reinterpret_cast<uintptr_t>(&chain_message(t, vectors));
+			sqe->len = 1;
+			return;
+		}
+	}
+
+	auto *sqe = submit(s, s.read, t, IORING_OP_RECV);
+	sqe->addr = reinterpret_cast<uintptr_t>(t.span().data());
+	sqe->len = transfer_size(t);
+}
+
+// Files {{{1
+//
+// Any number of single-shot ops per file, each completing through the file_op in its task's scratch. A
+// closed state waits for the completion of the last op still in the kernel.
+
+size_t on_file_op (io_event &ev, int32_t res, uint32_t) noexcept
+{
+	auto &op = static_cast<__io::file_op &>(ev);
+	auto *s = op.state;
+	auto *t = op.pending;
+
+	// settle before complete(): the handler may reuse the scratch holding op, or destroy the handle
+	const bool release = --s->in_flight == 0 && s->closed;
+	if (res < 0)
+	{
+		t->complete(std::error_code{-res, std::generic_category()}, 0);
+	}
+	else
+	{
+		t->complete({}, static_cast<size_t>(res));
+	}
+
+	if (release)
+	{
+		static_cast<uring_loop &>(*s->loop).orphans--;
+		delete s;
+	}
+	return 1;
+}
+
+::io_uring_sqe *submit (__io::file_op &op, uint8_t opcode) noexcept
+{
+	op.fn = &on_file_op;
+
+	auto *sqe = static_cast<uring_loop &>(*op.state->loop).ring.next_sqe();
+	sqe->opcode = opcode;
+	sqe->fd = static_cast<int>(op.state->resource.native_handle());
+	sqe->user_data = tag(op);
+	return sqe;
+}
+
+void start_read_at (__io::file_op &op, uint64_t offset) noexcept
+{
+	auto *sqe = submit(op, IORING_OP_READ);
+	sqe->addr = reinterpret_cast<uintptr_t>(op.pending->span().data());
+	sqe->len = transfer_size(*op.pending);
+	sqe->off = offset;
+}
+
+void start_write_at (__io::file_op &op, uint64_t offset) noexcept
+{
+	auto *sqe = submit(op, IORING_OP_WRITE);
+	sqe->addr = reinterpret_cast<uintptr_t>(op.pending->span().data());
+	sqe->len = transfer_size(*op.pending);
+	sqe->off = offset;
+}
+
+void start_fsync (__io::file_op &op) noexcept
+{
+	std::ignore = submit(op, IORING_OP_FSYNC);
+}
+
+void file_close (__io::file_state *s) noexcept
+{
+	static_cast<uring_loop &>(*s->loop).orphans++;
+}
+
+constexpr __io::ops io_ops = {
+	.datagram_open = &datagram_open,
+	.datagram_close = &datagram_close,
+	.start_receive_from = &start_receive_from,
+	.stop_receive = &stop_receive,
+	.acceptor_open = &acceptor_open,
+	.acceptor_close = &acceptor_close,
+	.start_accept = &start_accept,
+	.stop_accept = &stop_accept,
+	.stream_open = &stream_open,
+	.stream_close = &stream_close,
+	.start_connect = &start_connect,
+	.start_send = &start_send,
+	.start_send_zerocopy = &start_send_zerocopy,
+	.start_receive = &start_receive,
+	.start_read_at = &start_read_at,
+	.start_write_at = &start_write_at,
+	.start_fsync = &start_fsync,
+	.file_close = &file_close,
+};
+
+// }}}1
+
+} // namespace
+
+} // namespace __event_loop
+
+result<event_loop> make_io_uring_loop (const event_loop_config &config) noexcept
+{
+	using namespace __event_loop;
+
+	// io_uring_setup takes 32-bit entry counts: larger depths would wrap into small or empty rings
+	constexpr size_t max_depth = std::numeric_limits<unsigned>::max();
+	if (config.submission_depth > max_depth || config.completion_depth > max_depth)
+	{
+		return make_unexpected(std::errc::invalid_argument);
+	}
+
+	auto *self = new (std::nothrow) uring_loop{};
+	if (self == nullptr)
+	{
+		return make_unexpected(std::errc::not_enough_memory);
+	}
+
+	self->poll_fn = &uring_poll;
+	self->wake_fn = &uring_wake;
+	self->now_fn = &uring_now;
+	self->destroy_fn = &uring_destroy;
+	self->io_ = &io_ops;
+	self->config_ = config;
+	impl_ptr impl{self};
+
+	const auto sq_depth = (config.submission_depth > 0) ? config.submission_depth : default_submission_depth;
+	if (auto r = self->ring.setup(static_cast<unsigned>(sq_depth), static_cast<unsigned>(config.completion_depth)); !r)
+	{
+		return unexpected{r.error()};
+	}
+
+	// blocking eventfd: a read on a non-blocking one completes with -EAGAIN instead of waiting in-kernel
+	self->wake = ::eventfd(0, EFD_CLOEXEC);
+	if (self->wake == -1)
+	{
+		return unexpected{pal::this_thread::last_system_error()};
+	}
+	arm_wake_channel(*self);
+
+	init_clock(*self);
+	return event_loop{std::move(impl)};
+}
+
+} // namespace pal::async
+
+
+#else
+
+namespace pal::async
+{
+
+result<event_loop> make_io_uring_loop (const event_loop_config &) noexcept
+{
+	return make_unexpected(std::errc::function_not_supported);
+}
+
+} // namespace pal::async
+
+#endif // __pal_os_linux
@@ -5,7 +5,6 @@
 #include <pal/async/event_loop.hpp>
 #include <pal/error.hpp>
 
-#include <atomic>
 #include <chrono>
 #include <new>
 #include <windows.h>
@@ -22,7 +21,6 @@ namespace
 struct iocp_loop: impl_type
 {
 	::HANDLE port = nullptr;
-	std::atomic<bool> signaled = false;
 
 	~iocp_loop () noexcept
 	{
@@ -56,7 +54,7 @@ size_t iocp_poll (impl_type &base, impl_type::clock::duration timeout) noexcept
 	{
 		if (entry.lpCompletionKey == wake_key)
 		{
-			self.signaled.store(false, std::memory_order_release);
+			self.signaled_.store(false, std::memory_order_release);
 			self.stats_.wakeups++;
 		}
 	}
@@ -72,7 +70,7 @@ impl_type::clock::time_point iocp_now (impl_type &) noexcept
 void iocp_wake (impl_type &base) noexcept
 {
 	auto &self = static_cast<iocp_loop &>(base);
-	if (!self.signaled.exchange(true, std::memory_order_acq_rel))
+	if (!self.signaled_.exchange(true, std::memory_order_acq_rel))
 	{
 		std::ignore = ::PostQueuedCompletionStatus(self.port, 0, wake_key, nullptr);
 	}
@@ -110,7 +108,7 @@ result<event_loop> make_loop (const event_loop_config &config) noexcept
 	self->now_fn = &iocp_now;
 	self->destroy_fn = &iocp_destroy;
 	self->config_ = config;
-	self->now_ = iocp_now(*self);
+	init_clock(*self);
 
 	return event_loop{impl_ptr{self}};
 }
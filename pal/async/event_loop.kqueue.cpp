@@ -5,7 +5,6 @@
 #include <pal/async/event_loop.hpp>
 #include <pal/error.hpp>
 
-#include <atomic>
 #include <cerrno>
 #include <chrono>
 #include <fcntl.h>
@@ -25,7 +24,6 @@ namespace
 struct kqueue_loop: impl_type
 {
 	int kq = -1;
-	std::atomic<bool> signaled = false;
 
 	~kqueue_loop () noexcept
 	{
@@ -67,7 +65,7 @@ size_t kqueue_poll (impl_type &base, impl_type::clock::duration timeout) noexcep
 
 	if (r > 0)
 	{
-		self.signaled.store(false, std::memory_order_release);
+		self.signaled_.store(false, std::memory_order_release);
 		self.stats_.wakeups++;
 	}
 
@@ -82,7 +80,7 @@ impl_type::clock::time_point kqueue_now (impl_type &) noexcept
 void kqueue_wake (impl_type &base) noexcept
 {
 	auto &self = static_cast<kqueue_loop &>(base);
-	if (!self.signaled.exchange(true, std::memory_order_acq_rel))
+	if (!self.signaled_.exchange(true, std::memory_order_acq_rel))
 	{
 		struct ::kevent trigger{};
 		EV_SET(&trigger, wake_ident, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
@@ -132,7 +130,7 @@ result<event_loop> make_loop (const event_loop_config &config) noexcept
 	self->now_fn = &kqueue_now;
 	self->destroy_fn = &kqueue_destroy;
 	self->config_ = config;
-	self->now_ = kqueue_now(*self);
+	init_clock(*self);
 
 	return event_loop{impl_ptr{self}};
 }
@@ -0,0 +1,195 @@
+#include <pal/async/event_loop_group.hpp>
+#include <pal/error.hpp>
+#include <algorithm>
+#include <array>
+#include <new>
+
+#if __pal_os_linux
+	#include <linux/filter.h>
+	#include <pthread.h>
+	#include <sched.h>
+	#include <sys/socket.h>
+#elif __pal_os_windows
+	#include <windows.h>
+#endif
+
+namespace pal::async
+{
+
+namespace __event_loop_group
+{
+
+namespace
+{
+
+// CPUs the process may run on, in ascending order
+std::vector<int> allowed_cpus ()
+{
+	std::vector<int> cpus;
+
+#if __pal_os_linux
+	::cpu_set_t set;
+	CPU_ZERO(&set);
+	if (::sched_getaffinity(0, sizeof(set), &set) == 0)
+	{
+		for (int cpu = 0; cpu != CPU_SETSIZE; ++cpu)
+		{
+			if (CPU_ISSET(cpu, &set))
+			{
+				cpus.push_back(cpu);
+			}
+		}
+	}
+#elif __pal_os_windows
+	DWORD_PTR process_mask, system_mask;
+	if (::GetProcessAffinityMask(::GetCurrentProcess(), &process_mask, &system_mask))
+	{
+		for (int cpu = 0; cpu != sizeof(process_mask) * 8; ++cpu)
+		{
+			if (process_mask & (DWORD_PTR{1} << cpu))
+			{
+				cpus.push_back(cpu);
+			}
+		}
+	}
+#endif
+
+	if (cpus.empty())
+	{
+		for (int cpu = 0; cpu != static_cast<int>((std::max)(std::thread::hardware_concurrency(), 1u)); ++cpu)
+		{
+			cpus.push_back(cpu);
+		}
+	}
+	return cpus;
+}
+
+// Stop wakes carry no work: the stop token tells the loop's function to return
+void on_wake (task_ptr &&) noexcept
+{
+}
+
+} // namespace
+
+impl_type::~impl_type () noexcept
+{
+	request_stop();
+	join();
+}
+
+void impl_type::request_stop () noexcept
+{
+	if (threads.empty() || stopping.exchange(true, std::memory_order_acq_rel))
+	{
+		return;
+	}
+
+	// stop first: a function woken by the post then sees its stop request; wakes nobody ran, join() drains
+	for (auto &thread: threads)
+	{
+		thread.request_stop();
+	}
+	for (size_t i = 0; i != threads.size(); ++i)
+	{
+		loops[i].post(wake[i].borrow(), &on_wake);
+	}
+}
+
+void impl_type::join () noexcept
+{
+	for (auto &thread: threads)
+	{
+		if (thread.joinable())
+		{
+			thread.join();
+		}
+	}
+
+	// the threads are gone: drain the stop wakes they left behind here
+	for (auto &loop: loops)
+	{
+		std::ignore = loop.run_once();
+	}
+}
+
+void pin (int cpu) noexcept
+{
+	if (cpu < 0)
+	{
+		return;
+	}
+
+#if __pal_os_linux
+	::cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	std::ignore = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+#elif __pal_os_windows
+	std::ignore = ::SetThreadAffinityMask(::GetCurrentThread(), DWORD_PTR{1} << cpu);
+#endif
+}
+
+result<void> attach_cpu_steering (net::__socket::handle_type handle, size_t size) noexcept
+{
+#if __pal_os_linux
+	// socket index = receiving CPU % size
+	std::array<::sock_filter, 3> code = {{
+		{BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},
+		{BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(size)},
+		{BPF_RET | BPF_A, 0, 0, 0},
+	}};
+	const ::sock_fprog program{.len = static_cast<unsigned short>(code.size()), .filter = code.data()};
+	if (::setsockopt(net::__socket::to_sys(handle), SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) == 0)
+	{
+		return {};
+	}
+	return unexpected{pal::this_thread::last_system_error()};
+#else
+	(void)handle;
+	(void)size;
+	return make_unexpected(std::errc::operation_not_supported);
+#endif
+}
+
+} // namespace __event_loop_group
+
+result<event_loop_group> make_event_loop_group (const event_loop_group_config &config) noexcept
+{
+	using namespace __event_loop_group;
+
+	auto *impl = new (std::nothrow) impl_type{};
+	if (impl == nullptr)
+	{
+		return make_unexpected(std::errc::not_enough_memory);
+	}
+	event_loop_group group{impl};
+
+	try
+	{
+		const auto cpus = allowed_cpus();
+		const auto size = config.size > 0 ? config.size : cpus.size();
+		const bool pin = config.pin_threads && pal::os != pal::os_type::macos;
+
+		impl->wake.reset(new task[size]);
+		impl->loops.reserve(size);
+		impl->cpus.reserve(size);
+		for (size_t i = 0; i != size; ++i)
+		{
+			auto loop = make_loop(config.loop);
+			if (!loop)
+			{
+				return unexpected{loop.error()};
+			}
+			impl->loops.push_back(std::move(*loop));
+			impl->cpus.push_back(pin ? cpus[i % cpus.size()] : -1);
+		}
+	}
+	catch (...)
+	{
+		return make_unexpected(std::errc::not_enough_memory);
+	}
+
+	return group;
+}
+
+} // namespace pal::async
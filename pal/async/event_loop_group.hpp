@@ -0,0 +1,273 @@
+#pragma once
+
+/**
+ * \file pal/async/event_loop_group.hpp
+ * Sharded event loops: one loop per core, each on its own pinned thread
+ */
+
+#include <pal/async/event_loop.hpp>
+#include <pal/net/basic_datagram_socket.hpp>
+#include <pal/net/basic_socket_acceptor.hpp>
+#include <pal/net/socket_option.hpp>
+#include <pal/require.hpp>
+#include <pal/result.hpp>
+#include <atomic>
+#include <concepts>
+#include <memory>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pal::async
+{
+
+/// Sizing and placement of an \ref event_loop_group.
+struct event_loop_group_config
+{
+	/// Loops (and threads) in the group; 0 selects one per CPU the process may run on.
+	size_t size = 0;
+
+	/// Pin loop \c i's thread to the \c i-th CPU the process may run on (wrapping around when there are
+	/// more loops than CPUs). Ignored on platforms without thread affinity (macOS).
+	bool pin_threads = true;
+
+	/// Per-loop backend sizing
+	event_loop_config loop{};
+};
+
+/// How a reuse-port socket group spreads flows across its sockets (see \ref make_reuse_port_acceptors).
+enum class reuse_port_steering
+{
+	/// Kernel default: by flow hash.
+	flow_hash,
+
+	/// By the CPU that received the packet (SO_ATTACH_REUSEPORT_CBPF, Linux-only): CPU \c c goes to
+	/// socket <tt>c % size</tt>. Keeps a flow on the core whose NIC queue took it if loop \c i runs on CPU
+	/// \c i -- pinned, with CPUs 0..size-1 available -- and NIC queue interrupts are steered to match.
+	cpu,
+};
+
+class event_loop_group;
+
+/// Create a group of \a config.size event loops (see \ref event_loop_group). Threads start with
+/// \ref event_loop_group::start. Errors: as \ref make_loop, or memory exhaustion.
+result<event_loop_group> make_event_loop_group (const event_loop_group_config &config = {}) noexcept;
+
+namespace __event_loop_group
+{
+
+struct impl_type
+{
+	std::vector<event_loop> loops{};
+	std::vector<int> cpus{};
+	std::unique_ptr<task[]> wake{};
+	std::vector<std::jthread> threads{};
+	std::atomic<bool> stopping = false;
+
+	~impl_type () noexcept;
+
+	void request_stop () noexcept;
+	void join () noexcept;
+};
+
+/// Pin the calling thread to \a cpu; no-op if negative.
+void pin (int cpu) noexcept;
+
+/// Attach CPU steering to the reuse-port group of \a handle (see \ref reuse_port_steering::cpu).
+result<void> attach_cpu_steering (net::__socket::handle_type handle, size_t size) noexcept;
+
+// Open \a size sockets via \a open (returning result<Socket>), each with reuse_port set and bound to
+// \a endpoint, in order: a reuse-port group indexes its sockets by join order, which CPU steering relies
+// on. An ephemeral \a endpoint port is resolved by the first socket.
+template <typename Socket, typename Endpoint, typename Open, typename Join>
+result<std::vector<Socket>> make_reuse_port_sockets (
+	size_t size,
+	Endpoint endpoint,
+	reuse_port_steering steering,
+	Open open,
+	Join join) noexcept
+{
+	std::vector<Socket> sockets;
+	try
+	{
+		sockets.reserve(size);
+	}
+	catch (...)
+	{
+		return make_unexpected(std::errc::not_enough_memory);
+	}
+
+	while (sockets.size() < size)
+	{
+		auto socket = open();
+		if (!socket)
+		{
+			return unexpected{socket.error()};
+		}
+
+		auto r = socket->set_option(net::reuse_port{true})
+			.and_then([&] { return socket->bind(endpoint); })
+			.and_then([&] { return join(*socket); })
+			.and_then([&] { return socket->local_endpoint(); });
+		if (!r)
+		{
+			return unexpected{r.error()};
+		}
+		endpoint = *r;
+
+		sockets.push_back(std::move(*socket));
+	}
+
+	if (steering == reuse_port_steering::cpu && !sockets.empty())
+	{
+		if (auto r = attach_cpu_steering(sockets.front().native_socket().handle(), size); !r)
+		{
+			return unexpected{r.error()};
+		}
+	}
+
+	return sockets;
+}
+
+} // namespace __event_loop_group
+
+/// Shards work across cores, one \ref event_loop each: \ref start runs an application function per loop on
+/// its own thread, pinned to its own CPU. Loops share nothing; spread load across them by giving each its
+/// own reuse-port socket (\ref make_reuse_port_acceptors, \ref make_reuse_port_datagram_sockets) so the
+/// kernel picks the loop per flow.
+///
+/// Each loop follows the usual single-thread contract: before \ref start, only the thread that made the
+/// group touches them (e.g. to make handles); once started, only its own thread does.
+///
+/// Destruction requests stop and joins the threads; per the teardown contract every handle must be gone
+/// by then, i.e. the per-loop functions destroy theirs before returning.
+class event_loop_group
+{
+public:
+
+	event_loop_group (event_loop_group &&) noexcept = default;
+	event_loop_group &operator= (event_loop_group &&) noexcept = default;
+	~event_loop_group () noexcept = default;
+
+	/// Number of loops
+	[[nodiscard]] size_t size () const noexcept
+	{
+		return impl_->loops.size();
+	}
+
+	/// Loop \a index (see class contract for who may drive it)
+	[[nodiscard]] event_loop &loop (size_t index) noexcept
+	{
+		return impl_->loops[index];
+	}
+
+	/// CPU loop \a index's thread is pinned to, or -1 if unpinned
+	[[nodiscard]] int cpu (size_t index) const noexcept
+	{
+		return impl_->cpus[index];
+	}
+
+	/// Start one thread per loop, running <tt>fn(loop, index, stop)</tt> on it (pinned, see
+	/// \ref event_loop_group_config::pin_threads). Each gets its own copy of \a fn. Typically \a fn makes
+	/// its handles, then drives \a loop with \ref event_loop::run_for until \a stop is requested, which
+	/// also wakes \a loop. Call once. Errors: thread resource exhaustion -- threads already started are
+	/// stopped and joined first.
+	template <typename F>
+	result<void> start (F fn) noexcept
+		requires std::invocable<F &, event_loop &, size_t, std::stop_token>
+	{
+		pal_require(impl_->threads.empty(), "event_loop_group started twice");
+		try
+		{
+			impl_->threads.reserve(size());
+			for (size_t i = 0; i != size(); ++i)
+			{
+				impl_->threads.emplace_back([impl = impl_.get(), i, fn] (std::stop_token stop) mutable
+				{
+					__event_loop_group::pin(impl->cpus[i]);
+					fn(impl->loops[i], i, std::move(stop));
+				});
+			}
+		}
+		catch (const std::system_error &e)
+		{
+			impl_->request_stop();
+			impl_->join();
+			return unexpected{e.code()};
+		}
+		catch (...)
+		{
+			impl_->request_stop();
+			impl_->join();
+			return make_unexpected(std::errc::not_enough_memory);
+		}
+		return {};
+	}
+
+	/// Ask every loop's function to return: requests its stop token and wakes its loop. Thread-safe,
+	/// idempotent.
+	void request_stop () noexcept
+	{
+		impl_->request_stop();
+	}
+
+	/// \ref request_stop and wait for every loop's function to return.
+	void stop () noexcept
+	{
+		impl_->request_stop();
+		impl_->join();
+	}
+
+private:
+
+	std::unique_ptr<__event_loop_group::impl_type> impl_;
+
+	explicit event_loop_group (__event_loop_group::impl_type *impl) noexcept
+		: impl_{impl}
+	{
+	}
+
+	friend result<event_loop_group> make_event_loop_group (const event_loop_group_config &) noexcept;
+};
+
+/// Open one listening acceptor per loop of \a group, all bound to \a endpoint with reuse_port, so the
+/// kernel spreads incoming connections across them per \a steering. Acceptor \c i belongs to loop \c i
+/// (make its handle there). An ephemeral \a endpoint port is resolved by the first acceptor.
+template <typename Protocol>
+[[nodiscard]] result<std::vector<net::basic_socket_acceptor<Protocol>>> make_reuse_port_acceptors (
+	const event_loop_group &group,
+	const Protocol &protocol,
+	const typename Protocol::endpoint &endpoint,
+	reuse_port_steering steering = reuse_port_steering::flow_hash) noexcept
+{
+	return __event_loop_group::make_reuse_port_sockets<net::basic_socket_acceptor<Protocol>>(
+		group.size(),
+		endpoint,
+		steering,
+		[&protocol] { return net::make_socket_acceptor(protocol); },
+		[] (auto &acceptor) { return acceptor.listen(); }
+	);
+}
+
+/// Open one datagram socket per loop of \a group, all bound to \a endpoint with reuse_port, so the kernel
+/// spreads incoming flows across them per \a steering. Socket \c i belongs to loop \c i (make its handle
+/// there). An ephemeral \a endpoint port is resolved by the first socket.
+template <typename Protocol>
+[[nodiscard]] result<std::vector<net::basic_datagram_socket<Protocol>>> make_reuse_port_datagram_sockets (
+	const event_loop_group &group,
+	const Protocol &protocol,
+	const typename Protocol::endpoint &endpoint,
+	reuse_port_steering steering = reuse_port_steering::flow_hash) noexcept
+{
+	return __event_loop_group::make_reuse_port_sockets<net::basic_datagram_socket<Protocol>>(
+		group.size(),
+		endpoint,
+		steering,
+		[&protocol] { return net::make_datagram_socket(protocol); },
+		[] (auto &) { return result<void>{}; }
+	);
+}
+
+} // namespace pal::async
@@ -0,0 +1,194 @@
+#include <pal/async/event_loop_group.hpp>
+#include <pal/async/datagram_socket.hpp>
+#include <pal/async/socket_acceptor.hpp>
+#include <pal/net/test.hpp>
+#include <pal/test.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <chrono>
+#include <string_view>
+#include <thread>
+
+namespace
+{
+
+using namespace pal::async;
+using namespace std::chrono_literals;
+
+using tcp = pal::net::ip::tcp;
+using udp = pal::net::ip::udp;
+
+// Wait for \a done, with a generous deadline
+template <typename Predicate>
+bool wait_until (Predicate done)
+{
+	for (auto i = 0; i < 500 && !done(); ++i)
+	{
+		std::this_thread::sleep_for(10ms);
+	}
+	return done();
+}
+
+TEST_CASE("async/event_loop_group")
+{
+	auto group = make_event_loop_group({.size = 2});
+	REQUIRE(group);
+	CHECK(group->size() == 2);
+	CHECK(group->cpu(0) >= (pal::os == pal::os_type::macos ? -1 : 0));
+
+	SECTION("default size")
+	{
+		auto g = make_event_loop_group({.pin_threads = false});
+		REQUIRE(g);
+		CHECK(g->size() >= 1);
+		CHECK(g->cpu(0) == -1);
+	}
+
+	SECTION("start / stop")
+	{
+		std::atomic<int> started = 0, stopped = 0;
+
+		// clang-format off
+		REQUIRE(group->start([&] (event_loop &loop, size_t, std::stop_token stop)
+		{
+			++started;
+			while (!stop.stop_requested())
+			{
+				std::ignore = loop.run_for(1s);
+			}
+			++stopped;
+		}));
+		// clang-format on
+
+		CHECK(wait_until([&] { return started == 2; }));
+
+		// woken: returns well before the 1s poll timeout
+		const auto t0 = std::chrono::steady_clock::now();
+		group->stop();
+		CHECK(std::chrono::steady_clock::now() - t0 < 900ms);
+		CHECK(stopped == 2);
+
+		// idempotent
+		group->stop();
+	}
+
+	SECTION("stop: not started")
+	{
+		group->stop();
+	}
+
+	SECTION("reuse-port datagram sockets")
+	{
+		auto sockets = make_reuse_port_datagram_sockets(*group, udp::v4, pal_test::udp_v4::loopback_endpoint());
+		if (!sockets && sockets.error() == std::errc::operation_not_supported)
+		{
+			SKIP("no reuse_port");
+		}
+		REQUIRE(sockets);
+		REQUIRE(sockets->size() == 2);
+		const auto endpoint = (*sockets)[0].local_endpoint().value();
+		CHECK((*sockets)[1].local_endpoint().value() == endpoint);
+
+		std::atomic<int> received = 0;
+
+		// clang-format off
+		REQUIRE(group->start([&] (event_loop &loop, size_t index, std::stop_token stop)
+		{
+			auto h = loop.make_handle(std::move((*sockets)[index]));
+			if (!h)
+			{
+				return;
+			}
+			h->start_receive_from([&] (pal::result<handle<pal::net::basic_datagram_socket<udp>>::datagram> &&d) noexcept
+			{
+				received += d.has_value();
+			});
+			while (!stop.stop_requested())
+			{
+				std::ignore = loop.run_for(100ms);
+			}
+		}));
+		// clang-format on
+
+		// different source ports: spread over the group by flow hash
+		constexpr int senders = 8;
+		constexpr std::string_view payload = "x";
+		for (auto i = 0; i < senders; ++i)
+		{
+			auto sender = pal::net::make_datagram_socket(udp::v4, pal_test::udp_v4::loopback_endpoint());
+			REQUIRE(sender);
+			REQUIRE(sender->send_to(endpoint, payload));
+		}
+		CHECK(wait_until([&] { return received == senders; }));
+		group->stop();
+		CHECK(received == senders);
+	}
+
+	SECTION("reuse-port acceptors")
+	{
+		auto acceptors = make_reuse_port_acceptors(*group, tcp::v4, pal_test::tcp_v4::loopback_endpoint());
+		if (!acceptors && acceptors.error() == std::errc::operation_not_supported)
+		{
+			SKIP("no reuse_port");
+		}
+		REQUIRE(acceptors);
+		REQUIRE(acceptors->size() == 2);
+		const auto endpoint = (*acceptors)[0].local_endpoint().value();
+
+		std::atomic<int> accepted = 0;
+
+		// clang-format off
+		REQUIRE(group->start([&] (event_loop &loop, size_t index, std::stop_token stop)
+		{
+			auto h = loop.make_handle(std::move((*acceptors)[index]));
+			if (!h)
+			{
+				return;
+			}
+			h->start_accept([&] (pal::result<tcp::socket> &&s) noexcept
+			{
+				accepted += s.has_value();
+			});
+			while (!stop.stop_requested())
+			{
+				std::ignore = loop.run_for(100ms);
+			}
+		}));
+		// clang-format on
+
+		constexpr int clients = 8;
+		std::vector<tcp::socket> connected;
+		for (auto i = 0; i < clients; ++i)
+		{
+			auto client = pal::net::make_stream_socket(tcp::v4);
+			REQUIRE(client);
+			REQUIRE(client->connect(endpoint));
+			connected.push_back(std::move(*client));
+		}
+		CHECK(wait_until([&] { return accepted == clients; }));
+		group->stop();
+		CHECK(accepted == clients);
+	}
+
+	SECTION("cpu steering")
+	{
+		auto sockets = make_reuse_port_datagram_sockets(
+			*group,
+			udp::v4,
+			pal_test::udp_v4::loopback_endpoint(),
+			reuse_port_steering::cpu
+		);
+		if constexpr (pal::os == pal::os_type::linux)
+		{
+			REQUIRE(sockets);
+			CHECK(sockets->size() == 2);
+		}
+		else
+		{
+			REQUIRE_FALSE(sockets);
+			CHECK(sockets.error() == std::errc::operation_not_supported);
+		}
+	}
+}
+
+} // namespace
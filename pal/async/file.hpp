@@ -0,0 +1,314 @@
+#pragma once
+
+/**
+ * \file pal/async/file.hpp
+ * Asynchronous file
+ */
+
+#include <pal/async/__io.hpp>
+#include <pal/async/handle.hpp>
+#include <pal/file.hpp>
+#include <pal/require.hpp>
+#include <pal/result.hpp>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace pal::async
+{
+
+namespace __file
+{
+
+/// Operation kinds, dispatched by the backend or the offloaded work
+enum class op_kind
+{
+	read,
+	write,
+	fsync,
+};
+
+/// Offloaded operation's scratch state. The leading \ref __thread_pool::record is written by the pool at
+/// post time and preserved by the work closure (see the record contract in pal/async/thread_pool.hpp).
+struct op_state
+{
+	__thread_pool::record record;
+	__io::file_state *state;
+	uint64_t offset;
+	op_kind kind;
+	std::error_code ec;
+	size_t count;
+};
+static_assert(std::is_standard_layout_v<op_state>); // record at offset 0, per its contract
+
+} // namespace __file
+
+/// Asynchronous file, made by \ref event_loop::make_handle from an open \ref pal::file: positional reads
+/// and writes, and fsync, without blocking the loop's thread.
+///
+/// On the io_uring backend operations are native SQEs, and \ref event_loop::make_handle(T) suffices.
+/// Elsewhere (epoll, kqueue, IOCP) regular files have no readiness to poll, so operations run the
+/// blocking call on the thread_pool given to \ref event_loop::make_handle(T, thread_pool &) instead,
+/// which is then required; the same handle code runs on both, with the pool unused on io_uring.
+///
+/// Operations are single-shot and task-carried, as on stream sockets: each takes a \ref task_ptr,
+/// transfers payload through the task's window (\ref task::span, which the operation leaves untouched)
+/// and hands the task back to its handler on the loop's thread, from a later run(). Nothing allocates per
+/// operation. Unlike sockets, any number of operations may be in flight on one file; their relative
+/// order is unspecified (sequence dependent writes, and an fsync after the writes it covers, from the
+/// handlers). Loop-thread only.
+///
+/// Destruction does not cancel: operations in flight complete with their outcome from a later run(),
+/// and the file is closed after the last of them. Per the teardown contract the handle must be destroyed
+/// before its loop (and pool), and the loop run until they complete.
+template <>
+class handle<pal::file>
+{
+public:
+
+	handle (handle &&) noexcept = default;
+	handle &operator= (handle &&) noexcept = default;
+	~handle () noexcept = default;
+
+	/// Return the current file size
+	[[nodiscard]] result<uint64_t> size () const noexcept
+	{
+		return state_->resource.size();
+	}
+
+	/// Read into the task's payload window from \a offset, then run \a handler with the number of bytes
+	/// read (stored at the start of the window): fewer than the window holds only at end of file, 0 at or
+	/// past it.
+	template <typename H>
+	void start_read_at (task_ptr &&t, uint64_t offset, H handler) noexcept
+		requires __async::handler<H, void(task_ptr &&, result<size_t> &&) noexcept>
+	{
+		pal_require(!t->span().empty(), "start_read_at without task payload storage");
+		start<op_transfer>(std::move(t), __file::op_kind::read, offset, std::move(handler));
+	}
+
+	/// Write the task's payload window at \a offset, extending the file as needed, then run \a handler
+	/// with the number of bytes written. As with the synchronous write, that may be fewer than the window
+	/// holds: narrow the window past them and start the next write for the rest.
+	template <typename H>
+	void start_write_at (task_ptr &&t, uint64_t offset, H handler) noexcept
+		requires __async::handler<H, void(task_ptr &&, result<size_t> &&) noexcept>
+	{
+		pal_require(!t->span().empty(), "start_write_at without task payload");
+		start<op_transfer>(std::move(t), __file::op_kind::write, offset, std::move(handler));
+	}
+
+	/// Flush the file's written data and metadata to storage, then run \a handler with the outcome. Covers
+	/// writes completed before it starts, not those still in flight.
+	template <typename H>
+	void start_fsync (task_ptr &&t, H handler) noexcept
+		requires __async::handler<H, void(task_ptr &&, result<void> &&) noexcept>
+	{
+		start<op_fsync>(std::move(t), __file::op_kind::fsync, 0, std::move(handler));
+	}
+
+private:
+
+	struct op_transfer
+	{
+		using signature = void(task_ptr &&, result<size_t> &&) noexcept;
+
+		template <typename F>
+		static void dispatch (task &t, F &f, std::error_code ec, size_t n) noexcept
+		{
+			if (ec)
+			{
+				f(task_ptr{&t}, unexpected{ec});
+			}
+			else
+			{
+				f(task_ptr{&t}, result<size_t>{n});
+			}
+		}
+	};
+
+	struct op_fsync
+	{
+		using signature = void(task_ptr &&, result<void> &&) noexcept;
+
+		template <typename F>
+		static void dispatch (task &t, F &f, std::error_code ec, size_t) noexcept
+		{
+			if (ec)
+			{
+				f(task_ptr{&t}, unexpected{ec});
+			}
+			else
+			{
+				f(task_ptr{&t}, result<void>{});
+			}
+		}
+	};
+
+	struct state_deleter
+	{
+		void operator() (__io::file_state *s) const noexcept
+		{
+			s->closed = true;
+			if (s->in_flight == 0)
+			{
+				delete s;
+			}
+			else if (native(*s->loop))
+			{
+				s->loop->io_->file_close(s);
+			}
+			// else: the last offloaded operation's post-back releases it
+		}
+	};
+
+	using state_ptr = std::unique_ptr<__io::file_state, state_deleter>;
+
+	state_ptr state_;
+
+	// Offload target; null if the backend does file I/O natively
+	__thread_pool::impl_type *pool_;
+
+	handle (state_ptr &&state, __thread_pool::impl_type *pool) noexcept
+		: state_{std::move(state)}
+		, pool_{pool}
+	{
+	}
+
+	static bool native (const __event_loop::impl_type &loop) noexcept
+	{
+		return loop.io_ != nullptr && loop.io_->start_read_at != nullptr;
+	}
+
+	template <typename Op, typename H>
+	void start (task_ptr &&t, __file::op_kind kind, uint64_t offset, H handler) noexcept
+	{
+		auto *s = state_.get();
+		++s->in_flight;
+
+		if (pool_ == nullptr)
+		{
+			auto &op = t->scratch_as<__io::file_op>();
+			op = {};
+			op.state = s;
+			op.pending = t.get();
+			t->bind<Op>(std::move(handler));
+			t.release();
+
+			switch (kind)
+			{
+				case __file::op_kind::read:
+					s->loop->io_->start_read_at(op, offset);
+					break;
+				case __file::op_kind::write:
+					s->loop->io_->start_write_at(op, offset);
+					break;
+				case __file::op_kind::fsync:
+					s->loop->io_->start_fsync(op);
+					break;
+			}
+			return;
+		}
+
+		t->scratch_as<__file::op_state>() = {
+			.record = {.origin = s->loop},
+			.state = s,
+			.offset = offset,
+			.kind = kind,
+			.ec = {},
+			.count = 0,
+		};
+
+		auto work = [] (task &w) noexcept
+		{
+			auto &op = w.scratch_as<__file::op_state>();
+			const auto &f = op.state->resource;
+			result<size_t> r;
+			switch (op.kind)
+			{
+				case __file::op_kind::read:
+					r = f.read_at(w.span(), op.offset);
+					break;
+				case __file::op_kind::write:
+					r = f.write_at(w.span(), op.offset);
+					break;
+				case __file::op_kind::fsync:
+					r = f.sync().transform([] { return size_t{0}; });
+					break;
+			}
+			if (r)
+			{
+				op.count = *r;
+			}
+			else
+			{
+				op.ec = r.error();
+			}
+		};
+
+		auto wrapper = [h = std::move(handler)] (task_ptr &&p) mutable noexcept
+		{
+			const auto &op = p->scratch_as<__file::op_state>();
+			--op.record.origin->stats_.offload_in_flight;
+			auto *state = op.state;
+			const auto ec = op.ec;
+			const auto count = op.count;
+
+			// settle before the handler, which may destroy the handle
+			const bool release = --state->in_flight == 0 && state->closed;
+			Op::dispatch(*p.release(), h, ec, count);
+			if (release)
+			{
+				delete state;
+			}
+		};
+
+		using closure_type = __thread_pool::closure<decltype(work), decltype(wrapper)>;
+		static_assert(
+			sizeof(closure_type) <= __async::closure_capacity,
+			"file wrapper and handler closures exceed the closure budget"
+		);
+
+		++s->loop->stats_.offload_in_flight;
+		t->bind<__thread_pool::op_execute>(closure_type{std::move(work), std::move(wrapper)});
+		__thread_pool::submit(*pool_, *t.release());
+	}
+
+	static result<handle> open (pal::file &&f, __thread_pool::impl_type *pool, __event_loop::impl_type &loop) noexcept
+	{
+		if (!f)
+		{
+			return make_unexpected(std::errc::bad_file_descriptor);
+		}
+
+		auto *state = new (std::nothrow) __io::file_state{};
+		if (state == nullptr)
+		{
+			return make_unexpected(std::errc::not_enough_memory);
+		}
+		state->loop = &loop;
+		state->resource = std::move(f);
+
+		return handle{state_ptr{state}, native(loop) ? nullptr : pool};
+	}
+
+	static result<handle> make (pal::file &&f, __event_loop::impl_type &loop) noexcept
+	{
+		if (!native(loop))
+		{
+			return make_unexpected(std::errc::operation_not_supported);
+		}
+		return open(std::move(f), nullptr, loop);
+	}
+
+	static result<handle> make (pal::file &&f, __thread_pool::impl_type &pool, __event_loop::impl_type &loop) noexcept
+	{
+		return open(std::move(f), &pool, loop);
+	}
+
+	friend class event_loop;
+};
+
+} // namespace pal::async
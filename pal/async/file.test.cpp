@@ -0,0 +1,250 @@
+#include <pal/async/file.hpp>
+#include <pal/async/test.hpp>
+#include <pal/test.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace
+{
+
+using namespace pal::async;
+using namespace std::chrono_literals;
+
+using pal_test::default_backend;
+using pal_test::io_uring_backend;
+using pal_test::make_test_loop;
+using pal_test::run_until;
+
+using file_handle = handle<pal::file>;
+
+std::span<std::byte> as_writable_bytes (std::string_view s) noexcept
+{
+	return {reinterpret_cast<std::byte *>(const_cast<char *>(s.data())), s.size()};
+}
+
+TEMPLATE_TEST_CASE("async/file", "", default_backend, io_uring_backend)
+{
+	// tasks outlive the loop and pool: operations complete from the loop's runs
+	std::array<std::byte, 64> buffer{};
+	task t{buffer};
+
+	const pal_test::temp_file tmp;
+	const auto path = tmp.string();
+	auto f = pal::open_file(path.c_str(), pal::file::read | pal::file::write | pal::file::create);
+	REQUIRE(f);
+
+	auto loop = make_test_loop<TestType>();
+	auto pool = make_thread_pool(2);
+	REQUIRE(pool);
+
+	auto h = loop.make_handle(std::move(*f), *pool);
+	REQUIRE(h);
+	CHECK(h->size().value() == 0);
+
+	auto write_at = [&] (std::string_view data, uint64_t offset)
+	{
+		size_t written = 0;
+		bool done = false;
+		t.span(as_writable_bytes(data));
+		h->start_write_at(t.borrow(), offset, [&] (task_ptr &&p, pal::result<size_t> &&r) noexcept
+		{
+			done = p.get() == &t;
+			written = r.value_or(0);
+		});
+		run_until(loop, [&] { return done; });
+		REQUIRE(done);
+		return written;
+	};
+
+	auto read_at = [&] (uint64_t offset) -> pal::result<std::string>
+	{
+		pal::result<size_t> result = 0;
+		bool done = false;
+		t.span(buffer);
+		h->start_read_at(t.borrow(), offset, [&] (task_ptr &&p, pal::result<size_t> &&r) noexcept
+		{
+			done = p.get() == &t;
+			result = r;
+		});
+		run_until(loop, [&] { return done; });
+		REQUIRE(done);
+		CHECK(t.span().size() == buffer.size());
+		return result.transform([&] (size_t n) { return std::string{reinterpret_cast<const char *>(buffer.data()), n}; });
+	};
+
+	SECTION("start_write_at / start_read_at")
+	{
+		CHECK(write_at("world", 6) == 5);
+		CHECK(write_at("hello ", 0) == 6);
+		CHECK(h->size().value() == 11);
+
+		CHECK(read_at(0).value() == "hello world");
+		CHECK(read_at(6).value() == "world");
+		CHECK(read_at(11).value() == "");
+		CHECK(read_at(1000).value() == "");
+		CHECK(loop.stats().offload_in_flight == 0);
+	}
+
+	SECTION("start_fsync")
+	{
+		CHECK(write_at("log line\n", 0) == 9);
+
+		bool synced = false;
+		h->start_fsync(t.borrow(), [&] (task_ptr &&p, pal::result<void> &&r) noexcept
+		{
+			synced = r.has_value() && p.get() == &t;
+		});
+		run_until(loop, [&] { return synced; });
+		CHECK(synced);
+	}
+
+	SECTION("concurrent reads")
+	{
+		CHECK(write_at("0123456789", 0) == 10);
+
+		constexpr size_t count = 10;
+		std::array<std::array<std::byte, 1>, count> bytes{};
+		std::array<task, count> tasks{};
+		std::string result(count, '?');
+		size_t done = 0;
+
+		for (size_t i = 0; i != count; ++i)
+		{
+			tasks[i].span(bytes[i]);
+			h->start_read_at(tasks[i].borrow(), i, [&, i] (task_ptr &&p, pal::result<size_t> &&r) noexcept
+			{
+				if (r && *r == 1)
+				{
+					result[i] = static_cast<char>(p->span()[0]);
+				}
+				++done;
+			});
+		}
+		run_until(loop, [&] { return done == count; });
+		CHECK(result == "0123456789");
+	}
+
+	SECTION("append from handler")
+	{
+		// sequential log appends: each write starts from the previous one's handler
+		struct appender
+		{
+			file_handle *h;
+			const std::array<std::string_view, 3> *lines;
+			size_t next = 0;
+			uint64_t offset = 0;
+			bool *done;
+
+			void operator() (task_ptr &&p, pal::result<size_t> &&r) noexcept
+			{
+				offset += r.value_or(0);
+				if (++next == lines->size())
+				{
+					*done = true;
+					return;
+				}
+				p->span(as_writable_bytes((*lines)[next]));
+				h->start_write_at(std::move(p), offset, *this);
+			}
+		};
+
+		const std::array<std::string_view, 3> lines{"one\n", "two\n", "three\n"};
+		bool done = false;
+		t.span(as_writable_bytes(lines[0]));
+		h->start_write_at(t.borrow(), 0, appender{&*h, &lines, 0, 0, &done});
+		run_until(loop, [&] { return done; });
+		REQUIRE(done);
+		CHECK(read_at(0).value() == "one\ntwo\nthree\n");
+	}
+
+	SECTION("write to read-only file")
+	{
+		auto ro = pal::open_file(path.c_str(), pal::file::read);
+		REQUIRE(ro);
+		auto ro_handle = loop.make_handle(std::move(*ro), *pool);
+		REQUIRE(ro_handle);
+
+		bool failed = false;
+		t.span(as_writable_bytes("x"));
+		ro_handle->start_write_at(t.borrow(), 0, [&] (task_ptr &&, pal::result<size_t> &&r) noexcept
+		{
+			failed = !r && r.error() == std::errc::bad_file_descriptor;
+		});
+		run_until(loop, [&] { return failed; });
+		CHECK(failed);
+	}
+
+	SECTION("destroy with operations in flight")
+	{
+		CHECK(write_at("data", 0) == 4);
+
+		bool done = false;
+		t.span(buffer);
+		h->start_read_at(t.borrow(), 0, [&] (task_ptr &&, pal::result<size_t> &&r) noexcept
+		{
+			done = r.value_or(0) == 4;
+		});
+		*h = loop.make_handle(pal::open_file(path.c_str(), pal::file::read).value(), *pool).value();
+
+		// not cancelled: the read completes with its outcome, then the file closes
+		run_until(loop, [&] { return done; });
+		CHECK(done);
+	}
+
+	SECTION("handle destroyed from handler")
+	{
+		std::optional<file_handle> owned{std::move(*h)};
+		bool done = false;
+		t.span(buffer);
+		owned->start_read_at(t.borrow(), 0, [&] (task_ptr &&, pal::result<size_t> &&) noexcept
+		{
+			owned.reset();
+			done = true;
+		});
+		run_until(loop, [&] { return done; });
+		CHECK(done);
+		CHECK_FALSE(owned);
+	}
+}
+
+TEMPLATE_TEST_CASE("async/file make_handle", "", default_backend, io_uring_backend)
+{
+	const pal_test::temp_file tmp;
+	auto f = pal::open_file(tmp.string().c_str(), pal::file::write | pal::file::create);
+	REQUIRE(f);
+
+	auto loop = make_test_loop<TestType>();
+
+	SECTION("without pool")
+	{
+		auto h = loop.make_handle(std::move(*f));
+		if constexpr (std::is_same_v<TestType, io_uring_backend>)
+		{
+			CHECK(h);
+		}
+		else
+		{
+			// reactor backends have no native file I/O
+			REQUIRE_FALSE(h);
+			CHECK(h.error() == std::errc::operation_not_supported);
+		}
+	}
+
+	SECTION("closed file")
+	{
+		auto pool = make_thread_pool(1);
+		REQUIRE(pool);
+		auto h = loop.make_handle(pal::file{}, *pool);
+		REQUIRE_FALSE(h);
+		CHECK(h.error() == std::errc::bad_file_descriptor);
+	}
+}
+
+} // namespace
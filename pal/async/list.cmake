@@ -1,23 +1,45 @@
 list(APPEND pal_sources
 	pal/async/__async.hpp
+	pal/async/__io.hpp
+	pal/async/__io_uring.hpp
+	pal/async/coroutine.hpp
+	pal/async/datagram_socket.hpp
 	pal/async/event_loop.hpp
 	pal/async/event_loop.cpp
 	pal/async/event_loop.epoll.cpp
 	pal/async/event_loop.iocp.cpp
+	pal/async/event_loop.io_uring.cpp
 	pal/async/event_loop.kqueue.cpp
+	pal/async/event_loop_group.hpp
+	pal/async/event_loop_group.cpp
+	pal/async/file.hpp
 	pal/async/handle.hpp
 	pal/async/resolver.hpp
+	pal/async/socket_acceptor.hpp
+	pal/async/stream_socket.hpp
 	pal/async/task.hpp
 	pal/async/task_pool.hpp
+	pal/async/task_pool.cpp
 	pal/async/thread_pool.hpp
 	pal/async/thread_pool.cpp
 )
 
 list(APPEND pal_test_sources
+	pal/async/test.hpp
+
 	pal/async/__async.test.cpp
+	pal/async/coroutine.test.cpp
+	pal/async/datagram_socket.test.cpp
+	pal/async/event_loop.bench.cpp
 	pal/async/event_loop.test.cpp
+	pal/async/event_loop_group.test.cpp
+	pal/async/file.test.cpp
 	pal/async/resolver.test.cpp
+	pal/async/socket_acceptor.test.cpp
+	pal/async/stream_socket.test.cpp
 	pal/async/task.test.cpp
+	pal/async/task_pool.bench.cpp
 	pal/async/task_pool.test.cpp
+	pal/async/thread_pool.bench.cpp
 	pal/async/thread_pool.test.cpp
 )
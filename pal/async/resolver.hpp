@@ -177,6 +177,13 @@ private:
 	{
 	}
 
+	static result<handle> make (net::ip::basic_resolver<Protocol> &&resolver,
+		__thread_pool::impl_type &pool,
+		__event_loop::impl_type &loop) noexcept
+	{
+		return handle{std::move(resolver), pool, loop};
+	}
+
 	friend class event_loop;
 };
 
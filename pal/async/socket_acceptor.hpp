@@ -0,0 +1,160 @@
+#pragma once
+
+/**
+ * \file pal/async/socket_acceptor.hpp
+ * Asynchronous socket acceptor
+ */
+
+#include <pal/async/__io.hpp>
+#include <pal/async/handle.hpp>
+#include <pal/net/basic_socket_acceptor.hpp>
+#include <pal/net/socket_option.hpp>
+#include <pal/require.hpp>
+#include <pal/result.hpp>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace pal::async
+{
+
+/// Asynchronous listening acceptor for \a Protocol, made by \ref event_loop::make_handle(T) from a bound
+/// and listening \ref net::basic_socket_acceptor. Accept is multishot: one \ref start_accept keeps
+/// delivering new connections to its handler, on the loop's thread, until \ref stop_accept or a terminal
+/// error -- one multishot accept op on io_uring, one accept4 drain per readiness edge on epoll.
+///
+/// Accepted sockets are blocking and owned by the handler; adopt them with \ref event_loop::make_handle
+/// for async I/O. An armed accept is not "work" for \ref event_loop::run; drive an accepting loop with
+/// \ref event_loop::run_for.
+///
+/// Made non-blocking on adoption. Destruction stops any accept and closes the acceptor; per the teardown
+/// contract it must happen before the loop is destroyed.
+template <typename Protocol>
+class handle<net::basic_socket_acceptor<Protocol>>
+{
+public:
+
+	using protocol_type = Protocol;
+	using endpoint_type = Protocol::endpoint;
+	using socket_type = Protocol::socket;
+
+	handle (handle &&) noexcept = default;
+	~handle () noexcept = default;
+
+	handle &operator= (handle &&that) noexcept
+	{
+		// release the state while its socket is still open, as the destructor does
+		state_ = std::move(that.state_);
+		acceptor_ = std::move(that.acceptor_);
+		return *this;
+	}
+
+	/// Return local endpoint to which this acceptor is bound
+	[[nodiscard]] result<endpoint_type> local_endpoint () const noexcept
+	{
+		return acceptor_.local_endpoint();
+	}
+
+	/// Start accepting: run \a handler on the loop's thread for every new connection, until
+	/// \ref stop_accept. An error is terminal: the accept is stopped before \a handler sees it, so
+	/// \a handler may restart it from inside the call. Loop-thread-only; at most one accept at a time
+	/// (starting a second without stopping the first is a contract violation).
+	template <typename H>
+	void start_accept (H handler) noexcept
+		requires __async::handler<H, void(result<socket_type> &&) noexcept>
+	{
+		state_->accept.template arm<op_accept>(std::move(handler));
+		state_->loop->io_->start_accept(*state_);
+	}
+
+	/// Stop accepting; no-op if no accept is active. The handler is not run again; connections the kernel
+	/// has already completed stay queued for the next start_accept, in arrival order. Loop-thread-only,
+	/// callable from inside the handler.
+	void stop_accept () noexcept
+	{
+		if (state_->accept.armed())
+		{
+			state_->accept.stop();
+			state_->loop->io_->stop_accept(*state_);
+		}
+	}
+
+private:
+
+	struct op_accept
+	{
+		using signature = void(result<socket_type> &&) noexcept;
+
+		template <typename F>
+		static void dispatch (__io::acceptor_state &s, F &f, std::error_code ec, size_t) noexcept
+		{
+			if (ec)
+			{
+				// terminal: disarm before the call (so the handler may restart) from a copy of itself
+				auto h = f;
+				s.accept.stop();
+				h(unexpected{ec});
+				return;
+			}
+
+			auto accepted = std::exchange(s.accepted, net::__socket::handle_type::invalid);
+			f(net::__socket::to_api<socket_type>()(net::native_socket{accepted, s.family}));
+		}
+	};
+
+	struct state_deleter
+	{
+		void operator() (__io::acceptor_state *s) const noexcept
+		{
+			s->closed = true;
+			s->loop->io_->acceptor_close(s);
+		}
+	};
+
+	using state_ptr = std::unique_ptr<__io::acceptor_state, state_deleter>;
+
+	// declaration order matters: the state is released before the socket closes
+	net::basic_socket_acceptor<Protocol> acceptor_;
+	state_ptr state_;
+
+	handle (net::basic_socket_acceptor<Protocol> &&acceptor, state_ptr &&state) noexcept
+		: acceptor_{std::move(acceptor)}
+		, state_{std::move(state)}
+	{
+	}
+
+	static result<handle> make (net::basic_socket_acceptor<Protocol> &&acceptor, __event_loop::impl_type &loop) noexcept
+	{
+		if (loop.io_ == nullptr)
+		{
+			return make_unexpected(std::errc::operation_not_supported);
+		}
+
+		if (auto r = acceptor.set_option(net::non_blocking_io{true}); !r)
+		{
+			return unexpected{r.error()};
+		}
+
+		auto *state = new (std::nothrow) __io::acceptor_state{};
+		if (state == nullptr)
+		{
+			return make_unexpected(std::errc::not_enough_memory);
+		}
+		state->loop = &loop;
+		state->handle = acceptor.native_socket().handle();
+		state->release = &__io::release_acceptor;
+		state->family = acceptor.protocol().family();
+
+		if (auto r = loop.io_->acceptor_open(loop, *state); !r)
+		{
+			delete state;
+			return unexpected{r.error()};
+		}
+
+		return handle{std::move(acceptor), state_ptr{state}};
+	}
+
+	friend class event_loop;
+};
+
+} // namespace pal::async
@@ -0,0 +1,193 @@
+#include <pal/async/socket_acceptor.hpp>
+#include <pal/async/test.hpp>
+#include <pal/net/test.hpp>
+#include <pal/test.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <vector>
+
+namespace
+{
+
+using namespace pal::async;
+using namespace std::chrono_literals;
+
+using pal_test::default_backend;
+using pal_test::io_uring_backend;
+using pal_test::make_test_loop;
+using pal_test::run_until;
+
+using tcp = pal::net::ip::tcp;
+using acceptor_handle = handle<pal::net::basic_socket_acceptor<tcp>>;
+
+acceptor_handle make_acceptor (event_loop &loop)
+{
+	auto acceptor = pal::net::make_socket_acceptor(tcp::v4, pal_test::tcp_v4::loopback_endpoint());
+	REQUIRE(acceptor);
+	auto h = loop.make_handle(std::move(*acceptor));
+	if (!h && h.error() == std::errc::operation_not_supported)
+	{
+		SKIP("backend has no socket support");
+	}
+	REQUIRE(h);
+	return std::move(*h);
+}
+
+TEMPLATE_TEST_CASE("async/socket_acceptor", "", default_backend, io_uring_backend)
+{
+	auto loop = make_test_loop<TestType>();
+	auto acceptor = make_acceptor(loop);
+	const auto endpoint = acceptor.local_endpoint().value();
+
+	std::vector<tcp::socket> clients;
+	const auto connect = [&]
+	{
+		auto client = pal::net::make_stream_socket(tcp::v4);
+		REQUIRE(client);
+		REQUIRE(client->connect(endpoint));
+		clients.push_back(std::move(*client));
+	};
+
+	SECTION("start_accept")
+	{
+		std::vector<tcp::socket> accepted;
+		bool valid = true;
+
+		// clang-format off
+		acceptor.start_accept([&] (pal::result<tcp::socket> &&s) noexcept
+		{
+			valid = valid && s.has_value() && *s;
+			if (s)
+			{
+				accepted.push_back(std::move(*s));
+			}
+		});
+		// clang-format on
+
+		// one armed accept delivers every connection
+		for (auto i = 0; i < 3; ++i)
+		{
+			connect();
+		}
+		run_until(loop, [&] { return accepted.size() == 3; });
+		REQUIRE(accepted.size() == 3);
+		CHECK(valid);
+		CHECK(loop.stats().completions >= 3);
+
+		// accepted socket is connected to one of the clients
+		const auto remote = accepted[0].remote_endpoint();
+		REQUIRE(remote);
+		bool found = false;
+		for (auto &client: clients)
+		{
+			found = found || client.local_endpoint().value() == *remote;
+		}
+		CHECK(found);
+	}
+
+	SECTION("pending before start_accept")
+	{
+		connect();
+		connect();
+
+		size_t accepted = 0;
+		acceptor.start_accept([&] (pal::result<tcp::socket> &&s) noexcept { accepted += s.has_value(); });
+		run_until(loop, [&] { return accepted == 2; });
+		CHECK(accepted == 2);
+	}
+
+	SECTION("stop_accept inside handler")
+	{
+		size_t accepted = 0;
+
+		// clang-format off
+		acceptor.start_accept([&] (pal::result<tcp::socket> &&) noexcept
+		{
+			++accepted;
+			acceptor.stop_accept();
+		});
+		// clang-format on
+
+		connect();
+		run_until(loop, [&] { return accepted > 0; });
+		std::ignore = loop.run_for(20ms);
+		CHECK(accepted == 1);
+
+		// restart
+		acceptor.start_accept([&] (pal::result<tcp::socket> &&s) noexcept { accepted += s.has_value(); });
+		connect();
+		run_until(loop, [&] { return accepted >= 2; });
+		CHECK(accepted >= 2);
+	}
+
+	SECTION("stop_accept keeps completed connections")
+	{
+		// all three complete in the kernel before the first handler stops the accept: the other two
+		// wait for the restart (io_uring: taken by the multishot op, queued on the acceptor)
+		connect();
+		connect();
+		connect();
+
+		size_t accepted = 0;
+		acceptor.start_accept([&] (pal::result<tcp::socket> &&s) noexcept
+		{
+			accepted += s.has_value();
+			acceptor.stop_accept();
+		});
+		run_until(loop, [&] { return accepted > 0; });
+		std::ignore = loop.run_for(20ms);
+		CHECK(accepted == 1);
+
+		acceptor.start_accept([&] (pal::result<tcp::socket> &&s) noexcept { accepted += s.has_value(); });
+		run_until(loop, [&] { return accepted == 3; });
+		CHECK(accepted == 3);
+	}
+
+	SECTION("destroy with completed connections queued")
+	{
+		connect();
+		connect();
+
+		size_t accepted = 0;
+		acceptor.start_accept([&] (pal::result<tcp::socket> &&) noexcept
+		{
+			++accepted;
+			acceptor.stop_accept();
+		});
+		run_until(loop, [&] { return accepted > 0; });
+		std::ignore = loop.run_for(20ms);
+		acceptor = make_acceptor(loop);
+		std::ignore = loop.run_for(10ms);
+		CHECK(accepted == 1);
+	}
+
+	SECTION("stop_accept: not accepting")
+	{
+		acceptor.stop_accept();
+		CHECK(loop.run_once().value() == 0);
+	}
+
+	SECTION("destroy while accepting")
+	{
+		size_t accepted = 0;
+		{
+			auto other = make_acceptor(loop);
+			other.start_accept([&] (pal::result<tcp::socket> &&) noexcept { ++accepted; });
+			std::ignore = loop.run_once();
+		}
+		std::ignore = loop.run_for(10ms);
+		CHECK(accepted == 0);
+	}
+
+	SECTION("move assignment releases the previous accept")
+	{
+		size_t accepted = 0;
+		acceptor.start_accept([&] (pal::result<tcp::socket> &&) noexcept { ++accepted; });
+		acceptor = make_acceptor(loop);
+		std::ignore = loop.run_for(20ms);
+		CHECK(accepted == 0);
+	}
+}
+
+} // namespace
@@ -0,0 +1,293 @@
+#pragma once
+
+/**
+ * \file pal/async/stream_socket.hpp
+ * Asynchronous stream socket
+ */
+
+#include <pal/async/__io.hpp>
+#include <pal/async/handle.hpp>
+#include <pal/net/basic_stream_socket.hpp>
+#include <pal/net/socket_option.hpp>
+#include <pal/require.hpp>
+#include <pal/result.hpp>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace pal::async
+{
+
+namespace __stream_socket
+{
+
+/// start_send_zerocopy's op scratch state
+struct zerocopy_state
+{
+	// the "sent" phase is dispatched, the release is next
+	bool sent;
+};
+
+/// start_send_zerocopy's op: its closure tells the phases apart
+struct op_send_zerocopy
+{
+	using signature = void(task &, std::error_code, size_t) noexcept;
+
+	template <typename F>
+	static void dispatch (task &t, F &f, std::error_code ec, size_t n) noexcept
+	{
+		f(t, ec, n);
+	}
+};
+
+/// Both phases' handlers, bound to the task once per phase: rebound for the release when the "sent"
+/// phase runs, so the backend completes the same task twice.
+template <typename Sent, typename Released>
+struct zerocopy_closure
+{
+	// no_unique_address: a stateless handler must not pad the other out of the closure budget
+	[[no_unique_address]] Sent sent;
+	[[no_unique_address]] Released released;
+
+	void operator() (task &t, std::error_code ec, size_t n) noexcept
+	{
+		auto &state = t.scratch_as<zerocopy_state>();
+		if (!state.sent)
+		{
+			state.sent = true;
+			t.bind<op_send_zerocopy>(*this);
+			if (ec)
+			{
+				sent(unexpected{ec});
+			}
+			else
+			{
+				sent(result<size_t>{n});
+			}
+		}
+		else
+		{
+			released(task_ptr{&t});
+		}
+	}
+};
+
+} // namespace __stream_socket
+
+/// Asynchronous stream socket for \a Protocol, made by \ref event_loop::make_handle(T) from a fresh
+/// (to \ref start_connect) or connected (e.g. accepted) \ref net::basic_stream_socket.
+///
+/// Operations are single-shot and task-carried: each takes a \ref task_ptr, transfers payload through the
+/// task's window (\ref task::span, which the operation leaves untouched) and hands the task back to its
+/// handler on the loop's thread, from a later run(). Nothing allocates per operation. At most one
+/// operation per direction is in flight: a connect or a send, and a receive (starting a second one in the
+/// same direction is a contract violation); the handler may start the next one from inside its call.
+///
+/// Made non-blocking on adoption. Destruction closes the socket; operations still in flight then
+/// complete with \c std::errc::operation_canceled (or, on io_uring, with their outcome should they race
+/// the close) from a later run(). Per the teardown contract it must happen before the loop is destroyed.
+template <typename Protocol>
+class handle<net::basic_stream_socket<Protocol>>
+{
+public:
+
+	using protocol_type = Protocol;
+	using endpoint_type = Protocol::endpoint;
+
+	/// Most payload windows of a chain (\ref task::chain) one send or receive transfers
+	static constexpr size_t chain_window_limit = __io::stream_vector_count;
+
+	handle (handle &&) noexcept = default;
+	~handle () noexcept = default;
+
+	handle &operator= (handle &&that) noexcept
+	{
+		// release the state while its socket is still open, as the destructor does
+		state_ = std::move(that.state_);
+		socket_ = std::move(that.socket_);
+		return *this;
+	}
+
+	/// Return local endpoint to which this socket is bound
+	[[nodiscard]] result<endpoint_type> local_endpoint () const noexcept
+	{
+		return socket_.local_endpoint();
+	}
+
+	/// Return remote endpoint to which this socket is connected
+	[[nodiscard]] result<endpoint_type> remote_endpoint () const noexcept
+	{
+		return socket_.remote_endpoint();
+	}
+
+	/// Shut down all or part of the full-duplex connection
+	[[nodiscard]] result<void> shutdown (net::socket_base::shutdown_type what) noexcept
+	{
+		return socket_.shutdown(what);
+	}
+
+	/// Connect to \a endpoint, then run \a handler with the outcome. The endpoint is copied into the
+	/// task's op scratch, so it need not outlive the call. Occupies the send direction.
+	template <typename H>
+	void start_connect (task_ptr &&t, const endpoint_type &endpoint, H handler) noexcept
+		requires __async::handler<H, void(task_ptr &&, result<void> &&) noexcept>
+	{
+		static_assert(std::is_trivially_copyable_v<endpoint_type>);
+		auto &scratch = t->scratch_as<endpoint_type>();
+		scratch = endpoint;
+		t->bind<op_connect>(std::move(handler));
+		state_->loop->io_->start_connect(*state_, *t.release(), scratch.data(), scratch.size());
+	}
+
+	/// Send the task's payload window, then run \a handler with the number of bytes sent. As with the
+	/// synchronous send, that may be fewer than the window holds: narrow the window past them and start
+	/// the next send for the rest.
+	///
+	/// A task heading a payload chain (\ref task::chain) sends its window and then each segment's in one
+	/// gathering syscall, without copying: a message larger than one pool buffer goes out as is. The
+	/// count spans the chain; of a chain longer than \ref chain_window_limit windows, only that many go
+	/// per send.
+	template <typename H>
+	void start_send (task_ptr &&t, H handler) noexcept
+		requires __async::handler<H, void(task_ptr &&, result<size_t> &&) noexcept>
+	{
+		pal_require(!t->span().empty(), "start_send without task payload");
+		t->bind<op_transfer>(std::move(handler));
+		state_->loop->io_->start_send(*state_, *t.release());
+	}
+
+	/// Send the task's payload window (not its chain) without copying it into the kernel, in two phases:
+	/// \a on_sent runs with the number of bytes sent (as with \ref start_send, possibly fewer than the
+	/// window holds) while the kernel may still read the payload; \a on_released runs later with the task,
+	/// once it no longer does. Until then the payload must stay intact and the send direction stays busy;
+	/// \a on_sent may not start another send. On failure \a on_released follows \a on_sent right away.
+	///
+	/// Pays off for large payloads only: page pinning and the release notification cost more than copying
+	/// a few KiB. On epoll the kernel may fall back to copying (e.g. over loopback), still notifying.
+	/// Destroying the handle while the kernel holds the payload defers \a on_released until it lets go
+	/// (or, at the latest, the loop's destruction).
+	template <typename Sent, typename Released>
+	void start_send_zerocopy (task_ptr &&t, Sent on_sent, Released on_released) noexcept
+		requires __async::handler<Sent, void(result<size_t> &&) noexcept>
+			&& __async::handler<Released, void(task_ptr &&) noexcept>
+	{
+		using closure_type = __stream_socket::zerocopy_closure<Sent, Released>;
+		static_assert(
+			sizeof(closure_type) <= __async::closure_capacity,
+			"on_sent and on_released closures exceed the closure budget"
+		);
+
+		pal_require(!t->span().empty(), "start_send_zerocopy without task payload");
+		t->scratch_as<__stream_socket::zerocopy_state>() = {.sent = false};
+		t->bind<__stream_socket::op_send_zerocopy>(closure_type{std::move(on_sent), std::move(on_released)});
+		state_->loop->io_->start_send_zerocopy(*state_, *t.release());
+	}
+
+	/// Receive into the task's payload window, then run \a handler with the number of bytes received
+	/// (stored at the start of the window): at least one, or 0 once the peer has shut down its sending
+	/// side. A task heading a payload chain scatters them across its window and then each segment's, in
+	/// chain order, filling each before the next (at most \ref chain_window_limit windows per receive).
+	template <typename H>
+	void start_receive (task_ptr &&t, H handler) noexcept
+		requires __async::handler<H, void(task_ptr &&, result<size_t> &&) noexcept>
+	{
+		pal_require(!t->span().empty(), "start_receive without task payload storage");
+		t->bind<op_transfer>(std::move(handler));
+		state_->loop->io_->start_receive(*state_, *t.release());
+	}
+
+private:
+
+	struct op_connect
+	{
+		using signature = void(task_ptr &&, result<void> &&) noexcept;
+
+		template <typename F>
+		static void dispatch (task &t, F &f, std::error_code ec, size_t) noexcept
+		{
+			if (ec)
+			{
+				f(task_ptr{&t}, unexpected{ec});
+			}
+			else
+			{
+				f(task_ptr{&t}, result<void>{});
+			}
+		}
+	};
+
+	struct op_transfer
+	{
+		using signature = void(task_ptr &&, result<size_t> &&) noexcept;
+
+		template <typename F>
+		static void dispatch (task &t, F &f, std::error_code ec, size_t n) noexcept
+		{
+			if (ec)
+			{
+				f(task_ptr{&t}, unexpected{ec});
+			}
+			else
+			{
+				f(task_ptr{&t}, result<size_t>{n});
+			}
+		}
+	};
+
+	struct state_deleter
+	{
+		void operator() (__io::stream_state *s) const noexcept
+		{
+			s->closed = true;
+			s->loop->io_->stream_close(s);
+		}
+	};
+
+	using state_ptr = std::unique_ptr<__io::stream_state, state_deleter>;
+
+	// declaration order matters: the state is released before the socket closes
+	net::basic_stream_socket<Protocol> socket_;
+	state_ptr state_;
+
+	handle (net::basic_stream_socket<Protocol> &&socket, state_ptr &&state) noexcept
+		: socket_{std::move(socket)}
+		, state_{std::move(state)}
+	{
+	}
+
+	static result<handle> make (net::basic_stream_socket<Protocol> &&socket, __event_loop::impl_type &loop) noexcept
+	{
+		if (loop.io_ == nullptr)
+		{
+			return make_unexpected(std::errc::operation_not_supported);
+		}
+
+		if (auto r = socket.set_option(net::non_blocking_io{true}); !r)
+		{
+			return unexpected{r.error()};
+		}
+
+		auto *state = new (std::nothrow) __io::stream_state{};
+		if (state == nullptr)
+		{
+			return make_unexpected(std::errc::not_enough_memory);
+		}
+		state->loop = &loop;
+		state->handle = socket.native_socket().handle();
+		state->release = &__io::release_stream;
+		state->read.state = state->write.state = state;
+
+		if (auto r = loop.io_->stream_open(loop, *state); !r)
+		{
+			delete state;
+			return unexpected{r.error()};
+		}
+
+		return handle{std::move(socket), state_ptr{state}};
+	}
+
+	friend class event_loop;
+};
+
+} // namespace pal::async
@@ -0,0 +1,446 @@
+#include <pal/async/stream_socket.hpp>
+#include <pal/async/task_pool.hpp>
+#include <pal/async/test.hpp>
+#include <pal/net/basic_socket_acceptor.hpp>
+#include <pal/net/test.hpp>
+#include <pal/test.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+using namespace pal::async;
+using namespace std::chrono_literals;
+
+using pal_test::default_backend;
+using pal_test::io_uring_backend;
+using pal_test::make_test_loop;
+using pal_test::run_until;
+
+using tcp = pal::net::ip::tcp;
+using socket_handle = handle<pal::net::basic_stream_socket<tcp>>;
+
+socket_handle make_stream (event_loop &loop, tcp::socket &&socket)
+{
+	auto h = loop.make_handle(std::move(socket));
+	if (!h && h.error() == std::errc::operation_not_supported)
+	{
+		SKIP("backend has no socket support");
+	}
+	REQUIRE(h);
+	return std::move(*h);
+}
+
+std::span<std::byte> as_writable_bytes (std::string_view s) noexcept
+{
+	return {reinterpret_cast<std::byte *>(const_cast<char *>(s.data())), s.size()};
+}
+
+TEMPLATE_TEST_CASE("async/stream_socket", "", default_backend, io_uring_backend)
+{
+	// tasks outlive the loop: operations still pending when their handle goes complete (cancelled) from
+	// the loop's next run or its destruction
+	std::array<std::byte, 1024> client_buffer{}, server_buffer{};
+	task client_task{client_buffer}, server_task{server_buffer};
+
+	auto loop = make_test_loop<TestType>();
+
+	auto acceptor = pal::net::make_socket_acceptor(tcp::v4, pal_test::tcp_v4::loopback_endpoint());
+	REQUIRE(acceptor);
+	const auto endpoint = acceptor->local_endpoint().value();
+
+	auto client_socket = pal::net::make_stream_socket(tcp::v4);
+	REQUIRE(client_socket);
+	auto client = make_stream(loop, std::move(*client_socket));
+
+	bool connected = false;
+	client.start_connect(client_task.borrow(), endpoint, [&] (task_ptr &&t, pal::result<void> &&r) noexcept
+	{
+		connected = r.has_value() && t.get() == &client_task;
+	});
+	run_until(loop, [&] { return connected; });
+	REQUIRE(connected);
+
+	auto accepted = acceptor->accept();
+	REQUIRE(accepted);
+	auto server = make_stream(loop, std::move(*accepted));
+	CHECK(client.remote_endpoint().value() == endpoint);
+	CHECK(server.remote_endpoint().value() == client.local_endpoint().value());
+
+	constexpr std::string_view payload = "stream";
+
+	SECTION("start_send / start_receive")
+	{
+		size_t received = 0;
+		server.start_receive(server_task.borrow(), [&] (task_ptr &&t, pal::result<size_t> &&r) noexcept
+		{
+			received = r.value_or(0);
+			CHECK(t->span().size() == server_buffer.size());
+		});
+
+		std::memcpy(client_buffer.data(), payload.data(), payload.size());
+		client_task.span(std::span{client_buffer}.first(payload.size()));
+
+		size_t sent = 0;
+		client.start_send(client_task.borrow(), [&] (task_ptr &&, pal::result<size_t> &&r) noexcept
+		{
+			sent = r.value_or(0);
+		});
+
+		run_until(loop, [&] { return sent > 0 && received > 0; });
+		CHECK(sent == payload.size());
+		REQUIRE(received == payload.size());
+		CHECK(std::memcmp(server_buffer.data(), payload.data(), payload.size()) == 0);
+	}
+
+	SECTION("receive before send, restart inside handler")
+	{
+		std::string received;
+
+		struct receiver
+		{
+			socket_handle *server;
+			std::string *received;
+
+			void operator() (task_ptr &&t, pal::result<size_t> &&r) const noexcept
+			{
+				if (r && *r > 0)
+				{
+					received->append(reinterpret_cast<const char *>(t->span().data()), *r);
+					server->start_receive(std::move(t), *this);
+				}
+			}
+		};
+		server.start_receive(server_task.borrow(), receiver{&server, &received});
+		std::ignore = loop.run_for(5ms);
+
+		for (auto part: {"one", "two", "three"})
+		{
+			bool sent = false;
+			client_task.span(as_writable_bytes(part));
+			client.start_send(client_task.borrow(), [&] (task_ptr &&, pal::result<size_t> &&r) noexcept
+			{
+				sent = r.has_value();
+			});
+			run_until(loop, [&] { return sent; });
+			REQUIRE(sent);
+		}
+		run_until(loop, [&] { return received.size() == 11; });
+		CHECK(received == "onetwothree");
+	}
+
+	SECTION("orderly shutdown")
+	{
+		bool done = false;
+		size_t received = 1;
+		server.start_receive(server_task.borrow(), [&] (task_ptr &&, pal::result<size_t> &&r) noexcept
+		{
+			done = true;
+			received = r.value_or(1);
+		});
+		REQUIRE(client.shutdown(pal::net::socket_base::shutdown_send));
+		run_until(loop, [&] { return done; });
+		CHECK(received == 0);
+	}
+
+	SECTION("pool-managed task")
+	{
+		task_pool<2> pool;
+		auto t = pool.try_acquire();
+		REQUIRE(t);
+		const auto *raw = t.get();
+
+		bool done = false;
+		server.start_receive(std::move(t), [&] (task_ptr &&p, pal::result<size_t> &&r) noexcept
+		{
+			done = r.has_value() && p.get() == raw;
+		});
+
+		std::memcpy(client_buffer.data(), payload.data(), payload.size());
+		client_task.span(std::span{client_buffer}.first(payload.size()));
+		client.start_send(client_task.borrow(), [] (task_ptr &&, pal::result<size_t> &&) noexcept { });
+		run_until(loop, [&] { return done; });
+		CHECK(done);
+
+		// recycled back into the pool on handler return
+		auto a = pool.try_acquire(), b = pool.try_acquire();
+		CHECK(a);
+		CHECK(b);
+	}
+
+	SECTION("chained payload")
+	{
+		// the message spans the carrier and its segments, gathered on send and scattered on receive
+		constexpr std::string_view parts[] = {"chained ", "payload ", "segments"};
+		std::array<task, 2> send_segments{}, receive_segments{};
+		std::array<std::array<std::byte, 4>, 2> receive_buffers{};
+
+		client_task.span(as_writable_bytes(parts[0]));
+		for (size_t i = 0; i != send_segments.size(); ++i)
+		{
+			send_segments[i].span(as_writable_bytes(parts[i + 1]));
+			client_task.chain(send_segments[i].borrow());
+		}
+
+		size_t sent = 0;
+		client.start_send(client_task.borrow(), [&] (task_ptr &&t, pal::result<size_t> &&r) noexcept
+		{
+			sent = r.value_or(0);
+			CHECK(t->next_segment() == &send_segments[0]);
+		});
+		run_until(loop, [&] { return sent > 0; });
+		REQUIRE(sent == 24);
+
+		// 4 + 4 + 4 bytes per receive: the rest stays queued for the next
+		server_task.span(std::span{server_buffer}.first(4));
+		for (size_t i = 0; i != receive_segments.size(); ++i)
+		{
+			receive_segments[i].span(receive_buffers[i]);
+			server_task.chain(receive_segments[i].borrow());
+		}
+
+		std::string received;
+		size_t receives = 0;
+		struct receiver
+		{
+			socket_handle *server;
+			std::string *received;
+			size_t *receives;
+
+			void operator() (task_ptr &&t, pal::result<size_t> &&r) noexcept
+			{
+				++*receives;
+				auto left = r.value_or(0);
+				for (auto *s = t.get(); s != nullptr && left > 0; s = s->next_segment())
+				{
+					const auto n = std::min(left, s->span().size());
+					received->append(reinterpret_cast<const char *>(s->span().data()), n);
+					left -= n;
+				}
+				if (received->size() < 24 && r.value_or(0) > 0)
+				{
+					server->start_receive(std::move(t), *this);
+				}
+			}
+		};
+		server.start_receive(server_task.borrow(), receiver{&server, &received, &receives});
+		run_until(loop, [&] { return received.size() == 24; });
+		CHECK(received == "chained payload segments");
+		CHECK(receives == 2);
+
+		// the chain is the app's: unchained after use
+		auto first = client_task.unchain();
+		CHECK(first.get() == &send_segments[0]);
+		CHECK(client_task.next_segment() == nullptr);
+		std::ignore = server_task.unchain();
+	}
+
+	SECTION("chained payload: long chain")
+	{
+		// more windows than one send maps, one byte each: the rest is left for the next send
+		constexpr std::string_view message = "one byte per segment, in chain order";
+		constexpr auto limit = socket_handle::chain_window_limit;
+		static_assert(message.size() > limit);
+		std::vector<task> segments(message.size() - 1);
+
+		client_task.span(as_writable_bytes(message.substr(0, 1)));
+		for (size_t i = 0; i != segments.size(); ++i)
+		{
+			segments[i].span(as_writable_bytes(message.substr(i + 1, 1)));
+			client_task.chain(segments[i].borrow());
+		}
+
+		size_t sent = 0;
+		client.start_send(client_task.borrow(), [&] (task_ptr &&, pal::result<size_t> &&r) noexcept
+		{
+			sent = r.value_or(0);
+		});
+
+		size_t received = 0;
+		server.start_receive(server_task.borrow(), [&] (task_ptr &&, pal::result<size_t> &&r) noexcept
+		{
+			received = r.value_or(0);
+		});
+
+		run_until(loop, [&] { return sent > 0 && received > 0; });
+		CHECK(sent == limit);
+		REQUIRE(received == limit);
+		CHECK(std::string_view{reinterpret_cast<const char *>(server_buffer.data()), received} == message.substr(0, limit));
+		std::ignore = client_task.unchain();
+	}
+
+	SECTION("start_send_zerocopy")
+	{
+		// large enough for the kernel to pin pages rather than copy (except over loopback)
+		std::vector<std::byte> payload_buffer(256 * 1024);
+		for (size_t i = 0; i != payload_buffer.size(); ++i)
+		{
+			payload_buffer[i] = static_cast<std::byte>(i * 7);
+		}
+		task zerocopy_task{payload_buffer};
+
+		size_t sent = 0;
+		int sent_calls = 0, released_calls = 0;
+		bool released_after_sent = false;
+		task *released = nullptr;
+
+		// clang-format off
+		client.start_send_zerocopy(zerocopy_task.borrow(),
+			[&] (pal::result<size_t> &&r) noexcept
+			{
+				sent = r.value_or(0);
+				++sent_calls;
+			},
+			[&] (task_ptr &&t) noexcept
+			{
+				released = t.get();
+				released_after_sent = sent_calls == 1;
+				++released_calls;
+			}
+		);
+		// clang-format on
+
+		// drain the peer, so the kernel gets its acks and lets go of the payload
+		std::vector<std::byte> received;
+		struct receiver
+		{
+			socket_handle *server;
+			std::vector<std::byte> *received;
+			size_t expected;
+
+			void operator() (task_ptr &&t, pal::result<size_t> &&r) const noexcept
+			{
+				if (r && *r > 0)
+				{
+					received->insert(received->end(), t->span().begin(), t->span().begin() + *r);
+					if (received->size() < expected)
+					{
+						server->start_receive(std::move(t), *this);
+					}
+				}
+			}
+		};
+		std::vector<std::byte> receive_buffer(payload_buffer.size());
+		task receive_task{receive_buffer};
+		server.start_receive(receive_task.borrow(), receiver{&server, &received, payload_buffer.size()});
+
+		run_until(loop, [&] { return released_calls == 1 && received.size() == sent; });
+		CHECK(sent_calls == 1);
+		CHECK(released_calls == 1);
+		CHECK(released_after_sent);
+		CHECK(released == &zerocopy_task);
+		REQUIRE(sent > 0);
+		REQUIRE(received.size() == sent);
+		CHECK(std::memcmp(received.data(), payload_buffer.data(), sent) == 0);
+
+		// send direction usable again
+		bool sent_again = false;
+		client_task.span(as_writable_bytes(payload));
+		client.start_send(client_task.borrow(), [&] (task_ptr &&, pal::result<size_t> &&r) noexcept
+		{
+			sent_again = r.has_value();
+		});
+		run_until(loop, [&] { return sent_again; });
+		CHECK(sent_again);
+	}
+
+	SECTION("start_send_zerocopy: failure releases right away")
+	{
+		REQUIRE(client.shutdown(pal::net::socket_base::shutdown_send));
+
+		std::error_code error{};
+		int released_calls = 0;
+		client_task.span(as_writable_bytes(payload));
+
+		// clang-format off
+		client.start_send_zerocopy(client_task.borrow(),
+			[&] (pal::result<size_t> &&r) noexcept
+			{
+				error = r ? std::error_code{} : r.error();
+			},
+			[&] (task_ptr &&) noexcept
+			{
+				++released_calls;
+			}
+		);
+		// clang-format on
+
+		run_until(loop, [&] { return released_calls > 0; });
+		CHECK(released_calls == 1);
+		CHECK(error == std::errc::not_connected);
+	}
+
+	SECTION("destroy with receive pending")
+	{
+		std::error_code error{};
+		server.start_receive(server_task.borrow(), [&] (task_ptr &&, pal::result<size_t> &&r) noexcept
+		{
+			error = r ? std::error_code{} : r.error();
+		});
+		std::ignore = loop.run_once();
+
+		server = make_stream(loop, std::move(*pal::net::make_stream_socket(tcp::v4)));
+		run_until(loop, [&] { return error != std::error_code{}; });
+		CHECK(error == std::errc::operation_canceled);
+	}
+
+	SECTION("destroy with send not yet submitted")
+	{
+		client_task.span(as_writable_bytes(payload));
+		bool done = false;
+		client.start_send(client_task.borrow(), [&] (task_ptr &&, pal::result<size_t> &&) noexcept
+		{
+			done = true;
+		});
+
+		// closed before the loop runs; the next socket takes the lowest free descriptor, i.e. client's
+		std::ignore = socket_handle{std::move(client)};
+		auto reused = pal::net::make_stream_socket(tcp::v4);
+		REQUIRE(reused);
+		REQUIRE(reused->connect(endpoint));
+		auto peer = acceptor->accept();
+		REQUIRE(peer);
+
+		// the send ran on client's socket or was cancelled, but never reaches the reused descriptor
+		run_until(loop, [&] { return done; });
+		CHECK(done);
+		CHECK(peer->available().value() == 0);
+	}
+}
+
+TEMPLATE_TEST_CASE("async/stream_socket connect", "", default_backend, io_uring_backend)
+{
+	auto loop = make_test_loop<TestType>();
+
+	// bound but not listening: nothing accepts on this endpoint
+	auto unused = pal::net::make_stream_socket(tcp::v4, pal_test::tcp_v4::loopback_endpoint());
+	REQUIRE(unused);
+	const auto endpoint = unused->local_endpoint().value();
+
+	auto socket = pal::net::make_stream_socket(tcp::v4);
+	REQUIRE(socket);
+	auto client = make_stream(loop, std::move(*socket));
+
+	task t;
+	std::error_code error{};
+	bool done = false;
+	client.start_connect(t.borrow(), endpoint, [&] (task_ptr &&, pal::result<void> &&r) noexcept
+	{
+		done = true;
+		error = r ? std::error_code{} : r.error();
+	});
+	run_until(loop, [&] { return done; });
+	REQUIRE(done);
+	CHECK(error == std::errc::connection_refused);
+}
+
+} // namespace
@@ -7,12 +7,14 @@
 
 #include <pal/async/__async.hpp>
 #include <pal/intrusive_mpsc_queue.hpp>
+#include <pal/intrusive_mpsc_stack.hpp>
 #include <pal/intrusive_queue.hpp>
 #include <pal/intrusive_stack.hpp>
 #include <pal/require.hpp>
 #include <array>
 #include <memory>
 #include <span>
+#include <utility>
 
 namespace pal::async
 {
@@ -52,6 +54,7 @@ struct layout
 	};
 	recycler *recycle;
 	std::span<std::byte> span;
+	task *chain;
 };
 
 constexpr size_t round_up (size_t n, size_t m) noexcept
@@ -149,6 +152,36 @@ public:
 		span_ = span;
 	}
 
+	/// Append \a segment, with any chain of its own, to the end of this task's payload chain: stream send
+	/// and receive gather from and scatter into each segment's window in chain order, this task's own
+	/// first, without copying; other operations use this task's window only. Like the window, adjust the
+	/// chain only at rest. Walks the chain to its end.
+	///
+	/// The chain owns its segments: a pool-managed task's drop drops them too, each back to its own owner,
+	/// while an app-managed task keeps its chain across drops, as it keeps its window (see \ref unchain).
+	void chain (task_ptr &&segment) noexcept
+	{
+		auto **tail = &chain_;
+		while (*tail != nullptr)
+		{
+			tail = &(*tail)->chain_;
+		}
+		*tail = segment.release();
+	}
+
+	/// Return the next segment of the payload chain this task heads (or is part of), or null at its end
+	[[nodiscard]] task *next_segment () const noexcept
+	{
+		return chain_;
+	}
+
+	/// Detach this task's payload chain, handing ownership of its segments back to the caller: the
+	/// returned \c task_ptr holds the first of them, chained to the rest.
+	[[nodiscard]] task_ptr unchain () noexcept
+	{
+		return task_ptr{std::exchange(chain_, nullptr)};
+	}
+
 	/// Yield an owning \c task_ptr to this app-managed task. Its recycler is null, so dropping the returned
 	/// \c task_ptr leaves the task untouched for the app to reuse.
 	[[nodiscard]] task_ptr borrow () noexcept
@@ -166,10 +199,22 @@ private:
 
 	void recycle () noexcept
 	{
-		if (recycle_ != nullptr)
+		if (recycle_ == nullptr)
 		{
-			recycle_->fn(*recycle_, *this);
+			return;
 		}
+
+		// iterative: a long chain must not recurse through each segment's own recycle
+		for (auto *segment = std::exchange(chain_, nullptr); segment != nullptr; /**/)
+		{
+			auto *next = std::exchange(segment->chain_, nullptr);
+			if (segment->recycle_ != nullptr)
+			{
+				segment->recycle_->fn(*segment->recycle_, *segment);
+			}
+			segment = next;
+		}
+		recycle_->fn(*recycle_, *this);
 	}
 
 	__async::completion<task> completion_;
@@ -186,6 +231,9 @@ private:
 	__task::recycler *const recycle_ = nullptr;
 	std::span<std::byte> span_{};
 
+	// Next segment of the payload chain (see \ref chain)
+	task *chain_ = nullptr;
+
 	// Last member so it absorbs the task's tail padding into usable space (see \ref scratch_capacity).
 	alignas(std::max_align_t) std::array<std::byte, scratch_capacity> scratch_{};
 
@@ -213,9 +261,22 @@ struct attorney
 		return task{recycle};
 	}
 
+	// Drop the bound closure of a cancelled op, unrun
+	static void unbind (task &t) noexcept
+	{
+		t.completion_.unbind();
+	}
+
 	// Kept internal: the hooks stay single-owner for the library.
 	// Apps queue their own idle tasks via task::scratch_as() instead.
 	using task_mpsc_queue = pal::intrusive_mpsc_queue<&task::mpsc_hook_>;
+	using task_mpsc_stack = pal::intrusive_mpsc_stack<&task::mpsc_hook_>;
+
+	// Successor of \a t in a chain detached by task_mpsc_stack::pop_all()
+	static task *mpsc_next (const task &t) noexcept
+	{
+		return t.mpsc_hook_.load(std::memory_order_relaxed);
+	}
 	using task_queue = pal::intrusive_queue<&task::hook_>;
 	using task_stack = pal::intrusive_stack<&task::stack_hook_>;
 };
@@ -3,6 +3,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include <array>
 #include <system_error>
+#include <tuple>
 
 namespace
 {
@@ -142,6 +143,49 @@ TEST_CASE("async/task")
 		CHECK(r.calls == 1);
 	}
 
+	SECTION("chain() appends segments in order; unchain() hands them back")
+	{
+		task head, a, b, c;
+		head.chain(a.borrow());
+		b.chain(c.borrow());
+		head.chain(b.borrow());
+		CHECK(head.next_segment() == &a);
+		CHECK(a.next_segment() == &b);
+		CHECK(b.next_segment() == &c);
+		CHECK(c.next_segment() == nullptr);
+
+		auto first = head.unchain();
+		CHECK(first.get() == &a);
+		CHECK(head.next_segment() == nullptr);
+		CHECK(a.next_segment() == &b);
+	}
+
+	SECTION("app-managed task keeps its chain across drops")
+	{
+		task head, a;
+		head.chain(a.borrow());
+		head.borrow().reset();
+		CHECK(head.next_segment() == &a);
+		std::ignore = head.unchain();
+	}
+
+	SECTION("dropping a pool-managed chain head recycles its pool-managed segments")
+	{
+		counting_recycler r;
+		task head = __task::attorney::make_pool_managed(r);
+		task a = __task::attorney::make_pool_managed(r);
+		task b = __task::attorney::make_pool_managed(r);
+		task app;
+		head.chain(task_ptr{&a});
+		head.chain(app.borrow());
+		head.chain(task_ptr{&b});
+		task_ptr{&head}.reset();
+		CHECK(r.calls == 3);
+		CHECK(head.next_segment() == nullptr);
+		CHECK(a.next_segment() == nullptr);
+		CHECK(app.next_segment() == nullptr);
+	}
+
 	SECTION("bind/complete round-trip through Op::dispatch")
 	{
 		task t;
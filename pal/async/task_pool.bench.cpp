@@ -0,0 +1,167 @@
+#include <pal/async/task_pool.hpp>
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using namespace pal::async;
+
+// Tasks cross threads as in intrusive_mpsc_queue.bench.cpp: each producer acquires from its own pool,
+// the consumer drops them back. The queue between them is the same lock-free one for both variants, so
+// only the pool differs.
+constexpr size_t pool_depth = 64;
+constexpr size_t payload_size = 64;
+
+struct lockfree
+{
+	concurrent_task_pool<pool_depth, payload_size> pool;
+
+	task_ptr acquire () noexcept
+	{
+		return pool.try_acquire();
+	}
+
+	static void drop (task_ptr &&t) noexcept
+	{
+		t.reset();
+	}
+};
+
+struct locked
+{
+	task_pool<pool_depth, payload_size> pool;
+	std::mutex pool_mutex;
+
+	task_ptr acquire () noexcept
+	{
+		const std::scoped_lock lock{pool_mutex};
+		return pool.try_acquire();
+	}
+
+	static void drop (task_ptr &&t) noexcept
+	{
+		auto *owner = t->scratch_as<locked *>();
+		const std::scoped_lock lock{owner->pool_mutex};
+		t.reset();
+	}
+};
+
+template <typename Impl>
+struct producer
+{
+	Impl impl{};
+	std::thread thread;
+};
+
+template <typename Impl>
+void run_bench (Catch::Benchmark::Chronometer &meter, size_t producer_count)
+{
+	__task::attorney::task_mpsc_queue queue;
+	std::vector<producer<Impl>> producers(producer_count);
+
+	constexpr size_t producer_rounds = 10'000;
+	const size_t consumer_rounds = producer_count * producer_rounds;
+
+	std::atomic<bool> running = true;
+	std::barrier start_barrier{std::ssize(producers) + 2}, end_barrier{std::ssize(producers) + 2};
+
+	// clang-format off
+
+	for (auto &producer: producers)
+	{
+		producer.thread = std::thread([&]
+		{
+			while (true)
+			{
+				start_barrier.arrive_and_wait();
+				if (!running)
+				{
+					break;
+				}
+
+				for (size_t round = 0; round < producer_rounds; /**/)
+				{
+					if (auto t = producer.impl.acquire())
+					{
+						t->template scratch_as<Impl *>() = &producer.impl;
+						queue.push(*t.release());
+						round++;
+					}
+					else
+					{
+						std::this_thread::yield();
+					}
+				}
+
+				end_barrier.arrive_and_wait();
+			}
+		});
+	}
+
+	auto consumer = std::thread([&]
+	{
+		while (true)
+		{
+			start_barrier.arrive_and_wait();
+			if (!running)
+			{
+				break;
+			}
+
+			for (size_t round = 0; round < consumer_rounds; /**/)
+			{
+				if (auto *t = queue.try_pop())
+				{
+					Impl::drop(task_ptr{t});
+					round++;
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			end_barrier.arrive_and_wait();
+		}
+	});
+
+	meter.measure([&]
+	{
+		start_barrier.arrive_and_wait();
+		end_barrier.arrive_and_wait();
+	});
+
+	// clang-format on
+
+	running = false;
+	start_barrier.arrive_and_wait();
+
+	std::ranges::for_each(producers, [] (auto &producer) { producer.thread.join(); });
+	consumer.join();
+}
+
+TEST_CASE("async/task_pool", "[!benchmark]")
+{
+	const size_t producer_count = GENERATE(1, 2, 4, 8);
+
+	BENCHMARK_ADVANCED("lock-free/" + std::to_string(producer_count))(auto meter)
+	{
+		run_bench<lockfree>(meter, producer_count);
+	};
+
+	BENCHMARK_ADVANCED("locked/" + std::to_string(producer_count))(auto meter)
+	{
+		run_bench<locked>(meter, producer_count);
+	};
+}
+
+} // namespace
@@ -0,0 +1,390 @@
+#include <pal/async/task_pool.hpp>
+#include <pal/error.hpp>
+#include <pal/require.hpp>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <system_error>
+#include <tuple>
+
+#if __pal_os_linux
+	#include <charconv>
+	#include <fstream>
+	#include <linux/mempolicy.h>
+	#include <string>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#elif __pal_os_macos
+	#include <sys/mman.h>
+	#include <unistd.h>
+#elif __pal_os_windows
+	#include <windows.h>
+#endif
+
+namespace pal::async
+{
+
+namespace __task_pool
+{
+
+namespace
+{
+
+using page_type = task_pool_config::page_type;
+
+constexpr size_t round_up (size_t n, size_t m) noexcept
+{
+	return (n + m - 1) / m * m;
+}
+
+#if __pal_os_linux || __pal_os_macos
+
+size_t page_size () noexcept
+{
+	return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+#endif
+
+#if __pal_os_linux
+
+// Default huge page size ("Hugepagesize:" in /proc/meminfo), 2 MiB if unknown
+size_t huge_page_size ()
+{
+	std::ifstream meminfo{"/proc/meminfo"};
+	for (std::string line; std::getline(meminfo, line); /**/)
+	{
+		if (line.starts_with("Hugepagesize:"))
+		{
+			const auto *first = line.data() + line.find_first_not_of(' ', 13);
+			size_t kib = 0;
+			if (std::from_chars(first, line.data() + line.size(), kib).ec == std::errc{} && kib != 0)
+			{
+				return kib * 1024;
+			}
+		}
+	}
+	return 2 * 1024 * 1024;
+}
+
+// Map \a size bytes (a multiple of \a alignment) starting on an \a alignment boundary: over-map, then
+// trim the unaligned head and the excess tail
+std::byte *map_aligned (size_t size, size_t alignment) noexcept
+{
+	auto *p = ::mmap(nullptr, size + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	auto *base = static_cast<std::byte *>(p);
+	auto *aligned = reinterpret_cast<std::byte *>(round_up(reinterpret_cast<uintptr_t>(base), alignment));
+	if (const auto head = static_cast<size_t>(aligned - base))
+	{
+		::munmap(base, head);
+	}
+	if (const auto tail = alignment - static_cast<size_t>(aligned - base))
+	{
+		::munmap(aligned + size, tail);
+	}
+	return aligned;
+}
+
+result<std::byte *> map (size_t &size, const task_pool_config &config) noexcept
+{
+	size_t huge = 0;
+	if (config.pages != page_type::normal)
+	{
+		try
+		{
+			huge = huge_page_size();
+		}
+		catch (...)
+		{
+			return make_unexpected(std::errc::not_enough_memory);
+		}
+	}
+
+	std::byte *slab = nullptr;
+	switch (config.pages)
+	{
+		case page_type::normal:
+			size = round_up(size, page_size());
+			if (auto *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); p != MAP_FAILED)
+			{
+				slab = static_cast<std::byte *>(p);
+			}
+			break;
+
+		case page_type::transparent_huge:
+			size = round_up(size, huge);
+			slab = map_aligned(size, huge);
+			if (slab != nullptr)
+			{
+				// best effort: without THP support the slab stays on default pages
+				std::ignore = ::madvise(slab, size, MADV_HUGEPAGE);
+			}
+			break;
+
+		case page_type::huge:
+			size = round_up(size, huge);
+			if (auto *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0); p != MAP_FAILED)
+			{
+				slab = static_cast<std::byte *>(p);
+			}
+			break;
+	}
+
+	if (slab == nullptr)
+	{
+		return unexpected{pal::this_thread::last_system_error()};
+	}
+
+	if (config.numa_node >= 0)
+	{
+		// pages not faulted yet: binding now places every one of them
+		constexpr size_t max_node = 1024, bits = sizeof(unsigned long) * 8;
+		if (static_cast<size_t>(config.numa_node) >= max_node)
+		{
+			::munmap(slab, size);
+			return make_unexpected(std::errc::invalid_argument);
+		}
+
+		unsigned long mask[max_node / bits]{};
+		mask[config.numa_node / bits] = 1UL << (config.numa_node % bits);
+		if (::syscall(SYS_mbind, slab, size, MPOL_BIND, mask, max_node + 1, 0) == -1)
+		{
+			const auto error = pal::this_thread::last_system_error();
+			::munmap(slab, size);
+			return unexpected{error};
+		}
+	}
+
+	if (config.lock && ::mlock(slab, size) == -1)
+	{
+		const auto error = pal::this_thread::last_system_error();
+		::munmap(slab, size);
+		return unexpected{error};
+	}
+
+	return slab;
+}
+
+void unmap (std::byte *slab, size_t size) noexcept
+{
+	::munmap(slab, size);
+}
+
+#elif __pal_os_macos
+
+result<std::byte *> map (size_t &size, const task_pool_config &config) noexcept
+{
+	if (config.pages == page_type::huge)
+	{
+		return make_unexpected(std::errc::function_not_supported);
+	}
+
+	size = round_up(size, page_size());
+	auto *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+	{
+		return unexpected{pal::this_thread::last_system_error()};
+	}
+
+	auto *slab = static_cast<std::byte *>(p);
+	if (config.lock && ::mlock(slab, size) == -1)
+	{
+		const auto error = pal::this_thread::last_system_error();
+		::munmap(slab, size);
+		return unexpected{error};
+	}
+
+	return slab;
+}
+
+void unmap (std::byte *slab, size_t size) noexcept
+{
+	::munmap(slab, size);
+}
+
+#elif __pal_os_windows
+
+result<std::byte *> map (size_t &size, const task_pool_config &config) noexcept
+{
+	DWORD type = MEM_RESERVE | MEM_COMMIT;
+	if (config.pages == page_type::huge)
+	{
+		const auto large = ::GetLargePageMinimum();
+		if (large == 0)
+		{
+			return make_unexpected(std::errc::function_not_supported);
+		}
+		size = round_up(size, large);
+		type |= MEM_LARGE_PAGES;
+	}
+	else
+	{
+		SYSTEM_INFO info;
+		::GetSystemInfo(&info);
+		size = round_up(size, info.dwAllocationGranularity);
+	}
+
+	void *p = nullptr;
+	if (config.numa_node >= 0)
+	{
+		ULONG highest = 0;
+		if (!::GetNumaHighestNodeNumber(&highest) || static_cast<ULONG>(config.numa_node) > highest)
+		{
+			return make_unexpected(std::errc::invalid_argument);
+		}
+		p = ::VirtualAllocExNuma(::GetCurrentProcess(), nullptr, size, type, PAGE_READWRITE, static_cast<DWORD>(config.numa_node));
+	}
+	else
+	{
+		p = ::VirtualAlloc(nullptr, size, type, PAGE_READWRITE);
+	}
+	if (p == nullptr)
+	{
+		return unexpected{pal::this_thread::last_system_error()};
+	}
+
+	// large pages are never paged out: locking is implied
+	auto *slab = static_cast<std::byte *>(p);
+	if (config.lock && config.pages != page_type::huge && !::VirtualLock(slab, size))
+	{
+		const auto error = pal::this_thread::last_system_error();
+		::VirtualFree(slab, 0, MEM_RELEASE);
+		return unexpected{error};
+	}
+
+	return slab;
+}
+
+void unmap (std::byte *slab, size_t) noexcept
+{
+	::VirtualFree(slab, 0, MEM_RELEASE);
+}
+
+#endif
+
+// Map one slab holding every class in \a classes, in order, each its own region. The pool's debug
+// check of its arguments is up to the caller.
+result<impl_ptr> make_impl (std::span<const task_size_class> classes, const task_pool_config &placement) noexcept
+{
+	std::unique_ptr<region[]> regions{new (std::nothrow) region[classes.size()]};
+	if (regions == nullptr)
+	{
+		return make_unexpected(std::errc::not_enough_memory);
+	}
+
+	size_t slab_size = 0;
+	for (size_t i = 0; i != classes.size(); ++i)
+	{
+		// slots start on cache lines, as task_pool's; the payload follows its task
+		const auto [buffer_size, tasks] = classes[i];
+		const auto slot_size = round_up(sizeof(task) + buffer_size, cache_line_size);
+		if (slot_size < buffer_size || tasks > ((std::numeric_limits<size_t>::max)() - slab_size) / slot_size)
+		{
+			return make_unexpected(std::errc::not_enough_memory);
+		}
+
+		auto &r = regions[i];
+		r.slot_size = slot_size;
+		r.buffer_size = buffer_size;
+		r.task_count = tasks;
+		slab_size += tasks * slot_size;
+	}
+
+	auto slab = map(slab_size, placement);
+	if (!slab)
+	{
+		return unexpected{slab.error()};
+	}
+
+	auto *base = *slab;
+	for (size_t i = 0; i != classes.size(); ++i)
+	{
+		regions[i].base = base;
+		base += regions[i].task_count * regions[i].slot_size;
+	}
+
+	auto *impl = new (std::nothrow) impl_type{*slab, slab_size, std::move(regions), classes.size()};
+	if (impl == nullptr)
+	{
+		unmap(*slab, slab_size);
+		return make_unexpected(std::errc::not_enough_memory);
+	}
+
+	return impl_ptr{impl};
+}
+
+} // namespace
+
+void deleter::operator() (impl_type *impl) const noexcept
+{
+	for (size_t i = 0; i != impl->region_count; ++i)
+	{
+		auto &r = impl->regions[i];
+		auto at_rest = size_t{0};
+		while (auto *t = r.freelist.try_pop())
+		{
+			t->~task();
+			++at_rest;
+		}
+		pal_require(at_rest == r.carved, "task pool destroyed with tasks in flight");
+	}
+
+	unmap(impl->slab, impl->slab_size);
+	delete impl;
+}
+
+} // namespace __task_pool
+
+result<mapped_task_pool> make_task_pool (const task_pool_config &config) noexcept
+{
+	pal_require(config.tasks > 0, "mapped_task_pool without tasks");
+	pal_require(config.buffer_size > 0, "mapped_task_pool without payload storage");
+
+	const task_size_class single{.buffer_size = config.buffer_size, .tasks = config.tasks};
+	return __task_pool::make_impl({&single, 1}, config).transform([] (auto &&impl)
+	{
+		return mapped_task_pool{std::move(impl)};
+	});
+}
+
+result<size_class_task_pool> make_task_pool (const size_class_task_pool_config &config) noexcept
+{
+	constexpr size_t max_class = ((std::numeric_limits<size_t>::max)() >> 1) + 1;
+	constexpr size_t max_classes = std::numeric_limits<size_t>::digits;
+	if (config.classes.empty() || config.classes.size() > max_classes)
+	{
+		return make_unexpected(std::errc::invalid_argument);
+	}
+
+	std::array<task_size_class, max_classes> classes{};
+	for (size_t i = 0; i != config.classes.size(); ++i)
+	{
+		const auto [buffer_size, tasks] = config.classes[i];
+		if (buffer_size == 0 || buffer_size > max_class || tasks == 0)
+		{
+			return make_unexpected(std::errc::invalid_argument);
+		}
+
+		classes[i] = {.buffer_size = std::bit_ceil(buffer_size), .tasks = tasks};
+		if (i > 0 && classes[i].buffer_size <= classes[i - 1].buffer_size)
+		{
+			return make_unexpected(std::errc::invalid_argument);
+		}
+	}
+
+	const task_pool_config placement{.pages = config.pages, .numa_node = config.numa_node, .lock = config.lock};
+	return __task_pool::make_impl(std::span{classes}.first(config.classes.size()), placement).transform([] (auto &&impl)
+	{
+		return size_class_task_pool{std::move(impl)};
+	});
+}
+
+} // namespace pal::async
@@ -2,17 +2,225 @@
 
 /**
  * \file pal/async/task_pool.hpp
- * Fixed-size pool of tasks with attached payload storage
+ * Pools of tasks with attached payload storage
  */
 
 #include <pal/async/task.hpp>
 #include <pal/require.hpp>
+#include <pal/result.hpp>
 #include <array>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <span>
 #include <utility>
 
 namespace pal::async
 {
 
+namespace __task_pool
+{
+
+// Pool slot: a task and its payload buffer, the task's window reset to the whole buffer on recycle
+template <size_t BufferSize>
+struct alignas(cache_line_size) slot
+{
+	task t;
+	std::byte buffer[BufferSize];
+
+	explicit slot (__task::recycler &recycle) noexcept
+		: t{__task::attorney::make_pool_managed(recycle)}
+	{
+		t.span(buffer);
+	}
+
+	// Recover the slot from its task address, resetting the payload window
+	static task &reset (task &t) noexcept
+	{
+		auto &s = *reinterpret_cast<slot *>(&t);
+		t.span(s.buffer);
+		return t;
+	}
+};
+
+/// Slots of one payload size within a mapped slab, carved in address order on first use; its tasks
+/// recycle onto its own freelist.
+struct region: __task::recycler
+{
+	std::byte *base = nullptr;
+	size_t slot_size = 0;
+	size_t buffer_size = 0;
+	size_t task_count = 0;
+	size_t carved = 0;
+
+	// occupancy, see task_size_class_stats
+	size_t in_use = 0;
+	size_t peak_in_use = 0;
+	size_t exhausted = 0;
+
+	__task::attorney::task_stack freelist{};
+
+	region () noexcept
+		: __task::recycler{recycle}
+	{
+	}
+
+	region (const region &) = delete;
+	region &operator= (const region &) = delete;
+
+	std::span<std::byte> buffer_of (task &t) const noexcept
+	{
+		return {reinterpret_cast<std::byte *>(&t) + sizeof(task), buffer_size};
+	}
+
+	task_ptr try_acquire () noexcept
+	{
+		auto *t = freelist.try_pop();
+		if (t == nullptr)
+		{
+			if (carved == task_count)
+			{
+				++exhausted;
+				return {};
+			}
+
+			// untouched slots stay unfaulted until the freelist runs dry
+			t = new (base + carved++ * slot_size) task{__task::attorney::make_pool_managed(*this)};
+			t->span(buffer_of(*t));
+		}
+
+		if (++in_use > peak_in_use)
+		{
+			peak_in_use = in_use;
+		}
+		return task_ptr{t};
+	}
+
+	static void recycle (__task::recycler &recycle, task &t) noexcept
+	{
+		auto &self = static_cast<region &>(recycle);
+		t.span(self.buffer_of(t));
+		self.freelist.push(t);
+		--self.in_use;
+	}
+};
+
+/// Backing of the mapped pools: the slab and its regions, heap-allocated so tasks' recyclers stay put
+/// when the pool object moves.
+struct impl_type
+{
+	std::byte *slab;
+	size_t slab_size;
+	std::unique_ptr<region[]> regions;
+	size_t region_count;
+};
+
+struct deleter
+{
+	void operator() (impl_type *) const noexcept;
+};
+
+using impl_ptr = std::unique_ptr<impl_type, deleter>;
+
+} // namespace __task_pool
+
+class mapped_task_pool;
+
+/// Sizing and memory placement of a \ref mapped_task_pool.
+struct task_pool_config
+{
+	/// Tasks in the pool; at least one (zero is a precondition violation).
+	size_t tasks = 1;
+
+	/// Payload bytes attached to each task; at least one (zero is a precondition violation). The default
+	/// keeps each slot at 2 KiB, as \ref task_pool's.
+	size_t buffer_size = 2048 - sizeof(task);
+
+	/// Pages backing the pool's slab.
+	enum class page_type
+	{
+		/// Default pages.
+		normal,
+
+		/// Transparent huge pages where the platform has them (Linux: the slab is huge page aligned and
+		/// advised MADV_HUGEPAGE). Best effort: the kernel falls back to default pages where it finds no
+		/// huge page, and other platforms always do.
+		transparent_huge,
+
+		/// Explicit huge pages: on Linux MAP_HUGETLB, drawn from the pages reserved up front
+		/// (vm.nr_hugepages); on Windows large pages, needing SeLockMemoryPrivilege. Too few reserved
+		/// pages or no privilege fails make_task_pool; elsewhere \c std::errc::function_not_supported.
+		huge,
+	};
+	page_type pages = page_type::transparent_huge;
+
+	/// Bind the slab to this NUMA node's memory (no such node: \c std::errc::invalid_argument); -1 binds
+	/// none. Ignored on macOS.
+	int numa_node = -1;
+
+	/// Lock the slab into memory: faulted in by make_task_pool and never swapped out. Beyond the
+	/// process' locked memory limit (RLIMIT_MEMLOCK), fails make_task_pool.
+	bool lock = false;
+};
+
+/// Create a pool of \a config.tasks tasks, each with \a config.buffer_size payload bytes, in memory
+/// placed per \a config. Errors: memory resource exhaustion, or the placement being unavailable (see
+/// \ref task_pool_config).
+result<mapped_task_pool> make_task_pool (const task_pool_config &config) noexcept;
+
+class size_class_task_pool;
+
+/// One payload size class of a \ref size_class_task_pool.
+struct task_size_class
+{
+	/// Payload bytes attached to each task of the class, rounded up to a power of two.
+	size_t buffer_size;
+
+	/// Tasks in the class.
+	size_t tasks;
+};
+
+/// Size classes and memory placement of a \ref size_class_task_pool.
+struct size_class_task_pool_config
+{
+	/// Classes in increasing buffer size, distinct after rounding, each with at least one task and one
+	/// payload byte; at least one class. Otherwise make_task_pool fails with
+	/// \c std::errc::invalid_argument.
+	std::span<const task_size_class> classes{};
+
+	/// As \ref task_pool_config::pages, for the one slab holding every class.
+	task_pool_config::page_type pages = task_pool_config::page_type::transparent_huge;
+
+	/// As \ref task_pool_config::numa_node.
+	int numa_node = -1;
+
+	/// As \ref task_pool_config::lock.
+	bool lock = false;
+};
+
+/// Occupancy of one class of a \ref size_class_task_pool.
+struct task_size_class_stats
+{
+	/// Payload bytes attached to each task of the class
+	size_t buffer_size = 0;
+
+	/// Tasks in the class
+	size_t tasks = 0;
+
+	/// Tasks currently acquired
+	size_t in_use = 0;
+
+	/// Most tasks acquired at once since the pool was made
+	size_t peak_in_use = 0;
+
+	/// Acquires that found every task of the class in flight
+	size_t exhausted = 0;
+};
+
+/// Create a pool of tasks in the size classes of \a config, in memory placed per \a config. Errors: as
+/// make_task_pool(const task_pool_config &), or \c std::errc::invalid_argument for malformed classes.
+result<size_class_task_pool> make_task_pool (const size_class_task_pool_config &config) noexcept;
+
 /// Fixed-size pool of \a TaskCount reusable \ref task, each with \a BufferSize bytes of payload
 /// storage attached as its \ref task::span. The default implementation of the app side of the task
 /// lifecycle: single-shot operations take app-managed tasks, and this class owns their storage and
@@ -28,7 +236,8 @@ namespace pal::async
 /// stack. The default \a BufferSize keeps each slot at a power-of-two 2 KiB.
 ///
 /// \note Not thread-safe: acquire and drop tasks on one thread at a time (operations complete on
-/// the loop thread, so drops land there naturally).
+/// the loop thread, so drops land there naturally). For tasks dropped on other threads see
+/// \ref concurrent_task_pool, for capacity chosen at runtime \ref mapped_task_pool.
 template <size_t TaskCount, size_t BufferSize = 2048 - sizeof(task)>
 class task_pool: private __task::recycler
 {
@@ -71,17 +280,7 @@ public:
 
 private:
 
-	struct alignas(cache_line_size) slot
-	{
-		task t;
-		std::byte buffer[BufferSize];
-
-		explicit slot (__task::recycler &recycle) noexcept
-			: t{__task::attorney::make_pool_managed(recycle)}
-		{
-			t.span(buffer);
-		}
-	};
+	using slot = __task_pool::slot<BufferSize>;
 
 	// recycle() recovers the slot from the task address
 	static_assert(std::is_standard_layout_v<slot>);
@@ -100,13 +299,225 @@ private:
 	static void recycle (__task::recycler &recycle, task &t) noexcept
 	{
 		auto &self = static_cast<task_pool &>(recycle);
-		auto &s = *reinterpret_cast<slot *>(&t);
-		t.span(s.buffer);
-		self.freelist_.push(t);
+		self.freelist_.push(slot::reset(t));
 	}
 
 	std::array<slot, TaskCount> storage_;
 	__task::attorney::task_stack freelist_{};
 };
 
+/// Thread-safe variant of \ref task_pool for tasks that finish away from the thread acquiring them
+/// (offloaded to a \ref thread_pool, handed to another loop): acquire on one owner thread, drop on
+/// any thread.
+///
+/// Drops push onto a lock-free MPSC stack, one CAS each with no locks. The owner takes returned tasks
+/// in batches: when its private cache runs dry, \ref try_acquire detaches everything returned so far
+/// with a single exchange and then hands them out without further atomics, so the owner's cost per
+/// task stays flat however many threads drop. Reuse is LIFO within a batch.
+///
+/// Sizing and storage are as in \ref task_pool.
+///
+/// \note \ref try_acquire is owner-thread only (one thread at a time); dropping the acquired
+/// \ref task_ptr is safe from any thread. Destruction needs all tasks returned, with the drops
+/// happening-before it.
+template <size_t TaskCount, size_t BufferSize = 2048 - sizeof(task)>
+class concurrent_task_pool: private __task::recycler
+{
+public:
+
+	static_assert(TaskCount > 0, "concurrent_task_pool without tasks");
+	static_assert(BufferSize > 0, "concurrent_task_pool without payload storage");
+
+	concurrent_task_pool () noexcept
+		: concurrent_task_pool{std::make_index_sequence<TaskCount>{}}
+	{
+	}
+
+	/// All tasks must be at rest (no acquired \ref task_ptr outstanding).
+	~concurrent_task_pool () noexcept
+	{
+		if constexpr (build == build_type::debug)
+		{
+			auto at_rest = size_t{0};
+			for (auto *batch: {cache_, returned_.pop_all()})
+			{
+				for (auto *t = batch; t != nullptr; t = __task::attorney::mpsc_next(*t))
+				{
+					++at_rest;
+				}
+			}
+			pal_require(at_rest == TaskCount, "concurrent_task_pool destroyed with tasks in flight");
+		}
+	}
+
+	concurrent_task_pool (const concurrent_task_pool &) = delete;
+	concurrent_task_pool &operator= (const concurrent_task_pool &) = delete;
+	concurrent_task_pool (concurrent_task_pool &&) = delete;
+	concurrent_task_pool &operator= (concurrent_task_pool &&) = delete;
+
+	/// Acquire a task from the pool, or an empty \ref task_ptr when all tasks are in flight
+	/// (expected steady-state condition, not an error). The task's payload window spans its full
+	/// buffer; dropping the returned \ref task_ptr, on any thread, recycles the task back into this
+	/// pool. Owner thread only.
+	[[nodiscard]] task_ptr try_acquire () noexcept
+	{
+		if (cache_ == nullptr)
+		{
+			cache_ = returned_.pop_all();
+			if (cache_ == nullptr)
+			{
+				return {};
+			}
+		}
+		auto *t = cache_;
+		cache_ = __task::attorney::mpsc_next(*t);
+		return task_ptr{t};
+	}
+
+private:
+
+	using slot = __task_pool::slot<BufferSize>;
+
+	// recycle() recovers the slot from the task address
+	static_assert(std::is_standard_layout_v<slot>);
+
+	template <size_t... I>
+	explicit concurrent_task_pool (std::index_sequence<I...>) noexcept
+		: __task::recycler{recycle}
+		, storage_{{(static_cast<void>(I), slot{*this})...}}
+	{
+		for (auto &s: storage_)
+		{
+			returned_.push(s.t);
+		}
+	}
+
+	static void recycle (__task::recycler &recycle, task &t) noexcept
+	{
+		auto &self = static_cast<concurrent_task_pool &>(recycle);
+		self.returned_.push(slot::reset(t));
+	}
+
+	std::array<slot, TaskCount> storage_;
+
+	// Owner-private batch being handed out, chained through the tasks' MPSC hooks
+	task *cache_ = nullptr;
+
+	// Written by every dropping thread: kept off the owner's cache line
+	alignas(cache_line_size) __task::attorney::task_mpsc_stack returned_{};
+};
+
+/// Runtime-sized counterpart of \ref task_pool, for capacity read from configuration and for pools too
+/// large for static storage: its slots live in one slab mapped directly from the OS, optionally on huge
+/// pages (a million 2 KiB slots on 4 KiB pages would otherwise thrash the TLB), bound to a NUMA node and
+/// locked in memory. Made by \ref make_task_pool.
+///
+/// Hands out tasks exactly as \ref task_pool does: \ref try_acquire yields an owning \ref task_ptr whose
+/// drop returns the task with its payload window reset to the slot's full buffer, and reuse is LIFO.
+/// Slots are carved from the slab in address order on first use only, so pages no task has reached stay
+/// unfaulted (unless locked).
+///
+/// Movable: tasks refer to the pool's heap-allocated backing, not to this object. Destruction requires
+/// all tasks at rest (debug REQUIRE) and unmaps the slab.
+///
+/// \note Not thread-safe: acquire and drop tasks on one thread at a time.
+class mapped_task_pool
+{
+public:
+
+	mapped_task_pool (mapped_task_pool &&) noexcept = default;
+	mapped_task_pool &operator= (mapped_task_pool &&) noexcept = default;
+	~mapped_task_pool () noexcept = default;
+
+	/// Acquire a task from the pool, or an empty \ref task_ptr when all tasks are in flight
+	/// (expected steady-state condition, not an error). The task's payload window spans its full
+	/// buffer; dropping the returned \ref task_ptr recycles the task back into this pool.
+	[[nodiscard]] task_ptr try_acquire () noexcept
+	{
+		return impl_->regions[0].try_acquire();
+	}
+
+private:
+
+	__task_pool::impl_ptr impl_;
+
+	explicit mapped_task_pool (__task_pool::impl_ptr impl) noexcept
+		: impl_{std::move(impl)}
+	{
+	}
+
+	friend result<mapped_task_pool> make_task_pool (const task_pool_config &) noexcept;
+};
+
+/// Pool of tasks in power-of-two payload size classes, for traffic mixing small and large messages (say
+/// 64 byte control messages next to 16 KiB TLS records) without sizing every slot for the largest or
+/// keeping a pool per size by hand. Made by \ref make_task_pool.
+///
+/// \ref try_acquire hands out a task of the smallest class whose buffers hold the requested size, its
+/// payload window spanning that class' full buffer. Each class keeps its own LIFO freelist, and a dropped
+/// task returns to its own class with its window reset. An exhausted class does not borrow from larger
+/// ones, which would let small messages starve large ones: \ref stats reports each class' occupancy to
+/// size them by instead.
+///
+/// All classes share one slab, mapped, carved, moved and destroyed as \ref mapped_task_pool's.
+///
+/// \note Not thread-safe: acquire and drop tasks on one thread at a time.
+class size_class_task_pool
+{
+public:
+
+	size_class_task_pool (size_class_task_pool &&) noexcept = default;
+	size_class_task_pool &operator= (size_class_task_pool &&) noexcept = default;
+	~size_class_task_pool () noexcept = default;
+
+	/// Acquire a task with at least \a min_size payload bytes from the smallest class holding them, or an
+	/// empty \ref task_ptr when that class has all its tasks in flight (expected steady-state condition,
+	/// not an error) or no class is large enough. Dropping the returned \ref task_ptr recycles the task
+	/// back into its class.
+	[[nodiscard]] task_ptr try_acquire (size_t min_size) noexcept
+	{
+		// few classes: a scan in size order beats anything cleverer
+		for (size_t i = 0; i != impl_->region_count; ++i)
+		{
+			if (auto &r = impl_->regions[i]; r.buffer_size >= min_size)
+			{
+				return r.try_acquire();
+			}
+		}
+		return {};
+	}
+
+	/// Return the number of size classes
+	[[nodiscard]] size_t size_classes () const noexcept
+	{
+		return impl_->region_count;
+	}
+
+	/// Return the occupancy of class \a size_class, numbered in increasing buffer size (out of range is a
+	/// precondition violation)
+	[[nodiscard]] task_size_class_stats stats (size_t size_class) const noexcept
+	{
+		pal_require(size_class < impl_->region_count, "size class out of range");
+		const auto &r = impl_->regions[size_class];
+		return {
+			.buffer_size = r.buffer_size,
+			.tasks = r.task_count,
+			.in_use = r.in_use,
+			.peak_in_use = r.peak_in_use,
+			.exhausted = r.exhausted,
+		};
+	}
+
+private:
+
+	__task_pool::impl_ptr impl_;
+
+	explicit size_class_task_pool (__task_pool::impl_ptr impl) noexcept
+		: impl_{std::move(impl)}
+	{
+	}
+
+	friend result<size_class_task_pool> make_task_pool (const size_class_task_pool_config &) noexcept;
+};
+
 } // namespace pal::async
@@ -1,9 +1,15 @@
 #include <pal/async/task_pool.hpp>
 #include <pal/test.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <set>
 #include <system_error>
+#include <thread>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace
 {
@@ -136,4 +142,419 @@ TEST_CASE("async/task_pool")
 	}
 }
 
+TEST_CASE("async/concurrent_task_pool")
+{
+	constexpr auto default_buffer_size = 2048 - sizeof(task);
+	concurrent_task_pool<2> pool;
+
+	SECTION("try_acquire() yields a task with the full default buffer attached")
+	{
+		auto t = pool.try_acquire();
+		REQUIRE(t != nullptr);
+		CHECK(t->span().size() == default_buffer_size);
+	}
+
+	SECTION("distinct tasks with distinct buffers until exhaustion, then empty")
+	{
+		auto a = pool.try_acquire();
+		auto b = pool.try_acquire();
+		REQUIRE(a != nullptr);
+		REQUIRE(b != nullptr);
+		CHECK(a.get() != b.get());
+		CHECK(a->span().data() != b->span().data());
+
+		auto c = pool.try_acquire();
+		CHECK(c == nullptr);
+
+		// recycling one makes it available again
+		a = nullptr;
+		c = pool.try_acquire();
+		CHECK(c != nullptr);
+	}
+
+	SECTION("recycle resets the payload window to the slot's full buffer")
+	{
+		auto t = pool.try_acquire();
+		auto *carrier = t.get();
+		const auto *data = t->span().data();
+
+		t->span(t->span().subspan(2, 4));
+		t = nullptr;
+
+		// the rest of the current batch goes first, then the returned carrier
+		auto other = pool.try_acquire();
+		t = pool.try_acquire();
+		REQUIRE(t.get() == carrier);
+		CHECK(t->span().data() == data);
+		CHECK(t->span().size() == default_buffer_size);
+	}
+
+	SECTION("drop on another thread")
+	{
+		auto a = pool.try_acquire();
+		auto b = pool.try_acquire();
+		auto *first = a.get(), *second = b.get();
+		REQUIRE(pool.try_acquire() == nullptr);
+
+		std::thread{[p = std::move(a)] () mutable { p = nullptr; }}.join();
+		std::thread{[p = std::move(b)] () mutable { p = nullptr; }}.join();
+
+		// returned as one batch, LIFO
+		auto c = pool.try_acquire();
+		auto d = pool.try_acquire();
+		CHECK(c.get() == second);
+		CHECK(d.get() == first);
+		CHECK(pool.try_acquire() == nullptr);
+	}
+
+	SECTION("drop inside own completion recycles back to the pool")
+	{
+		task &carrier = *pool.try_acquire().release();
+		auto other = pool.try_acquire();
+		int calls = 0;
+		// clang-format off
+		carrier.bind<op_recycle>([&calls] (task_ptr &&p) noexcept
+		{
+			++calls;
+			const auto own = std::move(p);
+		});
+		// clang-format on
+		carrier.complete({}, 0);
+		CHECK(calls == 1);
+
+		auto t = pool.try_acquire();
+		CHECK(t.get() == &carrier);
+	}
+
+	SECTION("threaded")
+	{
+		// owner acquires, consumers drop: every task cycles many times, none lost or duplicated
+		concurrent_task_pool<16, 8> shared;
+		constexpr size_t consumer_count = 2;
+		constexpr size_t consumer_rounds = 5'000;
+
+		std::array<__task::attorney::task_mpsc_queue, consumer_count> queues;
+
+		// clang-format off
+		std::vector<std::thread> consumers;
+		for (auto &queue: queues)
+		{
+			consumers.emplace_back([&queue]
+			{
+				for (size_t round = 0; round < consumer_rounds; /**/)
+				{
+					if (auto *t = queue.try_pop())
+					{
+						task_ptr{t}.reset();
+						round++;
+					}
+					else
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+		// clang-format on
+
+		for (size_t round = 0; round < consumer_count * consumer_rounds; /**/)
+		{
+			if (auto t = shared.try_acquire())
+			{
+				CHECK(t->span().size() == 8);
+				t->span(t->span().first(1));
+				queues[round % consumer_count].push(*t.release());
+				round++;
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		for (auto &consumer: consumers)
+		{
+			consumer.join();
+		}
+
+		std::set<task *> distinct;
+		std::vector<task_ptr> all;
+		while (auto t = shared.try_acquire())
+		{
+			CHECK(t->span().size() == 8);
+			distinct.insert(t.get());
+			all.push_back(std::move(t));
+		}
+		CHECK(distinct.size() == 16);
+	}
+
+	SECTION("destroying the pool with tasks in flight is a REQUIRE violation")
+	{
+		if constexpr (pal::build == pal::build_type::debug)
+		{
+			// clang-format off
+			auto msg = pal_test::require_terminate([]
+			{
+				task_ptr t;
+				concurrent_task_pool<1> inner;
+				t = inner.try_acquire();
+			});
+			// clang-format on
+			CHECK(msg.contains("in flight"));
+		}
+	}
+}
+
+TEST_CASE("async/mapped_task_pool")
+{
+	constexpr auto default_buffer_size = 2048 - sizeof(task);
+
+	SECTION("try_acquire() yields tasks with the full buffer until exhaustion, then empty")
+	{
+		auto pool = make_task_pool({.tasks = 2});
+		REQUIRE(pool);
+
+		auto a = pool->try_acquire();
+		auto b = pool->try_acquire();
+		REQUIRE(a != nullptr);
+		REQUIRE(b != nullptr);
+		CHECK(a.get() != b.get());
+		CHECK(a->span().size() == default_buffer_size);
+		CHECK(b->span().size() == default_buffer_size);
+		CHECK(a->span().data() != b->span().data());
+		CHECK(pool->try_acquire() == nullptr);
+
+		// recycling one makes it available again
+		a = nullptr;
+		CHECK(pool->try_acquire() != nullptr);
+	}
+
+	SECTION("LIFO reuse and payload window reset")
+	{
+		auto pool = make_task_pool({.tasks = 4, .buffer_size = 100});
+		REQUIRE(pool);
+
+		auto a = pool->try_acquire();
+		auto b = pool->try_acquire();
+		auto *first = a.get(), *second = b.get();
+		const auto *data = a->span().data();
+		a->span(a->span().subspan(2, 4));
+		a = nullptr;
+		b = nullptr;
+
+		auto c = pool->try_acquire();
+		auto d = pool->try_acquire();
+		CHECK(c.get() == second);
+		CHECK(d.get() == first);
+		CHECK(d->span().data() == data);
+		CHECK(d->span().size() == 100);
+	}
+
+	SECTION("slots are cache line aligned, payload within the slot")
+	{
+		auto pool = make_task_pool({.tasks = 3, .buffer_size = 1});
+		REQUIRE(pool);
+
+		std::vector<task_ptr> tasks;
+		while (auto t = pool->try_acquire())
+		{
+			CHECK(reinterpret_cast<uintptr_t>(t.get()) % pal::cache_line_size == 0);
+			CHECK(t->span().data() == reinterpret_cast<std::byte *>(t.get()) + sizeof(task));
+			tasks.push_back(std::move(t));
+		}
+		CHECK(tasks.size() == 3);
+	}
+
+	SECTION("move")
+	{
+		auto pool = make_task_pool({.tasks = 1});
+		REQUIRE(pool);
+
+		auto t = pool->try_acquire();
+		auto moved = std::move(*pool);
+		t = nullptr;
+		CHECK(moved.try_acquire() != nullptr);
+	}
+
+	SECTION("page types")
+	{
+		using page_type = task_pool_config::page_type;
+
+		for (auto pages: {page_type::normal, page_type::transparent_huge})
+		{
+			auto pool = make_task_pool({.tasks = 1024, .pages = pages});
+			REQUIRE(pool);
+			CHECK(pool->try_acquire() != nullptr);
+		}
+
+		// explicit huge pages need a reservation the host may not have
+		auto pool = make_task_pool({.tasks = 1024, .pages = page_type::huge});
+		if (pool)
+		{
+			CHECK(pool->try_acquire() != nullptr);
+		}
+		else
+		{
+			CHECK(pool.error() != std::errc{});
+		}
+	}
+
+	SECTION("lock")
+	{
+		auto pool = make_task_pool({.tasks = 16, .lock = true});
+		if (pool)
+		{
+			CHECK(pool->try_acquire() != nullptr);
+		}
+		else
+		{
+			// over RLIMIT_MEMLOCK
+			CHECK((pool.error() == std::errc::not_enough_memory || pool.error() == std::errc::operation_not_permitted));
+		}
+	}
+
+	SECTION("numa_node")
+	{
+		auto local = make_task_pool({.tasks = 16, .numa_node = 0});
+		REQUIRE(local);
+		CHECK(local->try_acquire() != nullptr);
+
+		if constexpr (pal::os == pal::os_type::linux)
+		{
+			auto pool = make_task_pool({.tasks = 16, .numa_node = 1 << 20});
+			REQUIRE_FALSE(pool);
+			CHECK(pool.error() == std::errc::invalid_argument);
+		}
+	}
+
+	SECTION("destroying the pool with tasks in flight is a REQUIRE violation")
+	{
+		if constexpr (pal::build == pal::build_type::debug)
+		{
+			// clang-format off
+			auto msg = pal_test::require_terminate([]
+			{
+				task_ptr t;
+				auto inner = make_task_pool(task_pool_config{});
+				t = inner->try_acquire();
+			});
+			// clang-format on
+			CHECK(msg.contains("in flight"));
+		}
+	}
+}
+
+TEST_CASE("async/size_class_task_pool")
+{
+	// control messages next to TLS records
+	const std::array<task_size_class, 3> classes{{
+		{.buffer_size = 64, .tasks = 2},
+		{.buffer_size = 1000, .tasks = 1},
+		{.buffer_size = 16 * 1024, .tasks = 1},
+	}};
+	auto pool = make_task_pool(size_class_task_pool_config{.classes = classes});
+	REQUIRE(pool);
+	REQUIRE(pool->size_classes() == 3);
+
+	SECTION("buffer sizes round up to powers of two")
+	{
+		CHECK(pool->stats(0).buffer_size == 64);
+		CHECK(pool->stats(1).buffer_size == 1024);
+		CHECK(pool->stats(2).buffer_size == 16 * 1024);
+		CHECK(pool->stats(0).tasks == 2);
+	}
+
+	SECTION("try_acquire(min_size) draws from the smallest class that fits")
+	{
+		auto a = pool->try_acquire(0);
+		auto b = pool->try_acquire(1000);
+		auto c = pool->try_acquire(1025);
+		REQUIRE(a != nullptr);
+		REQUIRE(b != nullptr);
+		REQUIRE(c != nullptr);
+		CHECK(a->span().size() == 64);
+		CHECK(b->span().size() == 1024);
+		CHECK(c->span().size() == 16 * 1024);
+
+		// no class large enough
+		CHECK(pool->try_acquire(16 * 1024 + 1) == nullptr);
+	}
+
+	SECTION("an exhausted class does not borrow from larger ones")
+	{
+		auto a = pool->try_acquire(64);
+		auto b = pool->try_acquire(64);
+		REQUIRE(a != nullptr);
+		REQUIRE(b != nullptr);
+		CHECK(pool->try_acquire(64) == nullptr);
+		CHECK(pool->stats(0).exhausted == 1);
+		CHECK(pool->stats(1).in_use == 0);
+
+		a = nullptr;
+		CHECK(pool->try_acquire(64) != nullptr);
+	}
+
+	SECTION("per-class LIFO reuse and payload window reset")
+	{
+		auto a = pool->try_acquire(1);
+		auto b = pool->try_acquire(1);
+		auto *first = a.get(), *second = b.get();
+		a->span(a->span().first(1));
+		a = nullptr;
+		b = nullptr;
+
+		auto large = pool->try_acquire(2048);
+		auto c = pool->try_acquire(1);
+		auto d = pool->try_acquire(1);
+		CHECK(c.get() == second);
+		CHECK(d.get() == first);
+		CHECK(d->span().size() == 64);
+	}
+
+	SECTION("stats")
+	{
+		{
+			auto a = pool->try_acquire(64);
+			auto b = pool->try_acquire(64);
+			auto c = pool->try_acquire(1024);
+
+			const auto small = pool->stats(0);
+			CHECK(small.in_use == 2);
+			CHECK(small.peak_in_use == 2);
+			CHECK(pool->stats(1).in_use == 1);
+			CHECK(pool->stats(2).in_use == 0);
+		}
+
+		const auto small = pool->stats(0);
+		CHECK(small.in_use == 0);
+		CHECK(small.peak_in_use == 2);
+		CHECK(small.exhausted == 0);
+	}
+
+	SECTION("malformed classes")
+	{
+		const auto make = [] (std::initializer_list<task_size_class> list)
+		{
+			return make_task_pool(size_class_task_pool_config{.classes = {list.begin(), list.size()}});
+		};
+
+		CHECK(make({}).error() == std::errc::invalid_argument);
+		CHECK(make({{.buffer_size = 0, .tasks = 1}}).error() == std::errc::invalid_argument);
+		CHECK(make({{.buffer_size = 64, .tasks = 0}}).error() == std::errc::invalid_argument);
+
+		// not increasing, or equal once rounded
+		CHECK(make({{.buffer_size = 128, .tasks = 1}, {.buffer_size = 64, .tasks = 1}}).error() == std::errc::invalid_argument);
+		CHECK(make({{.buffer_size = 100, .tasks = 1}, {.buffer_size = 128, .tasks = 1}}).error() == std::errc::invalid_argument);
+	}
+
+	SECTION("stats() out of range is a REQUIRE violation")
+	{
+		if constexpr (pal::build == pal::build_type::debug)
+		{
+			auto msg = pal_test::require_terminate([&] { std::ignore = pool->stats(3); });
+			CHECK(msg.contains("out of range"));
+		}
+	}
+}
+
 } // namespace
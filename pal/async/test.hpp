@@ -0,0 +1,63 @@
+#pragma once
+
+/**
+ * \file pal/async/test.hpp
+ * Test fixtures and utilities for pal::async tests
+ */
+
+#include <pal/async/event_loop.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <system_error>
+#include <utility>
+
+namespace pal_test
+{
+
+//
+// Backend fixture types: TEMPLATE_TEST_CASE parameters for suites run on each event loop backend
+//
+
+struct default_backend
+{
+	static auto make (const pal::async::event_loop_config &config = {}) noexcept
+	{
+		return pal::async::make_loop(config);
+	}
+};
+
+struct io_uring_backend
+{
+	static auto make (const pal::async::event_loop_config &config = {}) noexcept
+	{
+		return pal::async::make_io_uring_loop(config);
+	}
+};
+
+/// Create a \a Backend loop with \a config, skipping the test where the backend is unavailable: not
+/// built for this platform, or refused by the host (io_uring disabled by sysctl or seccomp policy)
+template <typename Backend>
+pal::async::event_loop make_test_loop (const pal::async::event_loop_config &config = {})
+{
+	auto loop = Backend::make(config);
+	if (!loop
+		&& (loop.error() == std::errc::function_not_supported || loop.error() == std::errc::operation_not_permitted))
+	{
+		SKIP("backend not available");
+	}
+	REQUIRE(loop);
+	return std::move(*loop);
+}
+
+/// Run \a loop until \a done or a generous deadline
+template <typename Predicate>
+void run_until (pal::async::event_loop &loop, Predicate done)
+{
+	using namespace std::chrono_literals;
+	for (auto i = 0; i < 200 && !done(); ++i)
+	{
+		REQUIRE(loop.run_for(10ms));
+	}
+}
+
+} // namespace pal_test
@@ -0,0 +1,154 @@
+#include <pal/async/thread_pool.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace
+{
+
+using namespace pal::async;
+using namespace std::chrono_literals;
+
+using scheduler_type = thread_pool_config::scheduler_type;
+
+// A few hundred nanoseconds of CPU-bound work (signature check, compression block, ...), its result
+// stored in scratch so it is not optimized away
+void spin (task &t) noexcept
+{
+	uint64_t x = reinterpret_cast<uintptr_t>(&t) | 1;
+	for (auto i = 0; i < 256; ++i)
+	{
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+	}
+	t.scratch_as<uint64_t>() = x;
+}
+
+// \a task_count tasks per sample, each completing back on the loop, which the bench thread drives.
+// Either the loop thread posts them all (injection), or each task's work posts its two children in a
+// binary tree (fan-out from the workers, where stealing spreads them).
+struct offload
+{
+	event_loop loop;
+	thread_pool pool;
+	std::unique_ptr<task[]> tasks;
+	size_t task_count;
+	size_t done = 0;
+
+	struct work
+	{
+		offload *self;
+		size_t index;
+
+		void operator() (task &t) const noexcept
+		{
+			spin(t);
+			for (auto child: {2 * index + 1, 2 * index + 2})
+			{
+				if (child < self->task_count)
+				{
+					self->post(child, work{self, child});
+				}
+			}
+		}
+	};
+
+	struct complete
+	{
+		offload *self;
+
+		void operator() (task_ptr &&) const noexcept
+		{
+			++self->done;
+		}
+	};
+
+	offload (scheduler_type scheduler, size_t threads, size_t task_count)
+		: loop{make_loop().value()}
+		, pool{make_thread_pool({.threads = threads, .scheduler = scheduler}).value()}
+		, tasks{new task[task_count]}
+		, task_count{task_count}
+	{
+	}
+
+	template <typename Work>
+	void post (size_t index, Work w) noexcept
+	{
+		pool.post(loop, tasks[index].borrow(), w, complete{this});
+	}
+
+	void drain ()
+	{
+		while (done < task_count)
+		{
+			REQUIRE(loop.run_for(1s));
+		}
+		done = 0;
+	}
+
+	void inject (Catch::Benchmark::Chronometer &meter)
+	{
+		// clang-format off
+		meter.measure([this]
+		{
+			for (size_t i = 0; i < task_count; ++i)
+			{
+				post(i, [] (task &t) noexcept { spin(t); });
+			}
+			drain();
+		});
+		// clang-format on
+	}
+
+	void fan_out (Catch::Benchmark::Chronometer &meter)
+	{
+		// clang-format off
+		meter.measure([this]
+		{
+			post(0, work{this, 0});
+			drain();
+		});
+		// clang-format on
+	}
+};
+
+std::string to_string (scheduler_type scheduler)
+{
+	switch (scheduler)
+	{
+		case scheduler_type::shared_queue:
+			return "shared_queue";
+		case scheduler_type::work_stealing:
+			return "work_stealing";
+	}
+	return "?";
+}
+
+TEST_CASE("async/thread_pool", "[!benchmark]")
+{
+	constexpr size_t task_count = 10'000;
+	const size_t threads = GENERATE(1, 2, 4, 8, 16, 32);
+	const auto suffix = "/" + std::to_string(threads);
+
+	for (auto scheduler: {scheduler_type::shared_queue, scheduler_type::work_stealing})
+	{
+		offload bench{scheduler, threads, task_count};
+
+		BENCHMARK_ADVANCED("inject/" + to_string(scheduler) + suffix)(auto meter)
+		{
+			bench.inject(meter);
+		};
+
+		BENCHMARK_ADVANCED("fan_out/" + to_string(scheduler) + suffix)(auto meter)
+		{
+			bench.fan_out(meter);
+		};
+	}
+}
+
+} // namespace
@@ -1,39 +1,404 @@
 #include <pal/async/thread_pool.hpp>
+#include <pal/error.hpp>
 #include <pal/require.hpp>
-#include <condition_variable>
-#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
 #include <new>
+#include <random>
+#include <string>
 #include <system_error>
 #include <thread>
 #include <vector>
 
+#if __pal_os_linux
+	#include <charconv>
+	#include <fstream>
+	#include <pthread.h>
+	#include <sched.h>
+#elif __pal_os_macos
+	#include <pthread.h>
+#elif __pal_os_windows
+	#include <windows.h>
+#endif
+
 namespace pal::async
 {
 
 namespace __thread_pool
 {
 
+namespace
+{
+
+// Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli: "Correct and Efficient Work-Stealing
+// for Weak Memory Models"), bounded: slots are allocated once, with the pool. The owner pushes and pops
+// at the bottom, thieves steal from the top.
+class deque
+{
+public:
+
+	explicit deque (size_t capacity)
+		: mask_{capacity - 1}
+		, slots_{new std::atomic<task *>[capacity]}
+	{
+	}
+
+	// Owner only. False if full.
+	bool push (task &t) noexcept
+	{
+		const auto b = bottom_.load(std::memory_order_relaxed);
+		const auto top = top_.load(std::memory_order_acquire);
+		if (b - top > static_cast<int64_t>(mask_))
+		{
+			return false;
+		}
+		slots_[b & mask_].store(&t, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom_.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Owner only: newest first
+	task *pop () noexcept
+	{
+		const auto b = bottom_.load(std::memory_order_relaxed) - 1;
+		bottom_.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto top = top_.load(std::memory_order_relaxed);
+
+		if (top > b)
+		{
+			bottom_.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		auto *t = slots_[b & mask_].load(std::memory_order_relaxed);
+		if (top == b)
+		{
+			// last one: race the thieves for it
+			if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				t = nullptr;
+			}
+			bottom_.store(b + 1, std::memory_order_relaxed);
+		}
+		return t;
+	}
+
+	// Any thread: oldest first. Null if empty or lost a race.
+	task *steal () noexcept
+	{
+		auto top = top_.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const auto b = bottom_.load(std::memory_order_acquire);
+		if (top >= b)
+		{
+			return nullptr;
+		}
+
+		auto *t = slots_[top & mask_].load(std::memory_order_relaxed);
+		if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return nullptr;
+		}
+		return t;
+	}
+
+	[[nodiscard]] bool empty () const noexcept
+	{
+		return bottom_.load(std::memory_order_acquire) <= top_.load(std::memory_order_acquire);
+	}
+
+private:
+
+	alignas(cache_line_size) std::atomic<int64_t> top_{0};
+	alignas(cache_line_size) std::atomic<int64_t> bottom_{0};
+	const size_t mask_;
+	const std::unique_ptr<std::atomic<task *>[]> slots_;
+};
+
+// Injected tasks a work-stealing worker moves to its own deque per consuming turn, for others to steal
+constexpr size_t injection_batch = 16;
+
+// Injection queue: producers push lock-free, workers take turns consuming (consuming is the turn).
+// The queue's empty() is no emptiness test: a push racing try_pop's sentry re-insertion leaves it true
+// with the pushed task still linked. Whether work is queued is decided by pending instead: counted
+// before each push, discounted by each pop.
+struct injection
+{
+	__task::attorney::task_mpsc_queue queue{};
+	std::atomic<size_t> pending = 0;
+	std::atomic<bool> consuming = false;
+};
+
+// The pool and index of the calling worker thread, if any
+struct worker_context
+{
+	impl_type *pool = nullptr;
+	size_t index = 0;
+};
+thread_local worker_context this_worker{};
+
+// Where a worker runs: the CPUs it is bound to (empty: unbound) and their NUMA node
+struct placement
+{
+	std::vector<int> cpus{};
+	size_t node = 0;
+};
+
+#if __pal_os_linux
+
+// "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+std::vector<int> parse_cpu_list (const std::string &list)
+{
+	std::vector<int> cpus;
+	const auto *end = list.data() + list.size();
+	for (const auto *p = list.data(); p != end; /**/)
+	{
+		int first = 0, last = 0;
+		auto r = std::from_chars(p, end, first);
+		if (r.ec != std::errc{})
+		{
+			break;
+		}
+
+		last = first;
+		if (r.ptr != end && *r.ptr == '-')
+		{
+			r = std::from_chars(r.ptr + 1, end, last);
+			if (r.ec != std::errc{})
+			{
+				break;
+			}
+		}
+		for (auto cpu = first; cpu <= last; ++cpu)
+		{
+			cpus.push_back(cpu);
+		}
+
+		if (r.ptr == end || *r.ptr != ',')
+		{
+			break;
+		}
+		p = r.ptr + 1;
+	}
+	return cpus;
+}
+
+// CPUs of each NUMA node, indexed by node id (empty for ids without CPUs); empty if unknown
+std::vector<std::vector<int>> numa_nodes ()
+{
+	std::vector<std::vector<int>> nodes;
+	std::string online;
+	if (std::ifstream file{"/sys/devices/system/node/online"}; !std::getline(file, online))
+	{
+		return nodes;
+	}
+
+	for (auto node: parse_cpu_list(online))
+	{
+		std::string list;
+		std::ifstream file{"/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"};
+		std::getline(file, list);
+		nodes.resize(std::max(nodes.size(), static_cast<size_t>(node) + 1));
+		nodes[node] = parse_cpu_list(list);
+	}
+	return nodes;
+}
+
+size_t current_node () noexcept
+{
+	unsigned cpu = 0, node = 0;
+	return ::getcpu(&cpu, &node) == 0 ? node : 0;
+}
+
+#else
+
+std::vector<std::vector<int>> numa_nodes ()
+{
+	return {};
+}
+
+size_t current_node () noexcept
+{
+	return 0;
+}
+
+#endif
+
+result<void> pin (std::thread &thread, const std::vector<int> &cpus) noexcept
+{
+	if (cpus.empty())
+	{
+		return {};
+	}
+
+#if __pal_os_linux
+	::cpu_set_t set;
+	CPU_ZERO(&set);
+	for (auto cpu: cpus)
+	{
+		if (cpu < 0 || cpu >= CPU_SETSIZE)
+		{
+			return make_unexpected(std::errc::invalid_argument);
+		}
+		CPU_SET(cpu, &set);
+	}
+	if (auto e = ::pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set))
+	{
+		return unexpected{std::error_code{e, std::generic_category()}};
+	}
+#elif __pal_os_windows
+	DWORD_PTR mask = 0;
+	for (auto cpu: cpus)
+	{
+		if (cpu < 0 || cpu >= static_cast<int>(sizeof(mask) * 8))
+		{
+			return make_unexpected(std::errc::invalid_argument);
+		}
+		mask |= DWORD_PTR{1} << cpu;
+	}
+	if (::SetThreadAffinityMask(thread.native_handle(), mask) == 0)
+	{
+		return unexpected{pal::this_thread::last_system_error()};
+	}
+#else
+	(void)thread;
+#endif
+
+	return {};
+}
+
+result<void> set_priority (std::thread &thread, int priority) noexcept
+{
+	if (priority <= 0)
+	{
+		return {};
+	}
+
+#if __pal_os_windows
+	if (!::SetThreadPriority(thread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL))
+	{
+		return unexpected{pal::this_thread::last_system_error()};
+	}
+#else
+	::sched_param param{};
+	param.sched_priority = priority;
+	if (auto e = ::pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param))
+	{
+		return unexpected{std::error_code{e, std::generic_category()}};
+	}
+#endif
+
+	return {};
+}
+
+// Name the calling thread "<prefix>/<index>", truncated to the platform's limit. Best effort: a thread
+// name is cosmetic.
+void set_name (const std::string &prefix, size_t index) noexcept
+{
+	if (prefix.empty())
+	{
+		return;
+	}
+
+	char name[pal::os == pal::os_type::linux ? 16 : 64];
+	std::snprintf(name, sizeof(name), "%s/%zu", prefix.c_str(), index);
+
+#if __pal_os_linux
+	std::ignore = ::pthread_setname_np(::pthread_self(), name);
+#elif __pal_os_macos
+	std::ignore = ::pthread_setname_np(name);
+#elif __pal_os_windows
+	wchar_t wide[sizeof(name)];
+	for (size_t i = 0; i != sizeof(name); ++i)
+	{
+		wide[i] = static_cast<unsigned char>(name[i]);
+	}
+	std::ignore = ::SetThreadDescription(::GetCurrentThread(), wide);
+#endif
+}
+
+} // namespace
+
 struct impl_type
 {
-	std::mutex mutex{};
-	std::condition_variable pending{};
-	__task::attorney::task_queue queue{};
+	// One injection queue, or with numa_local one per NUMA node with workers, picked by the posting
+	// thread's node (node_injection, indexed by node id)
+	std::vector<std::unique_ptr<injection>> injections{};
+	std::vector<size_t> node_injection{};
+
+	// Eventcount parking: idle workers wait on epoch while parked is non-zero, notify() bumps it
+	std::atomic<uint32_t> epoch = 0;
+	std::atomic<uint32_t> parked = 0;
+	std::atomic<bool> stop = false;
+
 	std::vector<std::thread> workers{};
-	bool stop = false;
+
+	// per worker: its injection queue, taken from first
+	std::vector<size_t> home{};
+
+	// work_stealing: one deque per worker
+	std::vector<std::unique_ptr<deque>> deques{};
+
+	std::string name{};
 
 	~impl_type () noexcept;
 
-	void run () noexcept;
+	bool idle () const noexcept;
+	bool injected () const noexcept;
+
+	void work (size_t index) noexcept;
+	void run (size_t index) noexcept;
+	void run_stealing (size_t index) noexcept;
+	task *take_injected (size_t index, deque *own) noexcept;
+	task *steal (size_t index, std::minstd_rand &random) noexcept;
+
+	injection &injection_for_caller () noexcept;
+	void notify () noexcept;
+
+	// Block until a notify() after \a ready last found no work, unless it finds some
+	template <typename Ready>
+	void park (Ready ready) noexcept
+	{
+		parked.fetch_add(1, std::memory_order_relaxed);
+
+		// pairs with notify(): either it sees this worker parked, or ready() sees its work
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const auto key = epoch.load(std::memory_order_acquire);
+		if (!ready())
+		{
+			epoch.wait(key, std::memory_order_acquire);
+		}
+
+		parked.fetch_sub(1, std::memory_order_relaxed);
+	}
 };
 
+namespace
+{
+
+void execute (task &t) noexcept
+{
+	// copy the post-back target out: the work closure may overwrite all of scratch
+	auto *origin = t.scratch_as<record>().origin;
+	t.complete({}, 0);
+	__event_loop::post(*origin, task_ptr{&t});
+}
+
+} // namespace
+
 impl_type::~impl_type () noexcept
 {
-	{
-		const std::scoped_lock lock{mutex};
-		pal_require(queue.empty(), "thread_pool destroyed with a pending queue");
-		stop = true;
-	}
-	pending.notify_all();
+	pal_require(!injected() && idle(), "thread_pool destroyed with a pending queue");
+
+	stop.store(true, std::memory_order_relaxed);
+	epoch.fetch_add(1, std::memory_order_release);
+	epoch.notify_all();
 
 	for (auto &worker: workers)
 	{
@@ -41,40 +406,201 @@ impl_type::~impl_type () noexcept
 	}
 }
 
-void impl_type::run () noexcept
+bool impl_type::idle () const noexcept
+{
+	for (const auto &d: deques)
+	{
+		if (!d->empty())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Whether any injection queue holds work. Any thread.
+bool impl_type::injected () const noexcept
+{
+	for (const auto &i: injections)
+	{
+		if (i->pending.load(std::memory_order_relaxed) > 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void impl_type::work (size_t index) noexcept
+{
+	set_name(name, index);
+	this_worker = {.pool = this, .index = index};
+	if (deques.empty())
+	{
+		run(index);
+	}
+	else
+	{
+		run_stealing(index);
+	}
+}
+
+void impl_type::run (size_t index) noexcept
 {
-	std::unique_lock lock{mutex};
 	for (;;)
 	{
-		if (task *t = queue.try_pop())
+		if (task *t = take_injected(index, nullptr))
+		{
+			execute(*t);
+		}
+		else if (stop.load(std::memory_order_acquire))
 		{
-			lock.unlock();
+			return;
+		}
+		else
+		{
+			park([this] { return injected() || stop.load(std::memory_order_relaxed); });
+		}
+	}
+}
 
-			// copy the post-back target out: the work closure may overwrite all of scratch
-			auto *origin = t->scratch_as<record>().origin;
-			t->complete({}, 0);
-			__event_loop::post(*origin, task_ptr{t});
+void impl_type::run_stealing (size_t index) noexcept
+{
+	auto &own = *deques[index];
+	std::minstd_rand random{static_cast<std::minstd_rand::result_type>(index + 1)};
 
-			lock.lock();
+	for (;;)
+	{
+		task *t = own.pop();
+		if (t == nullptr)
+		{
+			t = take_injected(index, &own);
 		}
-		else if (stop)
+		if (t == nullptr)
+		{
+			t = steal(index, random);
+		}
+
+		if (t != nullptr)
+		{
+			execute(*t);
+		}
+		else if (stop.load(std::memory_order_acquire))
 		{
 			return;
 		}
 		else
 		{
-			pending.wait(lock);
+			park([this] { return injected() || !idle() || stop.load(std::memory_order_relaxed); });
+		}
+	}
+}
+
+// Pop one injected task to run and, if \a own, move up to a batch more onto it, all in one consuming
+// turn; worker \a index's home queue first, then the others. Null if all are empty, other workers have
+// their turns, or a push is midway (all short; the caller retries via park(), whose ready() sees the
+// pending count).
+task *impl_type::take_injected (size_t index, deque *own) noexcept
+{
+	const auto count = injections.size();
+	for (size_t i = 0; i != count; ++i)
+	{
+		auto &from = *injections[(home[index] + i) % count];
+		if (from.pending.load(std::memory_order_relaxed) == 0
+			|| from.consuming.exchange(true, std::memory_order_acquire))
+		{
+			continue;
+		}
+
+		auto *first = from.queue.try_pop();
+		size_t moved = 0;
+		while (own != nullptr && first != nullptr && moved < injection_batch)
+		{
+			auto *t = from.queue.try_pop();
+			if (t == nullptr)
+			{
+				break;
+			}
+			if (!own->push(*t))
+			{
+				// back in the queue: still pending
+				from.queue.push(*t);
+				break;
+			}
+			++moved;
+		}
+
+		if (const auto taken = moved + (first != nullptr))
+		{
+			from.pending.fetch_sub(taken, std::memory_order_relaxed);
+		}
+		from.consuming.store(false, std::memory_order_release);
+		if (moved > 0)
+		{
+			notify();
+		}
+		if (first != nullptr)
+		{
+			return first;
 		}
 	}
+	return nullptr;
+}
+
+// One pass over the other workers' deques, from a random one
+task *impl_type::steal (size_t index, std::minstd_rand &random) noexcept
+{
+	const auto count = deques.size();
+	const auto start = random() % count;
+	for (size_t i = 0; i != count; ++i)
+	{
+		const auto victim = (start + i) % count;
+		if (victim == index)
+		{
+			continue;
+		}
+		if (auto *t = deques[victim]->steal())
+		{
+			return t;
+		}
+	}
+	return nullptr;
+}
+
+// The injection queue of the calling thread's NUMA node
+injection &impl_type::injection_for_caller () noexcept
+{
+	if (node_injection.empty())
+	{
+		return *injections.front();
+	}
+	const auto node = current_node();
+	return *injections[node < node_injection.size() ? node_injection[node] : 0];
+}
+
+// After publishing work: wake a parked worker, if any. No syscall while every worker is busy.
+void impl_type::notify () noexcept
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (parked.load(std::memory_order_relaxed) > 0)
+	{
+		epoch.fetch_add(1, std::memory_order_release);
+		epoch.notify_one();
+	}
 }
 
 void submit (impl_type &pool, task &t) noexcept
 {
+	const auto local = this_worker.pool == &pool && !pool.deques.empty();
+	if (!local || !pool.deques[this_worker.index]->push(t))
 	{
-		const std::scoped_lock lock{pool.mutex};
-		pool.queue.push(t);
+		// counted before the push, so the count never drops below what workers can pop; one that sees
+		// the count early retries until the push lands
+		auto &to = pool.injection_for_caller();
+		to.pending.fetch_add(1, std::memory_order_relaxed);
+		to.queue.push(t);
 	}
-	pool.pending.notify_one();
+	pool.notify();
 }
 
 void deleter::operator() (impl_type *pool) const noexcept
@@ -84,11 +610,11 @@ void deleter::operator() (impl_type *pool) const noexcept
 
 } // namespace __thread_pool
 
-result<thread_pool> make_thread_pool (size_t threads) noexcept
+result<thread_pool> make_thread_pool (const thread_pool_config &config) noexcept
 {
 	using namespace __thread_pool;
 
-	pal_require(threads > 0, "thread_pool with no worker threads");
+	pal_require(config.threads > 0, "thread_pool with no worker threads");
 
 	auto *self = new (std::nothrow) impl_type{};
 	if (self == nullptr)
@@ -99,10 +625,114 @@ result<thread_pool> make_thread_pool (size_t threads) noexcept
 	impl_ptr impl{self};
 	try
 	{
-		impl->workers.reserve(threads);
-		while (impl->workers.size() < threads)
+		const auto nodes = numa_nodes();
+		std::vector<size_t> populated;
+		for (size_t node = 0; node != nodes.size(); ++node)
+		{
+			if (!nodes[node].empty())
+			{
+				populated.push_back(node);
+			}
+		}
+
+		const auto node_of = [&nodes] (int cpu) -> size_t
+		{
+			for (size_t node = 0; node != nodes.size(); ++node)
+			{
+				if (std::ranges::find(nodes[node], cpu) != nodes[node].end())
+				{
+					return node;
+				}
+			}
+			return 0;
+		};
+
+		if (config.numa_node >= 0 && config.cpus.empty() && !nodes.empty())
+		{
+			const auto node = static_cast<size_t>(config.numa_node);
+			if (node >= nodes.size() || nodes[node].empty())
+			{
+				return make_unexpected(std::errc::invalid_argument);
+			}
+		}
+
+		std::vector<placement> placements(config.threads);
+		for (size_t i = 0; i != config.threads; ++i)
+		{
+			auto &p = placements[i];
+			if (!config.cpus.empty())
+			{
+				const auto cpu = config.cpus[i % config.cpus.size()];
+				p = {.cpus = {cpu}, .node = node_of(cpu)};
+			}
+			else if (config.numa_node >= 0 && !nodes.empty())
+			{
+				const auto node = static_cast<size_t>(config.numa_node);
+				p = {.cpus = nodes[node], .node = node};
+			}
+			else if (config.numa_local && populated.size() > 1)
+			{
+				const auto node = populated[i % populated.size()];
+				p = {.cpus = nodes[node], .node = node};
+			}
+		}
+
+		// one injection queue per node with workers; nodes without share one round-robin
+		impl->home.resize(config.threads);
+		if (config.numa_local && !nodes.empty())
+		{
+			constexpr auto none = static_cast<size_t>(-1);
+			impl->node_injection.assign(nodes.size(), none);
+			for (size_t i = 0; i != config.threads; ++i)
+			{
+				auto &queue = impl->node_injection[placements[i].node];
+				if (queue == none)
+				{
+					queue = impl->injections.size();
+					impl->injections.push_back(std::make_unique<injection>());
+				}
+				impl->home[i] = queue;
+			}
+			for (size_t node = 0, next = 0; node != nodes.size(); ++node)
+			{
+				if (impl->node_injection[node] == none)
+				{
+					impl->node_injection[node] = next++ % impl->injections.size();
+				}
+			}
+		}
+		else
+		{
+			impl->injections.push_back(std::make_unique<injection>());
+		}
+
+		if (config.scheduler == thread_pool_config::scheduler_type::work_stealing)
+		{
+			const auto capacity = std::bit_ceil(
+				config.deque_capacity > 0 ? config.deque_capacity : thread_pool_config::default_deque_capacity
+			);
+			impl->deques.reserve(config.threads);
+			while (impl->deques.size() < config.threads)
+			{
+				impl->deques.push_back(std::make_unique<deque>(capacity));
+			}
+		}
+
+		if (config.name != nullptr)
+		{
+			impl->name = config.name;
+		}
+
+		impl->workers.reserve(config.threads);
+		while (impl->workers.size() < config.threads)
 		{
-			impl->workers.emplace_back(&impl_type::run, self);
+			const auto i = impl->workers.size();
+			auto &worker = impl->workers.emplace_back(&impl_type::work, self, i);
+			auto r = pin(worker, placements[i].cpus).and_then([&] { return set_priority(worker, config.priority); });
+			if (!r)
+			{
+				return unexpected{r.error()};
+			}
 		}
 	}
 	catch (const std::system_error &e)
@@ -8,6 +8,7 @@
 #include <pal/async/event_loop.hpp>
 #include <pal/result.hpp>
 #include <memory>
+#include <span>
 #include <utility>
 
 namespace pal::async
@@ -15,8 +16,65 @@ namespace pal::async
 
 class thread_pool;
 
-/// Create a pool of \a threads worker threads (at least one; zero is a precondition violation).
+/// Sizing and scheduling of a \ref thread_pool.
+struct thread_pool_config
+{
+	/// Worker threads; at least one (zero is a precondition violation).
+	size_t threads = 1;
+
+	/// How posted work reaches the workers.
+	enum class scheduler_type
+	{
+		/// One FIFO queue shared by every worker, e.g. for name resolution at session-setup rates. Workers
+		/// take turns popping, which serializes them when busy.
+		shared_queue,
+
+		/// A work-stealing deque per worker: work posted from a worker thread stays on its deque and is
+		/// run newest first, idle workers steal the oldest from busy ones; work posted from elsewhere
+		/// still enters through the shared queue, which workers take from in batches. For CPU-bound
+		/// work at high rates (signature checks, compression) on many workers. No FIFO order.
+		work_stealing,
+	};
+	scheduler_type scheduler = scheduler_type::shared_queue;
+
+	/// Per-worker deque slots (\c work_stealing), rounded up to a power of two; 0 selects
+	/// \ref default_deque_capacity. Work posted from a worker whose deque is full goes to the shared
+	/// queue.
+	static constexpr size_t default_deque_capacity = 256;
+	size_t deque_capacity = 0;
+
+	/// Pin worker \c i to CPU <tt>cpus[i % cpus.size()]</tt>; empty places workers per \ref numa_node and
+	/// \ref numa_local instead. Read by make_thread_pool only. Ignored where threads have no affinity
+	/// (macOS).
+	std::span<const int> cpus{};
+
+	/// Bind every worker to the CPUs of this NUMA node (no such node: \c std::errc::invalid_argument);
+	/// -1 binds none. Ignored with \ref cpus, and where the NUMA topology is unknown (other than Linux).
+	int numa_node = -1;
+
+	/// Keep offloads on the posting thread's NUMA node: one shared queue per node with workers, each post
+	/// going to its poster's -- typically a pinned loop thread, so the work and its post-back stay on that
+	/// node's memory. Workers take from their own node's queue first and from the others when it runs
+	/// dry. Unless \ref cpus or \ref numa_node place them, workers are spread round-robin across the
+	/// nodes, each bound to its node's CPUs. Work posted from a worker stays on its own deque, as without.
+	bool numa_local = false;
+
+	/// Worker thread name prefix: worker \c i is named <tt>"<name>/<i>"</tt>, truncated to the platform's
+	/// limit (15 characters on Linux). Null leaves workers unnamed. Read by make_thread_pool only.
+	const char *name = nullptr;
+
+	/// Run workers at real-time priority: SCHED_FIFO at this priority (1-99; on Windows, time-critical
+	/// priority). Typically requires privileges; lacking them fails make_thread_pool. 0 keeps the default
+	/// policy.
+	int priority = 0;
+};
+
+/// Create a pool of \a config.threads worker threads, scheduled per \a config.scheduler.
 /// Errors: thread or memory resource exhaustion.
+result<thread_pool> make_thread_pool (const thread_pool_config &config) noexcept;
+
+/// Create a shared-queue pool of \a threads worker threads (at least one; zero is a precondition
+/// violation). Errors: thread or memory resource exhaustion.
 result<thread_pool> make_thread_pool (size_t threads) noexcept;
 
 namespace __thread_pool
@@ -78,11 +136,16 @@ void submit (impl_type &pool, task &t) noexcept;
 /// a handler closure on the posting loop's thread. Created and owned by the application, shared across any
 /// number of loops; the pool knows no loop beyond the per-task post-back target.
 ///
-/// Work arrives at session-setup rates, not packet rates: one shared injection queue, no work stealing. The
-/// head-of-line hazard across op classes (a DNS timeout starving file I/O) is solved by wiring, not
-/// scheduling: give each op class its own pool.
+/// Scheduling is per pool (\ref thread_pool_config::scheduler): one shared queue for work arriving at
+/// session-setup rates, per-worker work-stealing deques for CPU-bound work at high rates. Either way,
+/// posting is lock-free and makes no syscall unless a worker is parked idle. Onto a shared queue it costs
+/// two atomic RMWs on state every producer and worker touches (the queue's pending count, then the
+/// exchange onto its tail); onto a worker's own deque none. Either way a full fence follows, pairing with
+/// workers about to park. Idle workers park on a futex (where the platform's std::atomic::wait is one),
+/// not a lock. The head-of-line hazard across op classes (a DNS timeout starving file I/O) is solved by
+/// wiring, not scheduling: give each op class its own pool.
 ///
-/// Destruction requires an empty queue (debug REQUIRE) and joins the workers, so it blocks on work still in
+/// Destruction requires empty queues (debug REQUIRE) and joins the workers, so it blocks on work still in
 /// flight. Per the teardown contract the application quiesces first: stops posting, runs its loops until
 /// every offloaded handler has completed, then destroys handles, loops and pools, in that order.
 class thread_pool
@@ -125,10 +188,15 @@ private:
 	{
 	}
 
-	friend result<thread_pool> make_thread_pool (size_t) noexcept;
+	friend result<thread_pool> make_thread_pool (const thread_pool_config &) noexcept;
 	friend class event_loop;
 
 	__thread_pool::impl_ptr impl_;
 };
 
+inline result<thread_pool> make_thread_pool (size_t threads) noexcept
+{
+	return make_thread_pool(thread_pool_config{.threads = threads});
+}
+
 } // namespace pal::async
@@ -2,12 +2,22 @@
 #include <pal/test.hpp>
 #include <pal/version.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <barrier>
 #include <chrono>
+#include <optional>
 #include <thread>
+#include <string>
 #include <tuple>
 
+#if __pal_os_linux
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
 namespace
 {
 
@@ -76,7 +86,12 @@ TEST_CASE("async/thread_pool offload")
 	auto loop = make_loop();
 	REQUIRE(loop);
 
-	auto pool = make_thread_pool(1);
+	thread_pool_config config;
+	config.scheduler = GENERATE(
+		thread_pool_config::scheduler_type::shared_queue,
+		thread_pool_config::scheduler_type::work_stealing
+	);
+	auto pool = make_thread_pool(config);
 	REQUIRE(pool);
 
 	SECTION("post: work on worker thread, handler on loop thread")
@@ -244,6 +259,428 @@ TEST_CASE("async/thread_pool offload")
 	}
 }
 
+TEST_CASE("async/thread_pool concurrent producers")
+{
+	constexpr size_t producers = 4, bursts = 50, burst_size = 20;
+
+	// made before the pool, so its workers are joined before any loop goes away
+	std::array<std::optional<event_loop>, producers> loops;
+	for (auto &loop: loops)
+	{
+		auto l = make_loop();
+		REQUIRE(l);
+		loop.emplace(std::move(*l));
+	}
+
+	thread_pool_config config;
+	config.threads = 2;
+	config.scheduler = GENERATE(
+		thread_pool_config::scheduler_type::shared_queue,
+		thread_pool_config::scheduler_type::work_stealing
+	);
+	auto pool = make_thread_pool(config);
+	REQUIRE(pool);
+
+	// each producer thread drives its own loop, posting its tasks in bursts between parks
+	std::array<bool, producers> ok{};
+	std::array<std::thread, producers> threads;
+	for (size_t p = 0; p != producers; ++p)
+	{
+		// clang-format off
+		threads[p] = std::thread([&pool, &ok, &loop = *loops[p], p]
+		{
+			std::array<task, burst_size> tasks;
+			size_t done = 0;
+			for (size_t burst = 0; burst != bursts; ++burst)
+			{
+				for (auto &t: tasks)
+				{
+					pool->post(loop, t.borrow(), [] (task &) noexcept {}, [&done] (task_ptr &&) noexcept { ++done; });
+				}
+
+				const auto deadline = event_loop::clock::now() + 5s;
+				while (done != (burst + 1) * burst_size && event_loop::clock::now() < deadline)
+				{
+					std::ignore = loop.run_for(deadline - event_loop::clock::now());
+				}
+				if (burst % 10 == 0)
+				{
+					// let the workers park
+					std::this_thread::sleep_for(1ms);
+				}
+			}
+			ok[p] = done == bursts * burst_size;
+		});
+		// clang-format on
+	}
+
+	for (auto &t: threads)
+	{
+		t.join();
+	}
+	CHECK(std::ranges::all_of(ok, std::identity{}));
+}
+
+TEST_CASE("async/thread_pool bursty posts")
+{
+	// Producers post short bursts in lockstep while the workers are still busy with earlier tasks, then
+	// all wait: nothing posted later can flush out a task left behind. A post racing a worker's pop must
+	// not look "empty" to the workers, or the round's last task strands until the deadline.
+	constexpr size_t producers = 4, rounds = 2000, burst_size = 4;
+
+	std::array<std::optional<event_loop>, producers> loops;
+	for (auto &loop: loops)
+	{
+		auto l = make_loop();
+		REQUIRE(l);
+		loop.emplace(std::move(*l));
+	}
+
+	// outlive the pool too: a stranded task stays queued until its workers are joined
+	std::array<std::array<task, burst_size>, producers> tasks;
+
+	thread_pool_config config;
+	config.threads = 2;
+	config.scheduler = GENERATE(
+		thread_pool_config::scheduler_type::shared_queue,
+		thread_pool_config::scheduler_type::work_stealing
+	);
+	auto pool = make_thread_pool(config);
+	REQUIRE(pool);
+
+	const auto busy = [] (task &) noexcept
+	{
+		for (std::atomic<int> i = 0; i.load(std::memory_order_relaxed) < 100; i.fetch_add(1, std::memory_order_relaxed))
+		{
+		}
+	};
+
+	std::barrier round_barrier{producers};
+	std::array<size_t, producers> completed_rounds{};
+	std::array<std::thread, producers> threads;
+	for (size_t p = 0; p != producers; ++p)
+	{
+		// clang-format off
+		threads[p] = std::thread([&, &loop = *loops[p], p]
+		{
+			size_t done = 0;
+			for (size_t round = 0; round != rounds; ++round)
+			{
+				round_barrier.arrive_and_wait();
+				for (auto &t: tasks[p])
+				{
+					pool->post(loop, t.borrow(), busy, [&done] (task_ptr &&) noexcept { ++done; });
+				}
+
+				const auto deadline = event_loop::clock::now() + 2s;
+				while (done != (round + 1) * burst_size && event_loop::clock::now() < deadline)
+				{
+					std::ignore = loop.run_for(deadline - event_loop::clock::now());
+				}
+				if (done != (round + 1) * burst_size)
+				{
+					// stranded: keep the others' barrier going, without posting more
+					round_barrier.arrive_and_drop();
+					return;
+				}
+				completed_rounds[p]++;
+			}
+		});
+		// clang-format on
+	}
+
+	for (auto &t: threads)
+	{
+		t.join();
+	}
+	CHECK(std::ranges::all_of(completed_rounds, [] (size_t n) { return n == rounds; }));
+}
+
+// Work that fans out from the worker thread: each of \a count tasks is posted by the previous one's work
+// closure, so it lands on that worker's own deque, for the others to steal.
+struct fan_out
+{
+	thread_pool *pool;
+	event_loop *loop;
+	task *tasks;
+	size_t count;
+	std::atomic<size_t> *ran;
+
+	struct work
+	{
+		fan_out *self;
+		size_t index;
+
+		void operator() (task &) const noexcept
+		{
+			self->ran->fetch_add(1, std::memory_order_relaxed);
+			if (index + 1 < self->count)
+			{
+				self->post(index + 1);
+			}
+		}
+	};
+
+	void post (size_t index) noexcept
+	{
+		pool->post(*loop, tasks[index].borrow(), work{this, index}, [] (task_ptr &&) noexcept {});
+	}
+};
+
+TEST_CASE("async/thread_pool work_stealing")
+{
+	auto loop = make_loop();
+	REQUIRE(loop);
+
+	thread_pool_config config;
+	config.threads = 4;
+	config.scheduler = thread_pool_config::scheduler_type::work_stealing;
+
+	SECTION("post: many from the loop thread")
+	{
+		auto pool = make_thread_pool(config);
+		REQUIRE(pool);
+
+		std::array<task, 1000> tasks;
+		std::atomic<size_t> ran = 0;
+		size_t done = 0;
+		for (auto &t: tasks)
+		{
+			// clang-format off
+			pool->post(*loop, t.borrow(),
+				[&ran] (task &) noexcept
+				{
+					ran.fetch_add(1, std::memory_order_relaxed);
+				},
+				[&done] (task_ptr &&) noexcept
+				{
+					++done;
+				}
+			);
+			// clang-format on
+		}
+
+		run_until(*loop, tasks.size());
+		CHECK(ran.load() == tasks.size());
+		CHECK(done == tasks.size());
+	}
+
+	SECTION("post: from a worker, onto its own deque")
+	{
+		auto pool = make_thread_pool(config);
+		REQUIRE(pool);
+
+		std::array<task, 100> tasks;
+		std::atomic<size_t> ran = 0;
+		fan_out f{.pool = &*pool, .loop = &*loop, .tasks = tasks.data(), .count = tasks.size(), .ran = &ran};
+		f.post(0);
+
+		run_until(*loop, tasks.size());
+		CHECK(ran.load() == tasks.size());
+	}
+
+	SECTION("post: from a worker, deque full")
+	{
+		config.deque_capacity = 1;
+		auto pool = make_thread_pool(config);
+		REQUIRE(pool);
+
+		// one work closure posts them all: past the first, the rest overflow to the shared queue
+		std::array<task, 16> tasks;
+		std::atomic<size_t> ran = 0;
+		task first;
+		fan_out f{.pool = &*pool, .loop = &*loop, .tasks = tasks.data(), .count = tasks.size(), .ran = &ran};
+
+		// clang-format off
+		pool->post(*loop, first.borrow(),
+			[&f] (task &) noexcept
+			{
+				for (size_t i = 0; i != f.count; ++i)
+				{
+					f.pool->post(*f.loop, f.tasks[i].borrow(), fan_out::work{&f, f.count}, [] (task_ptr &&) noexcept {});
+				}
+			},
+			[] (task_ptr &&) noexcept {}
+		);
+		// clang-format on
+
+		run_until(*loop, tasks.size() + 1);
+		CHECK(ran.load() == tasks.size());
+	}
+}
+
+TEST_CASE("async/thread_pool placement")
+{
+	auto loop = make_loop();
+	REQUIRE(loop);
+
+	thread_pool_config config;
+	task t;
+
+	// run \a work on a worker of a pool made from config, returning whether it completed
+	const auto offload = [&] (auto work)
+	{
+		auto pool = make_thread_pool(config);
+		REQUIRE(pool);
+		pool->post(*loop, t.borrow(), work, [] (task_ptr &&) noexcept {});
+		run_until(*loop, 1);
+	};
+
+	SECTION("name")
+	{
+		#if __pal_os_linux
+		{
+			config.name = "offload";
+			std::string name;
+
+			// clang-format off
+			offload([&name] (task &) noexcept
+			{
+				char buf[16]{};
+				::pthread_getname_np(::pthread_self(), buf, sizeof(buf));
+				name = buf;
+			});
+			// clang-format on
+
+			CHECK(name == "offload/0");
+		}
+		#else
+		{
+			SKIP("thread name read back on Linux only");
+		}
+		#endif
+	}
+
+	SECTION("name: truncated")
+	{
+		#if __pal_os_linux
+		{
+			// 15 characters and the terminator
+			config.name = "a-rather-long-pool-name";
+			std::string name;
+
+			// clang-format off
+			offload([&name] (task &) noexcept
+			{
+				char buf[16]{};
+				::pthread_getname_np(::pthread_self(), buf, sizeof(buf));
+				name = buf;
+			});
+			// clang-format on
+
+			CHECK(name == "a-rather-long-p");
+		}
+		#else
+		{
+			SKIP("thread name read back on Linux only");
+		}
+		#endif
+	}
+
+	SECTION("cpus")
+	{
+		#if __pal_os_linux
+		{
+			// the process may be confined to a subset (e.g. a container's cpuset): pick from that, the
+			// highest so that it differs from CPU 0 wherever possible
+			::cpu_set_t allowed;
+			CPU_ZERO(&allowed);
+			REQUIRE(::sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+			int expected = -1;
+			for (int i = 0; i != CPU_SETSIZE; ++i)
+			{
+				if (CPU_ISSET(i, &allowed))
+				{
+					expected = i;
+				}
+			}
+			REQUIRE(expected != -1);
+
+			const int cpus[] = {expected};
+			config.cpus = cpus;
+			int cpu = -1;
+
+			// clang-format off
+			offload([&cpu] (task &) noexcept
+			{
+				cpu = ::sched_getcpu();
+			});
+			// clang-format on
+
+			CHECK(cpu == expected);
+		}
+		#else
+		{
+			SKIP("worker CPU read back on Linux only");
+		}
+		#endif
+	}
+
+	SECTION("cpus: invalid")
+	{
+		if constexpr (pal::os == pal::os_type::linux)
+		{
+			const int cpus[] = {-1};
+			config.cpus = cpus;
+			auto pool = make_thread_pool(config);
+			REQUIRE_FALSE(pool);
+			CHECK(pool.error() == std::errc::invalid_argument);
+		}
+	}
+
+	SECTION("numa_node")
+	{
+		config.numa_node = 0;
+		offload([] (task &) noexcept {});
+	}
+
+	SECTION("numa_node: no such node")
+	{
+		if constexpr (pal::os == pal::os_type::linux)
+		{
+			config.numa_node = 4096;
+			auto pool = make_thread_pool(config);
+			REQUIRE_FALSE(pool);
+			CHECK(pool.error() == std::errc::invalid_argument);
+		}
+	}
+
+	SECTION("numa_local")
+	{
+		config.threads = 2;
+		config.numa_local = true;
+		config.scheduler = GENERATE(
+			thread_pool_config::scheduler_type::shared_queue,
+			thread_pool_config::scheduler_type::work_stealing
+		);
+		auto pool = make_thread_pool(config);
+		REQUIRE(pool);
+
+		std::array<task, 100> tasks;
+		size_t done = 0;
+		for (auto &task: tasks)
+		{
+			pool->post(*loop, task.borrow(), [] (pal::async::task &) noexcept {}, [&done] (task_ptr &&) noexcept { ++done; });
+		}
+		run_until(*loop, tasks.size());
+		CHECK(done == tasks.size());
+	}
+
+	SECTION("priority")
+	{
+		config.priority = 1;
+		auto pool = make_thread_pool(config);
+		if (!pool)
+		{
+			// unprivileged
+			CHECK(pool.error() == std::errc::operation_not_permitted);
+			return;
+		}
+		pool->post(*loop, t.borrow(), [] (task &) noexcept {}, [] (task_ptr &&) noexcept {});
+		run_until(*loop, 1);
+	}
+}
+
 TEST_CASE("async/thread_pool destructor contract")
 {
 	if constexpr (pal::build == pal::build_type::debug)
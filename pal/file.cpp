@@ -0,0 +1,252 @@
+#include <pal/file.hpp>
+#include <pal/error.hpp>
+#include <pal/version.hpp>
+#include <algorithm>
+#include <limits>
+
+#if __pal_os_linux || __pal_os_macos
+	#include <cerrno>
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#elif __pal_os_windows
+	#include <windows.h>
+#endif
+
+namespace pal
+{
+
+#if __pal_os_linux || __pal_os_macos
+
+namespace
+{
+
+int to_sys (__file::handle_type h) noexcept
+{
+	return static_cast<int>(h);
+}
+
+} // namespace
+
+void __file::close (handle_type h) noexcept
+{
+	if (h != handle_type::invalid)
+	{
+		::close(to_sys(h));
+	}
+}
+
+result<file> open_file (const char *path, file::flags f) noexcept
+{
+	int oflag = O_CLOEXEC;
+	switch (f & (file::read | file::write))
+	{
+		case file::read:
+			oflag |= O_RDONLY;
+			break;
+		case file::write:
+			oflag |= O_WRONLY;
+			break;
+		case file::read | file::write:
+			oflag |= O_RDWR;
+			break;
+		default:
+			return make_unexpected(std::errc::invalid_argument);
+	}
+	if (f & file::create)
+	{
+		oflag |= O_CREAT;
+	}
+	if (f & file::exclusive)
+	{
+		oflag |= O_EXCL;
+	}
+	if (f & file::truncate)
+	{
+		oflag |= O_TRUNC;
+	}
+
+	int fd;
+	do
+	{
+		fd = ::open(path, oflag, 0666);
+	} while (fd == -1 && errno == EINTR);
+
+	if (fd == -1)
+	{
+		return unexpected{this_thread::last_system_error()};
+	}
+	return file{static_cast<__file::handle_type>(fd)};
+}
+
+result<size_t> file::read_at (std::span<std::byte> buf, uint64_t offset) const noexcept
+{
+	const auto r = ::pread(to_sys(handle_), buf.data(), buf.size(), static_cast<::off_t>(offset));
+	if (r == -1)
+	{
+		return unexpected{this_thread::last_system_error()};
+	}
+	return static_cast<size_t>(r);
+}
+
+result<size_t> file::write_at (std::span<const std::byte> buf, uint64_t offset) const noexcept
+{
+	const auto r = ::pwrite(to_sys(handle_), buf.data(), buf.size(), static_cast<::off_t>(offset));
+	if (r == -1)
+	{
+		return unexpected{this_thread::last_system_error()};
+	}
+	return static_cast<size_t>(r);
+}
+
+result<void> file::sync () const noexcept
+{
+	if (::fsync(to_sys(handle_)) == -1)
+	{
+		return unexpected{this_thread::last_system_error()};
+	}
+	return {};
+}
+
+result<uint64_t> file::size () const noexcept
+{
+	struct ::stat st;
+	if (::fstat(to_sys(handle_), &st) == -1)
+	{
+		return unexpected{this_thread::last_system_error()};
+	}
+	return static_cast<uint64_t>(st.st_size);
+}
+
+#elif __pal_os_windows
+
+namespace
+{
+
+::HANDLE to_sys (__file::handle_type h) noexcept
+{
+	return reinterpret_cast<::HANDLE>(h);
+}
+
+::OVERLAPPED at (uint64_t offset) noexcept
+{
+	::OVERLAPPED o{};
+	o.Offset = static_cast<::DWORD>(offset);
+	o.OffsetHigh = static_cast<::DWORD>(offset >> 32);
+	return o;
+}
+
+// ReadFile/WriteFile take a DWORD length: larger buffers transfer partially, as with short POSIX I/O
+::DWORD clamp (size_t size) noexcept
+{
+	return static_cast<::DWORD>((std::min<size_t>)(size, (std::numeric_limits<::DWORD>::max)()));
+}
+
+} // namespace
+
+void __file::close (handle_type h) noexcept
+{
+	if (h != handle_type::invalid)
+	{
+		::CloseHandle(to_sys(h));
+	}
+}
+
+result<file> open_file (const char *path, file::flags f) noexcept
+{
+	::DWORD access = 0;
+	if (f & file::read)
+	{
+		access |= GENERIC_READ;
+	}
+	if (f & file::write)
+	{
+		access |= GENERIC_WRITE;
+	}
+	if (access == 0)
+	{
+		return make_unexpected(std::errc::invalid_argument);
+	}
+
+	::DWORD disposition = OPEN_EXISTING;
+	if ((f & file::create) && (f & file::exclusive))
+	{
+		disposition = CREATE_NEW;
+	}
+	else if ((f & file::create) && (f & file::truncate))
+	{
+		disposition = CREATE_ALWAYS;
+	}
+	else if (f & file::create)
+	{
+		disposition = OPEN_ALWAYS;
+	}
+	else if (f & file::truncate)
+	{
+		disposition = TRUNCATE_EXISTING;
+	}
+
+	auto h = ::CreateFileA(
+		path,
+		access,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr,
+		disposition,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr
+	);
+	if (h == INVALID_HANDLE_VALUE)
+	{
+		return unexpected{this_thread::last_system_error()};
+	}
+	return file{reinterpret_cast<__file::handle_type>(h)};
+}
+
+result<size_t> file::read_at (std::span<std::byte> buf, uint64_t offset) const noexcept
+{
+	auto o = at(offset);
+	::DWORD n = 0;
+	if (!::ReadFile(to_sys(handle_), buf.data(), clamp(buf.size()), &n, &o))
+	{
+		if (::GetLastError() == ERROR_HANDLE_EOF)
+		{
+			return 0;
+		}
+		return unexpected{this_thread::last_system_error()};
+	}
+	return static_cast<size_t>(n);
+}
+
+result<size_t> file::write_at (std::span<const std::byte> buf, uint64_t offset) const noexcept
+{
+	auto o = at(offset);
+	::DWORD n = 0;
+	if (!::WriteFile(to_sys(handle_), buf.data(), clamp(buf.size()), &n, &o))
+	{
+		return unexpected{this_thread::last_system_error()};
+	}
+	return static_cast<size_t>(n);
+}
+
+result<void> file::sync () const noexcept
+{
+	if (!::FlushFileBuffers(to_sys(handle_)))
+	{
+		return unexpected{this_thread::last_system_error()};
+	}
+	return {};
+}
+
+result<uint64_t> file::size () const noexcept
+{
+	::LARGE_INTEGER size;
+	if (!::GetFileSizeEx(to_sys(handle_), &size))
+	{
+		return unexpected{this_thread::last_system_error()};
+	}
+	return static_cast<uint64_t>(size.QuadPart);
+}
+
+#endif
+
+} // namespace pal
@@ -0,0 +1,125 @@
+#pragma once
+
+/**
+ * \file pal/file.hpp
+ * Owning file handle with positional I/O
+ */
+
+#include <pal/result.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+namespace pal
+{
+
+namespace __file
+{
+
+/// Native OS file handle: file descriptor (POSIX) or HANDLE (Windows)
+enum class handle_type: intptr_t
+{
+	invalid = -1,
+};
+
+void close (handle_type h) noexcept;
+
+} // namespace __file
+
+/// Owning file handle. Closes the OS file on destruction.
+///
+/// I/O is positional only: every read and write names its offset and the file position is never used,
+/// so concurrent operations on the same file need no coordination (e.g. from thread_pool workers).
+class file
+{
+public:
+
+	/// Native OS file handle type
+	using native_handle_type = __file::handle_type;
+
+	/// \defgroup file_flags File open flags
+	/// \{
+
+	/// Bitmask of flags for \ref open_file
+	using flags = int;
+
+	/// Open for reading
+	static constexpr flags read = 0x01;
+
+	/// Open for writing
+	static constexpr flags write = 0x02;
+
+	/// Create the file if it does not exist
+	static constexpr flags create = 0x04;
+
+	/// With \ref create: fail with \c std::errc::file_exists if the file exists
+	static constexpr flags exclusive = 0x08;
+
+	/// Truncate an existing file to zero length (requires \ref write)
+	static constexpr flags truncate = 0x10;
+
+	/// \}
+
+	file () noexcept = default;
+
+	~file () noexcept
+	{
+		__file::close(handle_);
+	}
+
+	file (file &&that) noexcept
+		: handle_{std::exchange(that.handle_, native_handle_type::invalid)}
+	{
+	}
+
+	file &operator= (file &&that) noexcept
+	{
+		__file::close(std::exchange(handle_, std::exchange(that.handle_, native_handle_type::invalid)));
+		return *this;
+	}
+
+	/// Returns true if this instance holds a valid OS file handle
+	explicit operator bool () const noexcept
+	{
+		return handle_ != native_handle_type::invalid;
+	}
+
+	/// Return native OS file handle value
+	[[nodiscard]] native_handle_type native_handle () const noexcept
+	{
+		return handle_;
+	}
+
+	/// Read into \a buf from \a offset, returning the number of bytes read: fewer than \a buf holds
+	/// only at end of file (0 at or past it) or if interrupted.
+	[[nodiscard]] result<size_t> read_at (std::span<std::byte> buf, uint64_t offset) const noexcept;
+
+	/// Write \a buf at \a offset, extending the file as needed, returning the number of bytes written
+	/// (possibly fewer than \a buf holds, e.g. on a full disk).
+	[[nodiscard]] result<size_t> write_at (std::span<const std::byte> buf, uint64_t offset) const noexcept;
+
+	/// Flush written data and metadata to the storage device.
+	[[nodiscard]] result<void> sync () const noexcept;
+
+	/// Return the current file size in bytes.
+	[[nodiscard]] result<uint64_t> size () const noexcept;
+
+private:
+
+	native_handle_type handle_ = native_handle_type::invalid;
+
+	explicit file (native_handle_type handle) noexcept
+		: handle_{handle}
+	{
+	}
+
+	friend result<file> open_file (const char *path, flags f) noexcept;
+};
+
+/// Open the file at \a path with \ref file_flags \a f (at least one of \ref file::read or
+/// \ref file::write). A created file gets the default permissions (0666 before umask on POSIX).
+/// Errors: as the OS open call, \c std::errc::invalid_argument for a flag combination without access.
+[[nodiscard]] result<file> open_file (const char *path, file::flags f) noexcept;
+
+} // namespace pal
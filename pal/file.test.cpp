@@ -0,0 +1,112 @@
+#include <pal/file.hpp>
+#include <pal/test.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace
+{
+
+std::span<const std::byte> as_bytes (std::string_view s) noexcept
+{
+	return {reinterpret_cast<const std::byte *>(s.data()), s.size()};
+}
+
+TEST_CASE("file")
+{
+	const pal_test::temp_file tmp;
+	const auto path = tmp.string();
+
+	SECTION("open missing")
+	{
+		auto f = pal::open_file(path.c_str(), pal::file::read);
+		REQUIRE_FALSE(f);
+		CHECK(f.error() == std::errc::no_such_file_or_directory);
+	}
+
+	SECTION("open without access")
+	{
+		auto f = pal::open_file(path.c_str(), pal::file::create);
+		REQUIRE_FALSE(f);
+		CHECK(f.error() == std::errc::invalid_argument);
+	}
+
+	SECTION("default constructed")
+	{
+		pal::file f;
+		CHECK_FALSE(f);
+		CHECK(f.native_handle() == pal::file::native_handle_type::invalid);
+	}
+
+	SECTION("write_at / read_at")
+	{
+		auto f = pal::open_file(path.c_str(), pal::file::read | pal::file::write | pal::file::create);
+		REQUIRE(f);
+		CHECK(*f);
+		CHECK(f->size().value() == 0);
+
+		CHECK(f->write_at(as_bytes("world"), 6).value() == 5);
+		CHECK(f->write_at(as_bytes("hello "), 0).value() == 6);
+		CHECK(f->size().value() == 11);
+		CHECK(f->sync());
+
+		std::array<std::byte, 16> buf{};
+		REQUIRE(f->read_at(buf, 0).value() == 11);
+		CHECK(std::memcmp(buf.data(), "hello world", 11) == 0);
+
+		REQUIRE(f->read_at(std::span{buf}.first(3), 6).value() == 3);
+		CHECK(std::memcmp(buf.data(), "wor", 3) == 0);
+
+		CHECK(f->read_at(buf, 11).value() == 0);
+		CHECK(f->read_at(buf, 1000).value() == 0);
+	}
+
+	SECTION("exclusive")
+	{
+		REQUIRE(pal::open_file(path.c_str(), pal::file::write | pal::file::create | pal::file::exclusive));
+		auto f = pal::open_file(path.c_str(), pal::file::write | pal::file::create | pal::file::exclusive);
+		REQUIRE_FALSE(f);
+		CHECK(f.error() == std::errc::file_exists);
+	}
+
+	SECTION("truncate")
+	{
+		{
+			auto f = pal::open_file(path.c_str(), pal::file::write | pal::file::create);
+			REQUIRE(f);
+			REQUIRE(f->write_at(as_bytes("data"), 0));
+		}
+		auto f = pal::open_file(path.c_str(), pal::file::write | pal::file::truncate);
+		REQUIRE(f);
+		CHECK(f->size().value() == 0);
+	}
+
+	SECTION("write to read-only")
+	{
+		REQUIRE(pal::open_file(path.c_str(), pal::file::write | pal::file::create));
+		auto f = pal::open_file(path.c_str(), pal::file::read);
+		REQUIRE(f);
+		CHECK_FALSE(f->write_at(as_bytes("x"), 0));
+	}
+
+	SECTION("move")
+	{
+		auto f = pal::open_file(path.c_str(), pal::file::write | pal::file::create);
+		REQUIRE(f);
+		const auto h = f->native_handle();
+
+		pal::file g = std::move(*f);
+		CHECK_FALSE(*f);
+		CHECK(g.native_handle() == h);
+
+		*f = std::move(g);
+		CHECK(f->native_handle() == h);
+		CHECK_FALSE(g);
+	}
+}
+
+} // namespace
@@ -50,7 +50,8 @@ class intrusive_mpsc_queue;
 /// foo *fp = q.try_pop(); // fp == &f
 /// \endcode
 ///
-/// \note push() is safe to call concurrently from multiple threads.
+/// \note push() and push_chain() are safe to call concurrently from multiple
+/// threads.
 /// try_pop() and empty() must only be called from a single consumer thread.
 /// Items from the same producer are delivered in push order; items from
 /// different producers may interleave in any order.
@@ -79,6 +80,25 @@ public:
 		(back->*Next).store(&node, std::memory_order_release);
 	}
 
+	/// Link \a next behind \a node, building a chain for push_chain(). Not
+	/// thread-safe: the chain is private to its producer until pushed.
+	static void link (value_type &node, value_type &next) noexcept
+	{
+		(node.*Next).store(&next, std::memory_order_relaxed);
+	}
+
+	/// Push the chain \a first .. \a last, built with link(), onto the back of
+	/// the queue with a single exchange. Thread-safe. The chain's nodes are
+	/// delivered in link order, contiguously. All writes to them (links
+	/// included) before push_chain() happen-before any reads from them after
+	/// try_pop().
+	void push_chain (value_type &first, value_type &last) noexcept
+	{
+		(last.*Next).store(nullptr, std::memory_order_relaxed);
+		auto *back = tail_.exchange(&last, std::memory_order_acq_rel);
+		(back->*Next).store(&first, std::memory_order_release);
+	}
+
 	/// Remove and return the front node. Returns nullptr if empty or transiently
 	/// inconsistent (a producer is mid-push); the caller should retry.
 	/// Consumer thread only.
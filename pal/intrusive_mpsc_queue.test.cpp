@@ -1,6 +1,7 @@
 #include <pal/intrusive_mpsc_queue.hpp>
 #include <pal/test.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 #include <algorithm>
 #include <atomic>
 #include <random>
@@ -72,8 +73,63 @@ TEST_CASE("intrusive_mpsc_queue")
 		CHECK(queue.try_pop() == &f2);
 	}
 
+	SECTION("push_chain: single")
+	{
+		foo f;
+		queue.push_chain(f, f);
+		REQUIRE_FALSE(queue.empty());
+		CHECK(queue.try_pop() == &f);
+	}
+
+	SECTION("push_chain: multiple")
+	{
+		foo f1, f2, f3;
+		foo::queue::link(f1, f2);
+		foo::queue::link(f2, f3);
+		queue.push_chain(f1, f3);
+
+		REQUIRE_FALSE(queue.empty());
+		CHECK(queue.try_pop() == &f1);
+		REQUIRE_FALSE(queue.empty());
+		CHECK(queue.try_pop() == &f2);
+		REQUIRE_FALSE(queue.empty());
+		CHECK(queue.try_pop() == &f3);
+	}
+
+	SECTION("push_chain: interleaved with push")
+	{
+		foo f1, f2, f3, f4;
+		queue.push(f1);
+
+		foo::queue::link(f2, f3);
+		queue.push_chain(f2, f3);
+
+		REQUIRE_FALSE(queue.empty());
+		CHECK(queue.try_pop() == &f1);
+
+		queue.push(f4);
+
+		REQUIRE_FALSE(queue.empty());
+		CHECK(queue.try_pop() == &f2);
+
+		// relinking a popped node: its stale link is overwritten
+		foo::queue::link(f1, f2);
+		queue.push_chain(f1, f2);
+
+		REQUIRE_FALSE(queue.empty());
+		CHECK(queue.try_pop() == &f3);
+		REQUIRE_FALSE(queue.empty());
+		CHECK(queue.try_pop() == &f4);
+		REQUIRE_FALSE(queue.empty());
+		CHECK(queue.try_pop() == &f1);
+		REQUIRE_FALSE(queue.empty());
+		CHECK(queue.try_pop() == &f2);
+	}
+
 	SECTION("threaded")
 	{
+		// chained: each producer pushes runs of up to 8 nodes with push_chain()
+		const bool chained = GENERATE(false, true);
 		const size_t n_producers = std::clamp(std::thread::hardware_concurrency(), 2U, 16U);
 		const size_t items_per_producer = 5'000;
 
@@ -122,12 +178,32 @@ TEST_CASE("intrusive_mpsc_queue")
 			{
 				std::minstd_rand rng(static_cast<unsigned>(p));
 				const size_t base = p * items_per_producer;
-				for (size_t s = 0; s < items_per_producer; ++s)
+				for (size_t s = 0; s < items_per_producer; )
 				{
-					auto &f = data[base + s];
-					f.producer_id = p;
-					f.seq = s + 1;
-					queue.push(f);
+					if (!chained)
+					{
+						auto &f = data[base + s];
+						f.producer_id = p;
+						f.seq = ++s;
+						queue.push(f);
+						stagger(rng() % 127);
+						continue;
+					}
+
+					const auto n = std::min<size_t>(1 + rng() % 8, items_per_producer - s);
+					auto &first = data[base + s];
+					for (size_t i = 0; i < n; ++i)
+					{
+						auto &f = data[base + s + i];
+						f.producer_id = p;
+						f.seq = s + i + 1;
+						if (i > 0)
+						{
+							foo::queue::link(data[base + s + i - 1], f);
+						}
+					}
+					queue.push_chain(first, data[base + s + n - 1]);
+					s += n;
 					stagger(rng() % 127);
 				}
 				finished_producers++;
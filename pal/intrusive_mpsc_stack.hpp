@@ -48,7 +48,8 @@ class intrusive_mpsc_stack;
 /// \endcode
 ///
 /// \note push() is safe to call concurrently from multiple producer threads.
-/// try_pop() and empty() must only be called from the single consumer thread.
+/// try_pop(), pop_all() and empty() must only be called from the single
+/// consumer thread.
 ///
 template <typename T, typename Hook, Hook T::*Next>
 class intrusive_mpsc_stack<Next>
@@ -109,6 +110,22 @@ public:
 
 	// clang-format on
 
+	/// Detach all nodes at once and return the former top, or nullptr if
+	/// empty. The rest of the detached nodes follow in LIFO order, each
+	/// reachable from its predecessor through the \a Next hook (a relaxed load
+	/// suffices); the caller owns them. Unlike try_pop() it never fails
+	/// spuriously: one atomic exchange regardless of producer contention.
+	/// All writes to the detached nodes before their push() happen-before
+	/// reads after pop_all(). Consumer thread only.
+	[[nodiscard]] value_type *pop_all () noexcept
+	{
+		if (top_.load(std::memory_order_relaxed) == nullptr)
+		{
+			return nullptr;
+		}
+		return top_.exchange(nullptr, std::memory_order_acquire);
+	}
+
 	/// Return true if the stack has no elements. Consumer thread only.
 	[[nodiscard]] bool empty () const noexcept
 	{
@@ -64,6 +64,29 @@ TEST_CASE("intrusive_mpsc_stack")
 		CHECK(stack.try_pop() == &f1);
 	}
 
+	SECTION("pop_all")
+	{
+		CHECK(stack.pop_all() == nullptr);
+
+		foo f1, f2, f3;
+		stack.push(f1);
+		stack.push(f2);
+		stack.push(f3);
+
+		auto *p = stack.pop_all();
+		CHECK(stack.empty());
+		REQUIRE(p == &f3);
+		p = p->hook.load(std::memory_order_relaxed);
+		REQUIRE(p == &f2);
+		p = p->hook.load(std::memory_order_relaxed);
+		REQUIRE(p == &f1);
+		CHECK(p->hook.load(std::memory_order_relaxed) == nullptr);
+
+		// detached nodes are reusable
+		stack.push(f2);
+		CHECK(stack.try_pop() == &f2);
+	}
+
 	SECTION("threaded")
 	{
 		std::array<foo, 10'000> data;
@@ -7,6 +7,8 @@ list(APPEND pal_sources
 	pal/codec_hex.cpp
 	pal/error.hpp
 	pal/error.cpp
+	pal/file.hpp
+	pal/file.cpp
 	pal/hash.hpp
 	pal/intrusive_mpsc_queue.hpp
 	pal/intrusive_mpsc_stack.hpp
@@ -29,6 +31,7 @@ list(APPEND pal_test_sources
 	pal/codec.bench.cpp
 	pal/codec.test.cpp
 	pal/error.test.cpp
+	pal/file.test.cpp
 	pal/hash.bench.cpp
 	pal/hash.test.cpp
 	pal/intrusive_mpsc_queue.bench.cpp
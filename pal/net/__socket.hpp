@@ -10,11 +10,13 @@
 #include <pal/version.hpp>
 #include <array>
 #include <chrono>
+#include <span>
 #include <type_traits>
 
 #if __pal_os_linux || __pal_os_macos
 	#define __pal_net_posix 1
 	#define __pal_net_winsock 0
+	#include <netinet/udp.h>
 	#include <poll.h>
 	#include <sys/socket.h>
 	#include <unistd.h>
@@ -28,6 +30,7 @@
 namespace pal::net::__socket
 {
 
+/// I/O vectors of the variadic (compile-time length) message::set
 constexpr size_t io_vector_max_size = 4;
 
 #if __pal_net_posix //{{{1
@@ -59,9 +62,52 @@ inline pal::unexpected sys_error (int e = errno) noexcept
 	return pal::unexpected{std::error_code{e, std::generic_category()}};
 }
 
+using cmsg_header = ::cmsghdr;
+
+constexpr size_t cmsg_len (size_t data_size) noexcept
+{
+	return CMSG_LEN(data_size);
+}
+
+constexpr size_t cmsg_space (size_t data_size) noexcept
+{
+	return CMSG_SPACE(data_size);
+}
+
+#if defined(SO_TIMESTAMPNS)
+
+constexpr int so_timestamp = SO_TIMESTAMPNS;
+using timestamp = ::timespec;
+
+constexpr std::chrono::system_clock::time_point to_chrono_time (const timestamp &ts) noexcept
+{
+	using namespace std::chrono;
+	return system_clock::time_point{duration_cast<system_clock::duration>(seconds{ts.tv_sec} + nanoseconds{ts.tv_nsec})};
+}
+
+#else
+
+constexpr int so_timestamp = SO_TIMESTAMP;
+using timestamp = ::timeval;
+
+constexpr std::chrono::system_clock::time_point to_chrono_time (const timestamp &ts) noexcept
+{
+	using namespace std::chrono;
+	return system_clock::time_point{duration_cast<system_clock::duration>(seconds{ts.tv_sec} + microseconds{ts.tv_usec})};
+}
+
+#endif
+
+using io_vector = ::iovec;
+
+inline io_vector make_io_vector (const void *data, size_t size) noexcept
+{
+	return {.iov_base = const_cast<void *>(data), .iov_len = size};
+}
+
 struct message: ::msghdr
 {
-	std::array<::iovec, io_vector_max_size> iov{};
+	std::array<io_vector, io_vector_max_size> iov{};
 
 	template <typename... Buffers>
 	void set (Buffers &&...bufs) noexcept
@@ -71,20 +117,30 @@ struct message: ::msghdr
 		msg_iov = iov.data();
 		auto fill = [&] (auto &&b) noexcept
 		{
-			iov[msg_iovlen++] = {
-				.iov_base = const_cast<void *>(static_cast<const void *>(std::data(b))),
-				.iov_len = std::size(b) * sizeof(*std::data(b)),
-			};
+			iov[msg_iovlen++] = make_io_vector(std::data(b), std::size(b) * sizeof(*std::data(b)));
 		};
 		(fill(std::forward<Buffers>(bufs)), ...);
 	}
 
+	/// Map caller-owned \a vectors (at most IOV_MAX), which must outlive the syscall
+	void set (std::span<io_vector> vectors) noexcept
+	{
+		msg_iov = vectors.data();
+		msg_iovlen = vectors.size();
+	}
+
 	void name (const void *n, size_t name_size) noexcept
 	{
 		msg_name = const_cast<void *>(n);
 		msg_namelen = name_size;
 	}
 
+	void control (void *c, size_t control_size) noexcept
+	{
+		msg_control = c;
+		msg_controllen = control_size;
+	}
+
 	void flags (int f) noexcept
 	{
 		msg_flags = f;
@@ -120,37 +176,80 @@ inline pal::unexpected sys_error (int e = ::WSAGetLastError()) noexcept
 	return pal::unexpected{std::error_code{e, std::system_category()}};
 }
 
+using cmsg_header = ::WSACMSGHDR;
+
+constexpr size_t cmsg_len (size_t data_size) noexcept
+{
+	return WSA_CMSG_LEN(data_size);
+}
+
+constexpr size_t cmsg_space (size_t data_size) noexcept
+{
+	return WSA_CMSG_SPACE(data_size);
+}
+
+constexpr int so_timestamp = -1;
+using timestamp = ::timeval;
+
+constexpr std::chrono::system_clock::time_point to_chrono_time (const timestamp &ts) noexcept
+{
+	using namespace std::chrono;
+	return system_clock::time_point{duration_cast<system_clock::duration>(seconds{ts.tv_sec} + microseconds{ts.tv_usec})};
+}
+
+using io_vector = ::WSABUF;
+
+inline io_vector make_io_vector (const void *data, size_t size) noexcept
+{
+	return {
+		.len = static_cast<ULONG>(size),
+		.buf = const_cast<CHAR *>(static_cast<const CHAR *>(data)),
+	};
+}
+
 struct message
 {
 	sockaddr *msg_name{};
 	INT msg_namelen{};
 	DWORD msg_flags{};
 	DWORD msg_iovlen{};
-	std::array<::WSABUF, io_vector_max_size> msg_iov{};
+	io_vector *msg_iov{};
+	std::array<io_vector, io_vector_max_size> iov{};
+	void *msg_control{};
+	size_t msg_controllen{};
 
 	template <typename... Buffers>
 	void set (Buffers &&...bufs) noexcept
 	{
 		static_assert(sizeof...(Buffers) <= io_vector_max_size);
 		msg_iovlen = 0;
+		msg_iov = iov.data();
 		auto fill = [&] (auto &&b) noexcept
 		{
-			msg_iov[msg_iovlen++] = {
-				.len = static_cast<ULONG>(std::size(b) * sizeof(*std::data(b))),
-				.buf = const_cast<CHAR *>(
-					static_cast<const CHAR *>(static_cast<const void *>(std::data(b)))
-				),
-			};
+			iov[msg_iovlen++] = make_io_vector(std::data(b), std::size(b) * sizeof(*std::data(b)));
 		};
 		(fill(std::forward<Buffers>(bufs)), ...);
 	}
 
+	/// Map caller-owned \a vectors, which must outlive the syscall
+	void set (std::span<io_vector> vectors) noexcept
+	{
+		msg_iov = vectors.data();
+		msg_iovlen = static_cast<DWORD>(vectors.size());
+	}
+
 	void name (const void *n, size_t name_size) noexcept
 	{
 		msg_name = static_cast<sockaddr *>(const_cast<void *>(n));
 		msg_namelen = static_cast<INT>(name_size);
 	}
 
+	void control (void *c, size_t control_size) noexcept
+	{
+		msg_control = c;
+		msg_controllen = control_size;
+	}
+
 	void flags (int f) noexcept
 	{
 		msg_flags = f;
@@ -169,6 +268,16 @@ extern ::LPFN_GETACCEPTEXSOCKADDRS GetAcceptExSockaddrs;
 
 #endif //}}}1
 
+/// Datagrams per batched send/receive syscall (sendmmsg/recvmmsg)
+constexpr size_t batch_max_size = 64;
+
+/// Batched send/receive entry: message header and, on return, bytes moved for it
+struct batch_message
+{
+	message header{};
+	size_t size = 0;
+};
+
 constexpr auto to_sys (handle_type h) noexcept
 {
 	return static_cast<std::underlying_type_t<handle_type>>(h);
@@ -189,6 +298,30 @@ constexpr int reuse_port =
 #endif
 	;
 
+constexpr int udp_segment =
+#ifdef UDP_SEGMENT
+	UDP_SEGMENT
+#else
+	-1
+#endif
+	;
+
+constexpr int udp_gro =
+#ifdef UDP_GRO
+	UDP_GRO
+#else
+	-1
+#endif
+	;
+
+constexpr int so_rxq_ovfl =
+#ifdef SO_RXQ_OVFL
+	SO_RXQ_OVFL
+#else
+	-1
+#endif
+	;
+
 enum option_level : int
 {
 	lib = -1,
@@ -7,6 +7,11 @@
 
 #include <pal/buffer.hpp>
 #include <pal/net/basic_socket.hpp>
+#include <pal/net/control_message.hpp>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <span>
 
 namespace pal::net
 {
@@ -25,6 +30,25 @@ public:
 	using typename basic_socket<Protocol>::protocol_type;
 	using typename basic_socket<Protocol>::endpoint_type;
 
+	/// receive_many() slot: \a buffer is filled with one datagram, its
+	/// source address stored in \a sender, its length in \a size and
+	/// its receive flags (e.g. message_truncated) in \a flags.
+	struct receive_slot
+	{
+		std::span<std::byte> buffer{};
+		endpoint_type sender{};
+		size_t size = 0;
+		int flags = 0;
+	};
+
+	/// send_many() slot: \a buffer is sent as one datagram to \a recipient.
+	struct send_slot
+	{
+		endpoint_type recipient{};
+		std::span<const std::byte> buffer{};
+		size_t size = 0;
+	};
+
 	/// Receive into \a bufs, storing the source address in \a sender.
 	template <typename... Buffers>
 		requires (pal::mutable_buffer<std::remove_cvref_t<Buffers>> && ...)
@@ -77,6 +101,229 @@ public:
 		return send_to(recipient, {}, std::forward<Buffers>(bufs)...);
 	}
 
+	/// Receive into \a bufs, storing the source address in \a sender and
+	/// ancillary data in \a control (see control_message_buffer). Not
+	/// supported on Windows.
+	template <control_message... Types, typename... Buffers>
+		requires (pal::mutable_buffer<std::remove_cvref_t<Buffers>> && ...)
+	[[nodiscard]] result<size_t> receive_from (
+		endpoint_type &sender,
+		control_message_buffer<Types...> &control,
+		socket_base::message_flags flags,
+		Buffers&&... bufs) noexcept
+	{
+		__socket::message message{};
+		message.set(std::forward<Buffers>(bufs)...);
+		message.flags(flags);
+		message.name(sender.data(), sender.capacity());
+		message.control(control.data(), control.capacity);
+		return this->socket_.receive(message).and_then([&] (size_t bytes) -> result<size_t>
+		{
+			control.resize(message.msg_controllen);
+			return sender.resize(message.msg_namelen).transform([bytes]
+			{
+				return bytes;
+			});
+		});
+	}
+
+	/// \copydoc receive_from(endpoint_type &, control_message_buffer<Types...> &, socket_base::message_flags, Buffers&&...)
+	template <control_message... Types, typename... Buffers>
+		requires (pal::mutable_buffer<std::remove_cvref_t<Buffers>> && ...)
+	[[nodiscard]] result<size_t> receive_from (
+		endpoint_type &sender,
+		control_message_buffer<Types...> &control,
+		Buffers&&... bufs) noexcept
+	{
+		return receive_from(sender, control, {}, std::forward<Buffers>(bufs)...);
+	}
+
+	/// Send \a bufs to \a recipient with ancillary data \a control (see
+	/// control_message_buffer). Not supported on Windows.
+	template <control_message... Types, typename... Buffers>
+		requires (pal::const_buffer<std::remove_cvref_t<Buffers>> && ...)
+	[[nodiscard]] result<size_t> send_to (
+		const endpoint_type &recipient,
+		const control_message_buffer<Types...> &control,
+		socket_base::message_flags flags,
+		Buffers&&... bufs) noexcept
+	{
+		__socket::message message{};
+		message.set(std::forward<Buffers>(bufs)...);
+		message.flags(flags);
+		message.name(recipient.data(), recipient.size());
+		if (!control.empty())
+		{
+			message.control(const_cast<void *>(control.data()), control.size());
+		}
+		return this->socket_.send(message);
+	}
+
+	/// \copydoc send_to(const endpoint_type &, const control_message_buffer<Types...> &, socket_base::message_flags, Buffers&&...)
+	template <control_message... Types, typename... Buffers>
+		requires (pal::const_buffer<std::remove_cvref_t<Buffers>> && ...)
+	[[nodiscard]] result<size_t> send_to (
+		const endpoint_type &recipient,
+		const control_message_buffer<Types...> &control,
+		Buffers&&... bufs) noexcept
+	{
+		return send_to(recipient, control, {}, std::forward<Buffers>(bufs)...);
+	}
+
+	/// Send \a bufs to \a recipient as consecutive datagrams of
+	/// \a segment_size bytes each (the last possibly shorter) with a single
+	/// syscall, using UDP generic segmentation offload. Returns total bytes
+	/// sent. Linux-only, std::errc::operation_not_supported elsewhere.
+	template <typename... Buffers>
+		requires (pal::const_buffer<std::remove_cvref_t<Buffers>> && ...)
+	[[nodiscard]] result<size_t> send_segments_to (
+		const endpoint_type &recipient,
+		size_t segment_size,
+		Buffers&&... bufs) noexcept
+	{
+		if constexpr (cmsg::udp_segment::type == -1)
+		{
+			return make_unexpected(std::errc::operation_not_supported);
+		}
+		else
+		{
+			if (segment_size == 0 || segment_size > (std::numeric_limits<cmsg::udp_segment::value_type>::max)())
+			{
+				return make_unexpected(std::errc::invalid_argument);
+			}
+			control_message_buffer<cmsg::udp_segment> control;
+			control.template set<cmsg::udp_segment>(static_cast<cmsg::udp_segment::value_type>(segment_size));
+			return send_to(recipient, control, std::forward<Buffers>(bufs)...);
+		}
+	}
+
+	/// Receive into \a bufs, storing the source address in \a sender. With
+	/// ip::udp_gro enabled, the payload may be several coalesced datagrams:
+	/// each (except possibly the last) is \a segment_size bytes. Otherwise
+	/// \a segment_size equals returned size. Linux-only,
+	/// std::errc::operation_not_supported elsewhere.
+	template <typename... Buffers>
+		requires (pal::mutable_buffer<std::remove_cvref_t<Buffers>> && ...)
+	[[nodiscard]] result<size_t> receive_segments_from (
+		endpoint_type &sender,
+		size_t &segment_size,
+		Buffers&&... bufs) noexcept
+	{
+		if constexpr (cmsg::udp_gro::type == -1)
+		{
+			return make_unexpected(std::errc::operation_not_supported);
+		}
+		else
+		{
+			control_message_buffer<cmsg::udp_gro> control;
+			return receive_from(sender, control, std::forward<Buffers>(bufs)...).transform([&] (size_t bytes)
+			{
+				segment_size = control.template get<cmsg::udp_gro>().value_or(bytes);
+				return bytes;
+			});
+		}
+	}
+
+	/// Receive up to \a slots.size() datagrams, one per slot, returning
+	/// number of slots filled. Blocks (per socket mode and receive_timeout)
+	/// for the first datagram only; the rest take what is already queued.
+	/// On Linux, each socket_base::batch_max_size slots cost one
+	/// recvmmsg() call. Error is returned only if no slot was filled. A
+	/// datagram whose source address does not fit endpoint_type (on which
+	/// receive_from() fails) ends the batch at its slot: it, and any taken
+	/// by the same call after it, are dropped.
+	[[nodiscard]] result<size_t> receive_many (
+		std::span<receive_slot> slots,
+		socket_base::message_flags flags = {}) noexcept
+	{
+		std::array<__socket::batch_message, __socket::batch_max_size> batch;
+		size_t filled = 0;
+		while (filled < slots.size())
+		{
+			auto chunk = slots.subspan(filled).first((std::min)(slots.size() - filled, batch.size()));
+			for (size_t i = 0; i != chunk.size(); ++i)
+			{
+				batch[i].header.set(chunk[i].buffer);
+				batch[i].header.name(chunk[i].sender.data(), chunk[i].sender.capacity());
+			}
+
+			auto r = this->socket_.receive_many({batch.data(), chunk.size()}, flags, filled == 0);
+			if (!r)
+			{
+				if (filled > 0)
+				{
+					break;
+				}
+				return unexpected{r.error()};
+			}
+
+			for (size_t i = 0; i != *r; ++i)
+			{
+				if (auto resized = chunk[i].sender.resize(batch[i].header.msg_namelen); !resized)
+				{
+					// keep what was already filled: fail only if this is the first slot
+					if (filled + i == 0)
+					{
+						return unexpected{resized.error()};
+					}
+					return filled + i;
+				}
+				chunk[i].size = batch[i].size;
+				chunk[i].flags = static_cast<int>(batch[i].header.msg_flags);
+			}
+
+			filled += *r;
+			if (*r < chunk.size())
+			{
+				break;
+			}
+		}
+		return filled;
+	}
+
+	/// Send up to \a slots.size() datagrams, one per slot, returning
+	/// number of slots sent (each slot's \a size is set to bytes sent).
+	/// On Linux, each socket_base::batch_max_size slots cost one sendmmsg()
+	/// call. Error is returned only if no slot was sent.
+	[[nodiscard]] result<size_t> send_many (
+		std::span<send_slot> slots,
+		socket_base::message_flags flags = {}) noexcept
+	{
+		std::array<__socket::batch_message, __socket::batch_max_size> batch;
+		size_t sent = 0;
+		while (sent < slots.size())
+		{
+			auto chunk = slots.subspan(sent).first((std::min)(slots.size() - sent, batch.size()));
+			for (size_t i = 0; i != chunk.size(); ++i)
+			{
+				batch[i].header.set(chunk[i].buffer);
+				batch[i].header.name(chunk[i].recipient.data(), chunk[i].recipient.size());
+			}
+
+			auto r = this->socket_.send_many({batch.data(), chunk.size()}, flags);
+			if (!r)
+			{
+				if (sent > 0)
+				{
+					break;
+				}
+				return unexpected{r.error()};
+			}
+
+			for (size_t i = 0; i != *r; ++i)
+			{
+				chunk[i].size = batch[i].size;
+			}
+
+			sent += *r;
+			if (*r < chunk.size())
+			{
+				break;
+			}
+		}
+		return sent;
+	}
+
 	/// Receive into \a bufs without retrieving source address.
 	template <typename... Buffers>
 		requires (pal::mutable_buffer<std::remove_cvref_t<Buffers>> && ...)
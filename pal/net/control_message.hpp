@@ -0,0 +1,227 @@
+#pragma once
+
+/**
+ * \file pal/net/control_message.hpp
+ * Typed ancillary data (control messages) for datagram send/receive
+ */
+
+#include <pal/net/__socket.hpp>
+#include <pal/require.hpp>
+#include <array>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+#if __pal_net_posix
+	#include <netinet/in.h>
+#elif __pal_net_winsock
+	#include <ws2tcpip.h>
+#endif
+
+namespace pal::net
+{
+
+/// Requirements for control message descriptors: \c level and \c type
+/// identify the message (-1 if not supported on this platform),
+/// \c native_type is its OS payload and \c value_type the API
+/// representation. Descriptors usable with send provide
+/// <tt>native_type encode(const value_type &)</tt>, those usable with
+/// receive provide <tt>value_type decode(const native_type &)</tt>.
+template <typename T>
+concept control_message = requires
+{
+	{ T::level } -> std::convertible_to<int>;
+	{ T::type } -> std::convertible_to<int>;
+	typename T::native_type;
+	typename T::value_type;
+	requires std::is_trivially_copyable_v<typename T::native_type>;
+};
+
+/// Fixed-capacity ancillary data buffer with room for one of each control
+/// message \a Types. Allocation-free: storage is inline, so the buffer can
+/// live on the stack or in other scratch memory.
+///
+/// For send, set() each message to attach and pass the buffer to
+/// basic_datagram_socket::send_to(). For receive, enable the relevant
+/// socket options, pass the buffer to basic_datagram_socket::receive_from()
+/// and get() each message of interest. Messages the kernel delivered but
+/// \a Types did not reserve room for may be truncated away.
+template <control_message... Types>
+class control_message_buffer
+{
+public:
+
+	/// Storage size, in bytes
+	static constexpr size_t capacity = (__socket::cmsg_space(sizeof(typename Types::native_type)) + ... + 0);
+
+	/// Set control message \a T to \a value. Each type can be set once
+	/// between clear() calls.
+	template <control_message T>
+		requires ((std::is_same_v<T, Types> || ...) && requires (const T::value_type &v) { T::encode(v); })
+	void set (const typename T::value_type &value) noexcept
+	{
+		using native_type = T::native_type;
+		static constexpr auto space = __socket::cmsg_space(sizeof(native_type));
+		pal_require(size_ + space <= capacity);
+
+		__socket::cmsg_header header{};
+		header.cmsg_len = __socket::cmsg_len(sizeof(native_type));
+		header.cmsg_level = T::level;
+		header.cmsg_type = T::type;
+		std::memcpy(data_.data() + size_, &header, sizeof(header));
+
+		const native_type native = T::encode(value);
+		std::memcpy(data_.data() + size_ + __socket::cmsg_len(0), &native, sizeof(native));
+		size_ += space;
+	}
+
+	/// Return control message \a T value, or std::nullopt if not present
+	template <control_message T>
+		requires requires (const T::native_type &n) { T::decode(n); }
+	[[nodiscard]] std::optional<typename T::value_type> get () const noexcept
+	{
+		using native_type = T::native_type;
+		for (size_t offset = 0; offset + sizeof(__socket::cmsg_header) <= size_; )
+		{
+			__socket::cmsg_header header;
+			std::memcpy(&header, data_.data() + offset, sizeof(header));
+			if (header.cmsg_len < __socket::cmsg_len(0) || offset + header.cmsg_len > size_)
+			{
+				break;
+			}
+
+			if (header.cmsg_level == T::level
+				&& header.cmsg_type == T::type
+				&& header.cmsg_len >= __socket::cmsg_len(sizeof(native_type)))
+			{
+				native_type native;
+				std::memcpy(&native, data_.data() + offset + __socket::cmsg_len(0), sizeof(native));
+				return T::decode(native);
+			}
+
+			offset += __socket::cmsg_space(header.cmsg_len - __socket::cmsg_len(0));
+		}
+		return std::nullopt;
+	}
+
+	/// Remove all control messages
+	void clear () noexcept
+	{
+		size_ = 0;
+	}
+
+	/// Return true if there are no control messages
+	[[nodiscard]] bool empty () const noexcept
+	{
+		return size_ == 0;
+	}
+
+	/// Return pointer to ancillary data
+	[[nodiscard]] void *data () noexcept
+	{
+		return data_.data();
+	}
+
+	/// \copydoc data()
+	[[nodiscard]] const void *data () const noexcept
+	{
+		return data_.data();
+	}
+
+	/// Return used ancillary data size, in bytes
+	[[nodiscard]] size_t size () const noexcept
+	{
+		return size_;
+	}
+
+	/// Set used ancillary data size to \a size (after receive)
+	void resize (size_t size) noexcept
+	{
+		pal_require(size <= capacity);
+		size_ = size;
+	}
+
+private:
+
+	alignas(__socket::cmsg_header) std::array<std::byte, capacity> data_{};
+	size_t size_ = 0;
+};
+
+/// \defgroup control_message Control messages
+/// \{
+
+namespace cmsg
+{
+
+/// Kernel receive timestamp (enable with net::receive_timestamp option)
+struct timestamp
+{
+	static constexpr int level = SOL_SOCKET;
+	static constexpr int type = __socket::so_timestamp;
+	using native_type = __socket::timestamp;
+	using value_type = std::chrono::system_clock::time_point;
+
+	static constexpr value_type decode (const native_type &native) noexcept
+	{
+		return __socket::to_chrono_time(native);
+	}
+};
+
+/// Number of datagrams dropped due to full receive queue since socket
+/// creation (enable with net::receive_queue_overflow option, Linux-only).
+/// Not delivered until the first drop.
+struct receive_queue_overflow
+{
+	static constexpr int level = SOL_SOCKET;
+	static constexpr int type = __socket::so_rxq_ovfl;
+	using native_type = uint32_t;
+	using value_type = uint32_t;
+
+	static constexpr value_type decode (const native_type &native) noexcept
+	{
+		return native;
+	}
+};
+
+/// UDP generic segmentation offload segment size for this send (Linux-only)
+struct udp_segment
+{
+	static constexpr int level = IPPROTO_UDP;
+	static constexpr int type = __socket::udp_segment;
+	using native_type = uint16_t;
+	using value_type = uint16_t;
+
+	static constexpr native_type encode (const value_type &value) noexcept
+	{
+		return value;
+	}
+
+	static constexpr value_type decode (const native_type &native) noexcept
+	{
+		return native;
+	}
+};
+
+/// UDP generic receive offload segment size of coalesced receive (enable
+/// with ip::udp_gro option, Linux-only)
+struct udp_gro
+{
+	static constexpr int level = IPPROTO_UDP;
+	static constexpr int type = __socket::udp_gro;
+	using native_type = int;
+	using value_type = size_t;
+
+	static constexpr value_type decode (const native_type &native) noexcept
+	{
+		return static_cast<value_type>(native);
+	}
+};
+
+} // namespace cmsg
+
+/// \}
+
+} // namespace pal::net
@@ -0,0 +1,86 @@
+#include <pal/net/control_message.hpp>
+#include <pal/net/ip/control_message.hpp>
+#include <pal/net/test.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+
+namespace
+{
+
+using namespace pal::net;
+
+TEST_CASE("net/control_message")
+{
+	using packet_info_v4 = ip::cmsg::packet_info_v4;
+	using packet_info_v6 = ip::cmsg::packet_info_v6;
+	using buffer_type = control_message_buffer<cmsg::udp_segment, packet_info_v4, packet_info_v6>;
+
+	static_assert(
+		buffer_type::capacity ==
+			__socket::cmsg_space(sizeof(uint16_t)) +
+			__socket::cmsg_space(sizeof(packet_info_v4::native_type)) +
+			__socket::cmsg_space(sizeof(packet_info_v6::native_type))
+	);
+
+	buffer_type buffer;
+	CHECK(buffer.empty());
+	CHECK(buffer.size() == 0);
+	CHECK_FALSE(buffer.get<cmsg::udp_segment>());
+
+	SECTION("set / get")
+	{
+		const ip::packet_info<ip::address_v6> v6{.address = ip::address_v6::loopback, .interface_index = 1};
+
+		buffer.set<cmsg::udp_segment>(1200);
+		buffer.set<packet_info_v6>(v6);
+		CHECK_FALSE(buffer.empty());
+		CHECK(buffer.size() == __socket::cmsg_space(sizeof(uint16_t)) + __socket::cmsg_space(sizeof(packet_info_v6::native_type)));
+
+		CHECK(buffer.get<cmsg::udp_segment>() == 1200);
+
+		auto info = buffer.get<packet_info_v6>();
+		REQUIRE(info);
+		CHECK(info->address == v6.address);
+		CHECK(info->interface_index == v6.interface_index);
+
+		// not set
+		CHECK_FALSE(buffer.get<packet_info_v4>());
+		CHECK_FALSE(buffer.get<cmsg::timestamp>());
+	}
+
+	SECTION("clear")
+	{
+		buffer.set<cmsg::udp_segment>(1200);
+		buffer.clear();
+		CHECK(buffer.empty());
+		CHECK_FALSE(buffer.get<cmsg::udp_segment>());
+
+		buffer.set<cmsg::udp_segment>(1400);
+		CHECK(buffer.get<cmsg::udp_segment>() == 1400);
+	}
+
+	SECTION("resize")
+	{
+		buffer.set<cmsg::udp_segment>(1200);
+		buffer.set<packet_info_v4>({.address = ip::address_v4::loopback, .interface_index = 0});
+
+		// truncated: trailing message is dropped, leading one still parsed
+		buffer.resize(__socket::cmsg_space(sizeof(uint16_t)) + 1);
+		CHECK(buffer.get<cmsg::udp_segment>() == 1200);
+		CHECK_FALSE(buffer.get<packet_info_v4>());
+
+		buffer.resize(0);
+		CHECK_FALSE(buffer.get<cmsg::udp_segment>());
+	}
+}
+
+TEST_CASE("net/control_message/timestamp")
+{
+	using namespace std::chrono;
+
+	__socket::timestamp native{};
+	native.tv_sec = 1'700'000'000;
+	CHECK(cmsg::timestamp::decode(native) == system_clock::time_point{seconds{1'700'000'000}});
+}
+
+} // namespace
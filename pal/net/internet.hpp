@@ -10,6 +10,7 @@
 #include <pal/net/ip/address_v6.hpp>
 #include <pal/net/ip/basic_endpoint.hpp>
 #include <pal/net/ip/basic_resolver.hpp>
+#include <pal/net/ip/control_message.hpp>
 #include <pal/net/ip/host_name.hpp>
 #include <pal/net/ip/network.hpp>
 #include <pal/net/ip/network_v4.hpp>
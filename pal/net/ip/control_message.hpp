@@ -0,0 +1,97 @@
+#pragma once
+
+/**
+ * \file pal/net/ip/control_message.hpp
+ * Internet protocol control messages
+ */
+
+#include <pal/net/control_message.hpp>
+#include <pal/net/ip/address_v4.hpp>
+#include <pal/net/ip/address_v6.hpp>
+#include <cstring>
+
+#if __pal_net_posix
+	#include <netinet/in.h>
+#elif __pal_net_winsock
+	#include <ws2tcpip.h>
+#endif
+
+namespace pal::net::ip
+{
+
+/// Datagram local address and interface. On receive, \a address is the
+/// datagram destination address and \a interface_index the interface it
+/// arrived on. On send, \a address selects the source address and
+/// \a interface_index (if non-zero) the outgoing interface.
+template <typename Address>
+struct packet_info
+{
+	/// Local address
+	Address address{};
+
+	/// Interface index
+	unsigned interface_index = 0;
+};
+
+namespace cmsg
+{
+
+/// IPv4 packet info (enable receive with ip::receive_packet_info option)
+struct packet_info_v4
+{
+	static constexpr int level = IPPROTO_IP;
+	static constexpr int type = IP_PKTINFO;
+	using native_type = ::in_pktinfo;
+	using value_type = packet_info<address_v4>;
+
+	static value_type decode (const native_type &native) noexcept
+	{
+		address_v4::bytes_type bytes;
+		std::memcpy(bytes.data(), &native.ipi_addr, bytes.size());
+		return {.address = bytes, .interface_index = static_cast<unsigned>(native.ipi_ifindex)};
+	}
+
+	static native_type encode (const value_type &value) noexcept
+	{
+		native_type native{};
+		native.ipi_ifindex = value.interface_index;
+		if constexpr (requires { native.ipi_spec_dst; })
+		{
+			// source address, ipi_addr is ignored on send
+			std::memcpy(&native.ipi_spec_dst, value.address.to_bytes().data(), value.address.to_bytes().size());
+		}
+		else
+		{
+			std::memcpy(&native.ipi_addr, value.address.to_bytes().data(), value.address.to_bytes().size());
+		}
+		return native;
+	}
+};
+
+/// IPv6 packet info (enable receive with ip::v6_receive_packet_info option)
+struct packet_info_v6
+{
+	static constexpr int level = IPPROTO_IPV6;
+	static constexpr int type = IPV6_PKTINFO;
+	using native_type = ::in6_pktinfo;
+	using value_type = packet_info<address_v6>;
+
+	static value_type decode (const native_type &native) noexcept
+	{
+		address_v6::bytes_type bytes;
+		std::memcpy(bytes.data(), &native.ipi6_addr, bytes.size());
+		return {.address = bytes, .interface_index = static_cast<unsigned>(native.ipi6_ifindex)};
+	}
+
+	static native_type encode (const value_type &value) noexcept
+	{
+		native_type native{};
+		native.ipi6_ifindex = value.interface_index;
+		std::memcpy(&native.ipi6_addr, value.address.to_bytes().data(), value.address.to_bytes().size());
+		return native;
+	}
+};
+
+} // namespace cmsg
+
+} // namespace pal::net::ip
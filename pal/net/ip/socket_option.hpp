@@ -25,6 +25,42 @@ using v6_only = socket_option<bool,
 	socket_option_name{IPV6_V6ONLY}
 >;
 
+/// Deliver IPv4 datagram destination address and arrival interface with
+/// each datagram (ip::cmsg::packet_info_v4)
+using receive_packet_info = socket_option<bool,
+	socket_option_level{IPPROTO_IP},
+	socket_option_name{IP_PKTINFO}
+>;
+
+/// Deliver IPv6 datagram destination address and arrival interface with
+/// each datagram (ip::cmsg::packet_info_v6)
+using v6_receive_packet_info = socket_option<bool,
+	socket_option_level{IPPROTO_IPV6},
+#ifdef IPV6_RECVPKTINFO
+	socket_option_name{IPV6_RECVPKTINFO}
+#else
+	socket_option_name{IPV6_PKTINFO}
+#endif
+>;
+
+/// UDP generic segmentation offload: every send is split by the kernel (or
+/// NIC) into datagrams of this many bytes, the last possibly shorter. Zero
+/// disables. Linux-only; see also basic_datagram_socket::send_segments_to()
+/// for per-send segment size.
+using udp_segment = socket_option<int,
+	socket_option_level{IPPROTO_UDP},
+	socket_option_name{__socket::udp_segment}
+>;
+
+/// UDP generic receive offload: allow the kernel to deliver consecutive
+/// equal-size datagrams from the same flow as one coalesced receive. Linux-
+/// only; use basic_datagram_socket::receive_segments_from() to learn the
+/// segment size.
+using udp_gro = socket_option<bool,
+	socket_option_level{IPPROTO_UDP},
+	socket_option_name{__socket::udp_gro}
+>;
+
 // clang-format on
 
 } // namespace pal::net::ip
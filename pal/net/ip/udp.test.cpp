@@ -1,7 +1,12 @@
+#include <pal/net/ip/control_message.hpp>
+#include <pal/net/ip/socket_option.hpp>
 #include <pal/net/ip/udp.hpp>
 #include <pal/net/test.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_template_test_macros.hpp>
+#include <algorithm>
+#include <array>
+#include <span>
 #include <string_view>
 
 namespace
@@ -183,6 +188,254 @@ TEMPLATE_TEST_CASE("net/ip/udp", "", udp_v4, udp_v6)
 		}
 	}
 
+	SECTION("control messages")
+	{
+		constexpr bool is_v4 = TestType::protocol_v == pal::net::ip::udp::v4;
+		using packet_info = std::conditional_t<is_v4,
+			pal::net::ip::cmsg::packet_info_v4,
+			pal::net::ip::cmsg::packet_info_v6
+		>;
+		using packet_info_option = std::conditional_t<is_v4,
+			pal::net::ip::receive_packet_info,
+			pal::net::ip::v6_receive_packet_info
+		>;
+		using address_type = decltype(packet_info::value_type::address);
+
+		pal::net::control_message_buffer<
+			packet_info,
+			pal::net::cmsg::timestamp,
+			pal::net::cmsg::receive_queue_overflow
+		> control;
+
+		SECTION("not enabled")
+		{
+			REQUIRE_NOTHROW(sender.send_to(endpoint, "hello"sv).value());
+			auto recv = receiver.receive_from(endpoint, control, recv_buf).value();
+			CHECK(recv_view(recv) == "hello");
+			CHECK_FALSE(control.template get<packet_info>());
+			CHECK_FALSE(control.template get<pal::net::cmsg::timestamp>());
+		}
+
+		if constexpr (pal::os == pal::os_type::windows)
+		{
+			REQUIRE_NOTHROW(sender.send_to(endpoint, "hello"sv).value());
+			auto recv = receiver.receive_from(endpoint, control, recv_buf);
+			REQUIRE_FALSE(recv);
+			CHECK(recv.error() == std::errc::operation_not_supported);
+			return;
+		}
+
+		SECTION("packet info")
+		{
+			REQUIRE_NOTHROW(receiver.set_option(packet_info_option{true}).value());
+			REQUIRE_NOTHROW(sender.send_to(endpoint, "hello"sv).value());
+
+			auto recv = receiver.receive_from(endpoint, control, recv_buf).value();
+			CHECK(recv_view(recv) == "hello");
+
+			auto info = control.template get<packet_info>();
+			REQUIRE(info);
+			CHECK(info->address == address_type::loopback);
+			CHECK(info->interface_index > 0);
+		}
+
+		SECTION("timestamp")
+		{
+			REQUIRE_NOTHROW(receiver.set_option(pal::net::receive_timestamp{true}).value());
+			const auto sent = std::chrono::system_clock::now();
+			REQUIRE_NOTHROW(sender.send_to(endpoint, "hello"sv).value());
+
+			REQUIRE_NOTHROW(receiver.receive_from(endpoint, control, recv_buf).value());
+			auto timestamp = control.template get<pal::net::cmsg::timestamp>();
+			REQUIRE(timestamp);
+			CHECK(*timestamp >= sent - 1s);
+			CHECK(*timestamp <= std::chrono::system_clock::now() + 1s);
+		}
+
+		SECTION("receive queue overflow")
+		{
+			if constexpr (pal::os == pal::os_type::linux)
+			{
+				REQUIRE_NOTHROW(receiver.set_option(pal::net::receive_queue_overflow{true}).value());
+				REQUIRE_NOTHROW(sender.send_to(endpoint, "hello"sv).value());
+
+				REQUIRE_NOTHROW(receiver.receive_from(endpoint, control, recv_buf).value());
+				// delivered only once drops have occurred
+				CHECK(control.template get<pal::net::cmsg::receive_queue_overflow>().value_or(0) == 0u);
+			}
+		}
+
+		SECTION("send with packet info")
+		{
+			REQUIRE_NOTHROW(receiver.set_option(packet_info_option{true}).value());
+
+			pal::net::control_message_buffer<packet_info> source;
+			source.template set<packet_info>({.address = address_type::loopback, .interface_index = 0});
+			REQUIRE_NOTHROW(sender.send_to(endpoint, source, "hello"sv).value());
+
+			auto recv = receiver.receive_from(endpoint, control, recv_buf).value();
+			CHECK(recv_view(recv) == "hello");
+			CHECK(endpoint.address() == pal::net::ip::address{address_type::loopback});
+		}
+	}
+
+	SECTION("segmentation offload")
+	{
+		std::array<char, 16> segment{};
+		size_t segment_size = 0;
+
+		if constexpr (pal::os != pal::os_type::linux)
+		{
+			auto send = sender.send_segments_to(endpoint, 4, "helloworld"sv);
+			REQUIRE_FALSE(send);
+			CHECK(send.error() == std::errc::operation_not_supported);
+			return;
+		}
+
+		SECTION("segmented send")
+		{
+			REQUIRE(sender.send_segments_to(endpoint, 4, "hello"sv, "world"sv).value() == 10);
+			for (auto expected: {"hell"sv, "owor"sv, "ld"sv})
+			{
+				auto recv = receiver.receive_from(endpoint, segment).value();
+				CHECK(std::string_view{segment.data(), recv} == expected);
+			}
+		}
+
+		SECTION("coalesced receive")
+		{
+			REQUIRE_NOTHROW(receiver.set_option(pal::net::ip::udp_gro{true}).value());
+			REQUIRE(sender.send_segments_to(endpoint, 4, "helloworld"sv).value() == 10);
+
+			auto recv = receiver.receive_segments_from(endpoint, segment_size, recv_buf).value();
+			CHECK(recv_view(recv) == "helloworld");
+			CHECK(segment_size == 4);
+			CHECK(endpoint.port() == sender.local_endpoint().value().port());
+		}
+
+		SECTION("not coalesced")
+		{
+			REQUIRE(sender.send_to(endpoint, "hello"sv).value() == 5);
+			auto recv = receiver.receive_segments_from(endpoint, segment_size, recv_buf).value();
+			CHECK(recv_view(recv) == "hello");
+			CHECK(segment_size == recv);
+		}
+
+		SECTION("udp_segment option")
+		{
+			REQUIRE_NOTHROW(sender.set_option(pal::net::ip::udp_segment{4}).value());
+			REQUIRE(sender.send_to(endpoint, "helloworld"sv).value() == 10);
+			auto recv = receiver.receive_from(endpoint, segment).value();
+			CHECK(std::string_view{segment.data(), recv} == "hell");
+		}
+
+		SECTION("invalid segment size")
+		{
+			auto send = sender.send_segments_to(endpoint, 0, "hello"sv);
+			REQUIRE_FALSE(send);
+			CHECK(send.error() == std::errc::invalid_argument);
+		}
+	}
+
+	SECTION("send_many / receive_many")
+	{
+		using send_slot = typename decltype(sender)::send_slot;
+		using receive_slot = typename decltype(receiver)::receive_slot;
+
+		// more than one batch syscall worth
+		constexpr size_t count = pal::net::socket_base::batch_max_size + 3;
+		std::array<std::array<std::byte, 8>, count> payloads{};
+		std::array<send_slot, count> send_slots{};
+		for (size_t i = 0; i != count; ++i)
+		{
+			payloads[i].fill(std::byte(i));
+			send_slots[i].recipient = endpoint;
+			send_slots[i].buffer = std::span{payloads[i]}.first(i % payloads[i].size() + 1);
+		}
+
+		std::array<std::array<std::byte, 16>, count + 1> buffers{};
+		std::array<receive_slot, count + 1> receive_slots{};
+		for (size_t i = 0; i != receive_slots.size(); ++i)
+		{
+			receive_slots[i].buffer = buffers[i];
+		}
+
+		SECTION("round trip")
+		{
+			REQUIRE(sender.send_many(send_slots).value() == count);
+			for (auto &slot: send_slots)
+			{
+				CHECK(slot.size == slot.buffer.size());
+			}
+
+			// slots beyond queued datagrams are left unfilled rather than waited for
+			size_t received = 0;
+			while (received < count)
+			{
+				auto n = receiver.receive_many(std::span{receive_slots}.subspan(received)).value();
+				REQUIRE(n > 0);
+				received += n;
+			}
+			CHECK(received == count);
+
+			const auto port = sender.local_endpoint().value().port();
+			for (size_t i = 0; i != count; ++i)
+			{
+				auto &slot = receive_slots[i];
+				CHECK(slot.sender.port() == port);
+				REQUIRE(slot.size == send_slots[i].buffer.size());
+				CHECK(std::ranges::equal(std::span{slot.buffer}.first(slot.size), send_slots[i].buffer));
+				CHECK((slot.flags & receiver.message_truncated) == 0);
+			}
+		}
+
+		SECTION("partial")
+		{
+			REQUIRE(sender.send_many(std::span{send_slots}.first(2)).value() == 2);
+
+			// first datagram is waited for, the rest taken only if already queued
+			size_t received = 0;
+			while (received < 2)
+			{
+				received += receiver.receive_many(std::span{receive_slots}.subspan(received)).value();
+			}
+			CHECK(received == 2);
+			CHECK(receive_slots[1].size == 2);
+		}
+
+		SECTION("truncated")
+		{
+			const std::array<std::byte, 64> large{};
+			send_slots[0].buffer = large;
+			REQUIRE(sender.send_many(std::span{send_slots}.first(1)).value() == 1);
+
+			REQUIRE(receiver.receive_many(std::span{receive_slots}.first(1)).value() == 1);
+			CHECK(receive_slots[0].size == buffers[0].size());
+			CHECK((receive_slots[0].flags & receiver.message_truncated) != 0);
+		}
+
+		SECTION("receive timeout")
+		{
+			REQUIRE_NOTHROW(receiver.set_option(pal::net::receive_timeout{10ms}).value());
+			auto recv = receiver.receive_many(receive_slots);
+			REQUIRE_FALSE(recv);
+			CHECK(recv.error() == std::errc::timed_out);
+		}
+
+		SECTION("bad file descriptor")
+		{
+			close_native_handle(sender);
+			auto send = sender.send_many(send_slots);
+			REQUIRE_FALSE(send);
+			CHECK(send.error() == std::errc::bad_file_descriptor);
+
+			close_native_handle(receiver);
+			auto recv = receiver.receive_many(receive_slots);
+			REQUIRE_FALSE(recv);
+			CHECK(recv.error() == std::errc::bad_file_descriptor);
+		}
+	}
+
 	SECTION("make_datagram_socket with endpoint")
 	{
 		SECTION("success")
@@ -7,6 +7,7 @@ list(APPEND pal_sources
 	pal/net/basic_socket_acceptor.hpp
 	pal/net/basic_stream_socket.hpp
 	pal/net/concepts.hpp
+	pal/net/control_message.hpp
 	pal/net/internet.hpp
 	pal/net/socket.hpp
 	pal/net/socket_base.hpp
@@ -24,6 +25,7 @@ list(APPEND pal_sources
 	pal/net/ip/basic_endpoint.cpp
 	pal/net/ip/basic_resolver.hpp
 	pal/net/ip/basic_resolver.cpp
+	pal/net/ip/control_message.hpp
 	pal/net/ip/host_name.hpp
 	pal/net/ip/host_name.cpp
 	pal/net/ip/network.hpp
@@ -44,6 +46,7 @@ list(APPEND pal_test_sources
 	pal/net/basic_secure_socket.test.cpp
 	pal/net/basic_socket.test.cpp
 	pal/net/basic_socket_acceptor.test.cpp
+	pal/net/control_message.test.cpp
 	pal/net/socket_base.test.cpp
 	pal/net/socket_option.test.cpp
 
@@ -8,4 +8,5 @@
 #include <pal/net/basic_datagram_socket.hpp>
 #include <pal/net/basic_socket_acceptor.hpp>
 #include <pal/net/basic_stream_socket.hpp>
+#include <pal/net/control_message.hpp>
 #include <pal/net/socket_option.hpp>
@@ -6,6 +6,7 @@
  */
 
 #include <pal/net/__socket.hpp>
+#include <span>
 #include <utility>
 
 namespace pal::net
@@ -90,6 +91,11 @@ public:
 	[[nodiscard]] result<size_t> send (const __socket::message &message) const noexcept;
 	[[nodiscard]] result<size_t> receive (__socket::message &message) const noexcept;
 
+	// Batched: at most __socket::batch_max_size entries, returns count of entries moved. Receive blocks
+	// (per socket mode) for the first datagram only if \a wait, otherwise returns 0 if none is queued.
+	[[nodiscard]] result<size_t> send_many (std::span<__socket::batch_message> batch, int flags) const noexcept;
+	[[nodiscard]] result<size_t> receive_many (std::span<__socket::batch_message> batch, int flags, bool wait) const noexcept;
+
 	[[nodiscard]] result<size_t> available () const noexcept;
 	[[nodiscard]] result<void> local_endpoint (void *endpoint, size_t *endpoint_size) const noexcept;
 	[[nodiscard]] result<void> remote_endpoint (void *endpoint, size_t *endpoint_size) const noexcept;
@@ -177,6 +183,9 @@ public:
 	/// Maximum number of spans for vectored I/O
 	static constexpr size_t io_vector_max_size = __socket::io_vector_max_size;
 
+	/// Maximum number of datagrams per batched send/receive syscall
+	static constexpr size_t batch_max_size = __socket::batch_max_size;
+
 protected:
 
 	~socket_base () = default;
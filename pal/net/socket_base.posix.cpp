@@ -3,6 +3,7 @@
 #if __pal_net_posix
 
 #include <pal/net/socket_base.hpp>
+#include <algorithm>
 #include <fcntl.h>
 #include <sys/ioctl.h>
 
@@ -178,6 +179,107 @@ result<size_t> native_socket::receive (__socket::message &message) const noexcep
 	return __socket::sys_error();
 }
 
+result<size_t> native_socket::send_many (std::span<__socket::batch_message> batch, int flags) const noexcept
+{
+	batch = batch.first(std::min(batch.size(), __socket::batch_max_size));
+
+#if __pal_os_linux
+	std::array<::mmsghdr, __socket::batch_max_size> headers;
+	for (size_t i = 0; i != batch.size(); ++i)
+	{
+		headers[i] = {.msg_hdr = batch[i].header, .msg_len = 0};
+	}
+	if (auto r = ::sendmmsg(to_sys(handle_), headers.data(), batch.size(), flags | MSG_NOSIGNAL); r > -1)
+	{
+		for (auto i = 0; i != r; ++i)
+		{
+			batch[i].size = headers[i].msg_len;
+		}
+		return static_cast<size_t>(r);
+	}
+	if (is_blocking_error(errno))
+	{
+		return __socket::sys_error(ETIMEDOUT);
+	}
+	if (is_connection_error(errno))
+	{
+		return __socket::sys_error(ENOTCONN);
+	}
+	return __socket::sys_error();
+#else
+	size_t count = 0;
+	for (auto &entry: batch)
+	{
+		entry.header.msg_flags = flags;
+		auto r = send(entry.header);
+		if (!r)
+		{
+			if (count > 0)
+			{
+				break;
+			}
+			return unexpected{r.error()};
+		}
+		entry.size = *r;
+		++count;
+	}
+	return count;
+#endif
+}
+
+result<size_t> native_socket::receive_many (std::span<__socket::batch_message> batch, int flags, bool wait) const noexcept
+{
+	batch = batch.first(std::min(batch.size(), __socket::batch_max_size));
+
+#if __pal_os_linux
+	std::array<::mmsghdr, __socket::batch_max_size> headers;
+	for (size_t i = 0; i != batch.size(); ++i)
+	{
+		headers[i] = {.msg_hdr = batch[i].header, .msg_len = 0};
+	}
+	flags |= wait ? MSG_WAITFORONE : MSG_DONTWAIT;
+	if (auto r = ::recvmmsg(to_sys(handle_), headers.data(), batch.size(), flags, nullptr); r > -1)
+	{
+		for (auto i = 0; i != r; ++i)
+		{
+			batch[i].header.msg_namelen = headers[i].msg_hdr.msg_namelen;
+			batch[i].header.msg_controllen = headers[i].msg_hdr.msg_controllen;
+			batch[i].header.msg_flags = headers[i].msg_hdr.msg_flags;
+			batch[i].size = headers[i].msg_len;
+		}
+		return static_cast<size_t>(r);
+	}
+	if (is_blocking_error(errno))
+	{
+		if (!wait)
+		{
+			return 0;
+		}
+		return __socket::sys_error(ETIMEDOUT);
+	}
+	return __socket::sys_error();
+#else
+	// no recvmmsg: one recvmsg per datagram, never blocking past the first
+	size_t count = 0;
+	for (auto &entry: batch)
+	{
+		entry.header.msg_flags = flags | ((count > 0 || !wait) ? MSG_DONTWAIT : 0);
+		auto r = receive(entry.header);
+		if (!r)
+		{
+			if (count > 0 || (!wait && r.error() == std::errc::timed_out))
+			{
+				break;
+			}
+			return unexpected{r.error()};
+		}
+		entry.size = *r;
+		++count;
+	}
+	return count;
+#endif
+}
+
 result<size_t> native_socket::available () const noexcept
 {
 	int value{};
@@ -3,6 +3,7 @@
 #if __pal_net_winsock
 
 #include <pal/net/socket_base.hpp>
+#include <algorithm>
 #include <ws2tcpip.h>
 
 namespace pal::net
@@ -263,11 +264,17 @@ result<size_t> native_socket::send (const __socket::message &message) const noex
 	int result;
 	DWORD sent = 0;
 
+	if (message.msg_control)
+	{
+		// ancillary data requires WSASendMsg/WSARecvMsg, not supported
+		return __socket::sys_error(WSAEOPNOTSUPP);
+	}
+
 	if (message.msg_name)
 	{
 		result = ::WSASendTo(
 			to_sys(handle_),
-			const_cast<WSABUF *>(message.msg_iov.data()),
+			message.msg_iov,
 			message.msg_iovlen,
 			&sent,
 			message.msg_flags,
@@ -281,7 +288,7 @@ result<size_t> native_socket::send (const __socket::message &message) const noex
 	{
 		result = ::WSASend(
 			to_sys(handle_),
-			const_cast<WSABUF *>(message.msg_iov.data()),
+			message.msg_iov,
 			message.msg_iovlen,
 			&sent,
 			message.msg_flags,
@@ -309,11 +316,17 @@ result<size_t> native_socket::receive (__socket::message &message) const noexcep
 	int result;
 	DWORD received = 0;
 
+	if (message.msg_control)
+	{
+		// ancillary data requires WSASendMsg/WSARecvMsg, not supported
+		return __socket::sys_error(WSAEOPNOTSUPP);
+	}
+
 	if (message.msg_name)
 	{
 		result = ::WSARecvFrom(
 			to_sys(handle_),
-			message.msg_iov.data(),
+			message.msg_iov,
 			message.msg_iovlen,
 			&received,
 			&message.msg_flags,
@@ -327,7 +340,7 @@ result<size_t> native_socket::receive (__socket::message &message) const noexcep
 	{
 		result = ::WSARecv(
 			to_sys(handle_),
-			message.msg_iov.data(),
+			message.msg_iov,
 			message.msg_iovlen,
 			&received,
 			&message.msg_flags,
@@ -350,6 +363,59 @@ result<size_t> native_socket::receive (__socket::message &message) const noexcep
 	return __socket::sys_error(e);
 }
 
+result<size_t> native_socket::send_many (std::span<__socket::batch_message> batch, int flags) const noexcept
+{
+	// no sendmmsg: one WSASendTo per datagram
+	batch = batch.first((std::min)(batch.size(), __socket::batch_max_size));
+	size_t count = 0;
+	for (auto &entry: batch)
+	{
+		entry.header.msg_flags = flags;
+		auto r = send(entry.header);
+		if (!r)
+		{
+			if (count > 0)
+			{
+				break;
+			}
+			return unexpected{r.error()};
+		}
+		entry.size = *r;
+		++count;
+	}
+	return count;
+}
+
+result<size_t> native_socket::receive_many (std::span<__socket::batch_message> batch, int flags, bool wait) const noexcept
+{
+	// no recvmmsg: one WSARecvFrom per datagram, never blocking past the first
+	batch = batch.first((std::min)(batch.size(), __socket::batch_max_size));
+	size_t count = 0;
+	for (auto &entry: batch)
+	{
+		if (count > 0 || !wait)
+		{
+			if (auto queued = available(); !queued || *queued == 0)
+			{
+				break;
+			}
+		}
+		entry.header.msg_flags = flags;
+		auto r = receive(entry.header);
+		if (!r)
+		{
+			if (count > 0)
+			{
+				break;
+			}
+			return unexpected{r.error()};
+		}
+		entry.size = *r;
+		++count;
+	}
+	return count;
+}
+
 result<size_t> native_socket::available () const noexcept
 {
 	unsigned long value{};
@@ -203,6 +203,19 @@ using send_low_watermark = socket_option<int,
 	socket_option_name{SO_SNDLOWAT}
 >;
 
+/// Deliver kernel receive timestamp with each datagram (cmsg::timestamp)
+using receive_timestamp = socket_option<bool,
+	socket_option_level{SOL_SOCKET},
+	socket_option_name{__socket::so_timestamp}
+>;
+
+/// Deliver count of datagrams dropped due to full receive queue with each
+/// datagram (cmsg::receive_queue_overflow, Linux-only)
+using receive_queue_overflow = socket_option<bool,
+	socket_option_level{SOL_SOCKET},
+	socket_option_name{__socket::so_rxq_ovfl}
+>;
+
 /// Controls behaviour when a socket is closed and unsent data is present
 struct linger: socket_option<::linger, socket_option_level{SOL_SOCKET}, socket_option_name{SO_LINGER}>
 {
@@ -4,6 +4,8 @@
 #include <pal/version.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/interfaces/catch_interfaces_capture.hpp>
+#include <filesystem>
+#include <random>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -43,6 +45,24 @@ struct bad_alloc_once
 	}
 };
 
+/// Unique path in the system temporary directory; the file it names (if any) is removed on destruction
+struct temp_file
+{
+	const std::filesystem::path path =
+		std::filesystem::temp_directory_path() / ("pal_test_" + std::to_string(std::random_device{}()));
+
+	~temp_file () noexcept
+	{
+		std::error_code ec;
+		std::filesystem::remove(path, ec);
+	}
+
+	[[nodiscard]] std::string string () const
+	{
+		return path.string();
+	}
+};
+
 /// Generic helper for two-sided tests
 template <typename Server, typename Client = Server>
 struct connected_pair